@@ -0,0 +1,60 @@
+#include "benchmark.h"
+
+#include "audio_codec/adpcm.h"
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+BENCHMARK_SUITE("ADPCM")
+
+static constexpr uint32_t SampleRateHz = 22050;
+
+/// @brief Generate reproducible synthetic audio: A sine sweep with some noise. Stereo data is planar
+static auto syntheticAudio(uint32_t nrOfChannels, uint32_t nrOfSamplesPerChannel) -> std::vector<int16_t>
+{
+    std::vector<int16_t> samples(nrOfChannels * nrOfSamplesPerChannel);
+    const auto noise = Benchmark::randomData(samples.size());
+    for (uint32_t ch = 0; ch < nrOfChannels; ++ch)
+    {
+        double phase = 0.0;
+        for (uint32_t i = 0; i < nrOfSamplesPerChannel; ++i)
+        {
+            const double frequencyHz = 200.0 + (2000.0 * i) / nrOfSamplesPerChannel + 100.0 * ch;
+            phase += 2.0 * std::numbers::pi * frequencyHz / SampleRateHz;
+            const auto index = ch * nrOfSamplesPerChannel + i;
+            samples[index] = static_cast<int16_t>(12000.0 * std::sin(phase) + (static_cast<int32_t>(noise[index]) - 128) * 8);
+        }
+    }
+    return samples;
+}
+
+BENCHMARK_CASE("encode")
+{
+    for (auto channelFormat : {Audio::ChannelFormat::Mono, Audio::ChannelFormat::Stereo})
+    {
+        const auto nrOfChannels = channelFormat == Audio::ChannelFormat::Mono ? 1U : 2U;
+        // one second of audio. PCM data must be < 64kB per frame
+        const Audio::SampleData samples = syntheticAudio(nrOfChannels, SampleRateHz / nrOfChannels);
+        const auto bytes = std::get<std::vector<int16_t>>(samples).size() * sizeof(int16_t);
+        Audio::Adpcm adpcm(channelFormat, SampleRateHz);
+        context.measure(nrOfChannels == 1 ? "synthetic_22050hz_mono" : "synthetic_22050hz_stereo", bytes, [&adpcm, &samples]()
+                        { return adpcm.encode(samples).size(); });
+    }
+}
+
+BENCHMARK_CASE("decode")
+{
+    for (auto channelFormat : {Audio::ChannelFormat::Mono, Audio::ChannelFormat::Stereo})
+    {
+        const auto nrOfChannels = channelFormat == Audio::ChannelFormat::Mono ? 1U : 2U;
+        const Audio::SampleData samples = syntheticAudio(nrOfChannels, SampleRateHz / nrOfChannels);
+        const auto bytes = std::get<std::vector<int16_t>>(samples).size() * sizeof(int16_t);
+        Audio::Adpcm adpcm(channelFormat, SampleRateHz);
+        const auto compressed = adpcm.encode(samples);
+        context.measure(nrOfChannels == 1 ? "synthetic_22050hz_mono" : "synthetic_22050hz_stereo", bytes, [&compressed]()
+                        {
+            const auto decoded = Audio::Adpcm::decode(compressed);
+            return std::visit([](const auto &d) { return d.size() * sizeof(d.front()); }, decoded); });
+    }
+}
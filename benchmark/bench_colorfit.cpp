@@ -0,0 +1,189 @@
+#include "benchmark.h"
+
+#include "color/cielabf.h"
+#include "color/colorhelpers.h"
+#include "color/conversions.h"
+#include "color/gamma.h"
+#include "image/quantization.h"
+#include "math/colorfit.h"
+#include "math/histogram.h"
+#include "math/kdtree.h"
+#include "math/kmeans.h"
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+BENCHMARK_SUITE("ColorFit")
+
+static const std::vector<std::string> CorpusFiles = {
+    "images/240x160/BigBuckBunny_282_240x160.png",
+    "images/240x160/flower_foveon_240x160.png"};
+
+/// @brief Get synthetic image and corpus images that could be read. Built on first use, so the data path has been set
+static auto images() -> const std::vector<Benchmark::BenchmarkImage> &
+{
+    static const std::vector<Benchmark::BenchmarkImage> result = []()
+    {
+        std::vector<Benchmark::BenchmarkImage> images = {Benchmark::syntheticImage(240, 160), Benchmark::syntheticImage(1920, 1080)};
+        for (const auto &fileName : CorpusFiles)
+        {
+            auto image = Benchmark::readCorpusImage(fileName);
+            if (!image.pixels.empty())
+            {
+                images.push_back(std::move(image));
+            }
+        }
+        return images;
+    }();
+    return result;
+}
+
+BENCHMARK_CASE("histogram")
+{
+    for (const auto &image : images())
+    {
+        const auto bytes = image.pixels.size() * sizeof(Color::XRGB8888);
+        context.measure(image.name + " std::map", bytes, [&image]()
+                        {
+                            std::map<Color::XRGB8888, uint64_t> histogram;
+                            for (const auto &pixel : image.pixels)
+                            {
+                                histogram[pixel]++;
+                            }
+                            return histogram.size(); });
+        context.measure(image.name + " flat", bytes, [&image]()
+                        { return Histogram::buildFlatHistogram(image.pixels).size(); });
+    }
+}
+
+BENCHMARK_CASE("init maximin")
+{
+    struct Cluster
+    {
+        Color::CIELabf center;
+    };
+    for (const auto &image : images())
+    {
+        // cluster the unique colors of the image like ColorFit does
+        std::vector<Color::XRGB8888> colors;
+        for (const auto &entry : Histogram::buildFlatHistogram(image.pixels))
+        {
+            colors.push_back(entry.first);
+        }
+        const auto positions = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(colors));
+        context.measure(image.name + " 256 clusters", positions.size() * sizeof(Color::CIELabf), [&positions]()
+                        { return Kmeans::initMaximin<Cluster>(positions, 256).size(); });
+    }
+}
+
+BENCHMARK_CASE("online k-means")
+{
+    struct Cluster
+    {
+        Color::CIELabf center;
+        uint32_t weight = 0;
+    };
+    for (const auto &image : images())
+    {
+        std::vector<Color::XRGB8888> colors;
+        for (const auto &entry : Histogram::buildFlatHistogram(image.pixels))
+        {
+            colors.push_back(entry.first);
+        }
+        const auto positions = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(image.pixels));
+        for (std::size_t nrOfClusters : {16, 64, 256})
+        {
+            const auto clusters = Kmeans::initMaximin<Cluster>(Color::convertTo<Color::CIELabf>(Color::srgbToLinear(colors)), nrOfClusters);
+            context.measure(image.name + " " + std::to_string(nrOfClusters) + " clusters", image.pixels.size() * sizeof(Color::XRGB8888), [&clusters, &positions]()
+                            {
+                                std::srand(0);
+                                auto result = clusters;
+                                Kmeans::onlineKmeans(result, positions, 0.5F);
+                                return result.size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("reduce colors RGB555")
+{
+    const ColorFit<Color::XRGB8888> colorFit(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555));
+    for (const auto &image : images())
+    {
+        for (std::size_t nrOfColors : {16, 64, 256})
+        {
+            context.measure(image.name + " " + std::to_string(nrOfColors) + " colors", image.pixels.size() * sizeof(Color::XRGB8888), [&colorFit, &image, nrOfColors]()
+                            { return colorFit.reduceColors(image.pixels, nrOfColors).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("closest color RGB555")
+{
+    const auto colorSpace = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555)));
+    const KdTree<Color::CIELabf> tree(colorSpace);
+    // the linear search is slow, so only query the first lines of the image
+    const auto image = Benchmark::syntheticImage(1920, 1080);
+    const std::vector<Color::XRGB8888> queryPixels(image.pixels.cbegin(), std::next(image.pixels.cbegin(), 4 * image.width));
+    const auto queries = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(queryPixels));
+    const auto bytes = queries.size() * sizeof(Color::XRGB8888);
+    context.measure(image.name + " linear search", bytes, [&colorSpace, &queries]()
+                    {
+                        std::size_t indexSum = 0;
+                        for (const auto &query : queries)
+                        {
+                            indexSum += ColorHelpers::getClosestColorIndex(query, colorSpace);
+                        }
+                        return indexSum; });
+    context.measure(image.name + " kd-tree", bytes, [&tree, &queries]()
+                    {
+                        std::size_t indexSum = 0;
+                        for (const auto &query : queries)
+                        {
+                            indexSum += tree.closestIndex(query);
+                        }
+                        return indexSum; });
+}
+
+BENCHMARK_CASE("quantize closest")
+{
+    const ColorFit<Color::XRGB8888> colorFit(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555));
+    for (const auto &image : images())
+    {
+        const auto colorMapping = colorFit.reduceColors(image.pixels, 256);
+        const Image::ImageData imageData(image.pixels);
+        context.measure(image.name, image.pixels.size() * sizeof(Color::XRGB8888), 1, [&imageData, &colorMapping]()
+                        { return Image::Quantization::quantizeClosest(imageData, colorMapping).pixels().size(); });
+    }
+}
+
+BENCHMARK_CASE("atkinson dither")
+{
+    const ColorFit<Color::XRGB8888> colorFit(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555));
+    for (const auto &image : images())
+    {
+        for (std::size_t nrOfColors : {16, 256})
+        {
+            const auto colorMapping = colorFit.reduceColors(image.pixels, nrOfColors);
+            const Image::ImageData imageData(image.pixels);
+            context.measure(image.name + " " + std::to_string(nrOfColors) + " colors", image.pixels.size() * sizeof(Color::XRGB8888), 1, [&imageData, &image, &colorMapping]()
+                            { return Image::Quantization::atkinsonDither(imageData, image.width, image.height, colorMapping).pixels().size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("ordered dither")
+{
+    const ColorFit<Color::XRGB8888> colorFit(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555));
+    for (const auto &image : images())
+    {
+        for (std::size_t nrOfColors : {16, 256})
+        {
+            const auto colorMapping = colorFit.reduceColors(image.pixels, nrOfColors);
+            const Image::ImageData imageData(image.pixels);
+            context.measure(image.name + " " + std::to_string(nrOfColors) + " colors", image.pixels.size() * sizeof(Color::XRGB8888), 1, [&imageData, &image, &colorMapping]()
+                            { return Image::Quantization::orderedDither(imageData, image.width, image.height, colorMapping).pixels().size(); });
+        }
+    }
+}
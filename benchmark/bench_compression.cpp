@@ -0,0 +1,271 @@
+#include "benchmark.h"
+#include "lz4_multimap.h"
+
+#include "color/conversions.h"
+#include "color/xrgb1555.h"
+#include "compression/autocompress.h"
+#include "compression/chunked.h"
+#include "compression/huffman.h"
+#include "compression/lz4.h"
+#include "compression/lzss.h"
+#include "compression/rans.h"
+#include "processing/datahelpers.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Compression;
+
+BENCHMARK_SUITE("Compression")
+
+static const std::vector<std::string> CorpusFiles = {
+    "data/lorem_ipsum_2k.txt",
+    "data/artificial_240x160.raw",
+    "data/BigBuckBunny_40_240x160.raw",
+    "data/squish_240x160.raw",
+    "data/bbb_adpcm_22050.wav"};
+
+static const char LoremIpsum[] = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt ut labore et dolore magna aliquyam erat, sed diam voluptua. At vero eos et accusam et justo duo dolores et ea rebum. Stet clita kasd gubergren, no sea takimata sanctus est Lorem ipsum dolor sit amet. ";
+
+using DataSet = std::pair<std::string, std::vector<uint8_t>>;
+
+/// @brief Build synthetic data sets and add corpus files that could be read
+static auto buildDataSets() -> std::vector<DataSet>
+{
+    std::vector<DataSet> result;
+    // text with some variation, so it is not trivially compressible
+    std::vector<uint8_t> text;
+    const auto noise = Benchmark::randomData(256);
+    for (std::size_t i = 0; text.size() < 65536; ++i)
+    {
+        text.insert(text.end(), LoremIpsum, LoremIpsum + sizeof(LoremIpsum) - 1);
+        text[text.size() - 1 - (noise[i % noise.size()] % 64)] = 'a' + (i % 26);
+    }
+    text.resize(65536);
+    result.push_back({"synthetic_text_64k", text});
+    result.push_back({"synthetic_random_64k", Benchmark::randomData(65536)});
+    // RGB555 image data like it is passed to the compressors by img2h / vid2h
+    const auto image = Benchmark::syntheticImage(240, 160);
+    result.push_back({image.name + "_rgb555", DataHelpers::convertTo<uint8_t>(Color::convertTo<Color::XRGB1555>(image.pixels))});
+    for (const auto &fileName : CorpusFiles)
+    {
+        auto data = Benchmark::readCorpusFile(fileName);
+        if (!data.empty())
+        {
+            result.push_back({fileName, std::move(data)});
+        }
+    }
+    return result;
+}
+
+/// @brief Get data sets. Built on first use, so the data path has been set
+static auto dataSets() -> const std::vector<DataSet> &
+{
+    static const std::vector<DataSet> result = buildDataSets();
+    return result;
+}
+
+BENCHMARK_CASE("LZ4 encode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return encodeLZ4_40(data).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZ4 encode multimap")
+{
+    // previous multimap-based encoder on the same data sets as "LZ4 encode" to compare against the hash-chain encoder
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return Benchmark::encodeLZ4_40Multimap(data).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZ4 encode optimal")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return encodeLZ4_40(data, false, true).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZ4 decode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        const auto compressed = encodeLZ4_40(data);
+        context.measure(name, data.size(), [&compressed]()
+                        { return decodeLZ4_40(compressed).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZ4 decode buffer")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        const auto compressed = encodeLZ4_40(data);
+        std::vector<uint8_t> decoded(data.size() + LZ4_WILDCOPY_PADDING);
+        context.measure(name, data.size(), [&compressed, &decoded]()
+                        { return decodeLZ4_40(compressed.data(), compressed.size(), decoded.data(), decoded.size()); });
+    }
+}
+
+BENCHMARK_CASE("LZ4 dictionary encode")
+{
+    // use the previous frame of a synthetic sequence as dictionary
+    const auto previous = DataHelpers::convertTo<uint8_t>(Color::convertTo<Color::XRGB1555>(Benchmark::syntheticImage(240, 160, 0).pixels));
+    const auto current = DataHelpers::convertTo<uint8_t>(Color::convertTo<Color::XRGB1555>(Benchmark::syntheticImage(240, 160, 1).pixels));
+    context.measure("synthetic_240x160-1_rgb555", current.size(), [&current, &previous]()
+                    { return encodeLZ4_40(current, previous).size(); });
+}
+
+BENCHMARK_CASE("LZ4 dictionary decode")
+{
+    const auto previous = DataHelpers::convertTo<uint8_t>(Color::convertTo<Color::XRGB1555>(Benchmark::syntheticImage(240, 160, 0).pixels));
+    const auto current = DataHelpers::convertTo<uint8_t>(Color::convertTo<Color::XRGB1555>(Benchmark::syntheticImage(240, 160, 1).pixels));
+    const auto compressed = encodeLZ4_40(current, previous);
+    context.measure("synthetic_240x160-1_rgb555", current.size(), [&compressed, &previous]()
+                    { return decodeLZ4_40(compressed, previous).size(); });
+}
+
+BENCHMARK_CASE("LZSS encode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return encodeLZSS_10(data).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZSS encode optimal")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return encodeLZSS_10(data, false, true).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZSS decode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        const auto compressed = encodeLZSS_10(data);
+        context.measure(name, data.size(), [&compressed]()
+                        { return decodeLZSS_10(compressed).size(); });
+    }
+}
+
+BENCHMARK_CASE("LZSS decode buffer")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        const auto compressed = encodeLZSS_10(data);
+        std::vector<uint8_t> decoded(data.size());
+        context.measure(name, data.size(), [&compressed, &decoded]()
+                        { return decodeLZSS_10(compressed.data(), compressed.size(), decoded.data(), decoded.size()); });
+    }
+}
+
+BENCHMARK_CASE("Huffman encode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        for (uint32_t bitsPerSymbol : {4U, 8U})
+        {
+            context.measure(name + " " + std::to_string(bitsPerSymbol) + "bit", data.size(), [&data, bitsPerSymbol]()
+                            { return encodeHuffman_20(data, bitsPerSymbol).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("Huffman decode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        for (uint32_t bitsPerSymbol : {4U, 8U})
+        {
+            const auto compressed = encodeHuffman_20(data, bitsPerSymbol);
+            context.measure(name + " " + std::to_string(bitsPerSymbol) + "bit", data.size(), [&compressed]()
+                            { return decodeHuffman_20(compressed).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("rANS encode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        for (bool interleaved : {false, true})
+        {
+            context.measure(name + (interleaved ? " interleaved" : ""), data.size(), [&data, interleaved]()
+                            { return encodeRANS_50(data, interleaved).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("rANS decode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        for (bool interleaved : {false, true})
+        {
+            const auto compressed = encodeRANS_50(data, interleaved);
+            context.measure(name + (interleaved ? " interleaved" : ""), data.size(), [&compressed]()
+                            { return decodeRANS_50(compressed).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("Auto encode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        context.measure(name, data.size(), [&data]()
+                        { return encodeAuto(data, true, true).size(); });
+    }
+}
+
+BENCHMARK_CASE("Auto decode")
+{
+    for (const auto &[name, data] : dataSets())
+    {
+        const auto compressed = encodeAuto(data, true, true);
+        context.measure(name, data.size(), [&compressed]()
+                        { return decodeAuto(compressed).size(); });
+    }
+}
+
+static auto encodeLZ4Chunk(const std::vector<uint8_t> &chunk) -> std::vector<uint8_t>
+{
+    return encodeAuto(chunk, true, false);
+}
+
+BENCHMARK_CASE("Chunked encode")
+{
+    // concatenate all data sets to get a big buffer
+    std::vector<uint8_t> data;
+    for (const auto &dataSet : dataSets())
+    {
+        data.insert(data.end(), dataSet.second.cbegin(), dataSet.second.cend());
+    }
+    context.measure("all_data_sets 16k chunks", data.size(), [&data]()
+                    { return encodeChunked(data, 16384, encodeLZ4Chunk).size(); });
+}
+
+BENCHMARK_CASE("Chunked decode")
+{
+    std::vector<uint8_t> data;
+    for (const auto &dataSet : dataSets())
+    {
+        data.insert(data.end(), dataSet.second.cbegin(), dataSet.second.cend());
+    }
+    const auto compressed = encodeChunked(data, 16384, encodeLZ4Chunk);
+    context.measure("all_data_sets 16k chunks", data.size(), [&compressed]()
+                    { return decodeChunked(compressed).size(); });
+}
@@ -0,0 +1,56 @@
+#include "benchmark.h"
+
+#include "color/cielabf.h"
+#include "color/conversions.h"
+#include "color/gamma.h"
+#include "color/rgb565.h"
+#include "color/rgbf.h"
+#include "color/xrgb1555.h"
+#include "color/ycgcorf.h"
+
+#include <vector>
+
+BENCHMARK_SUITE("Color conversion")
+
+static const auto Image = Benchmark::syntheticImage(240, 160);
+
+/// @brief Measure conversion of synthetic image from XRGB8888 to T_OUT
+template <typename T_OUT>
+static auto measureFromXRGB8888(Benchmark::Context &context, const std::string &name) -> void
+{
+    context.measure(Image.name + " -> " + name, Image.pixels.size() * sizeof(Color::XRGB8888), []()
+                    { return Color::convertTo<T_OUT>(Image.pixels).size() * sizeof(T_OUT); });
+}
+
+/// @brief Measure conversion of synthetic image from T_IN to XRGB8888
+template <typename T_IN>
+static auto measureToXRGB8888(Benchmark::Context &context, const std::string &name) -> void
+{
+    const auto colors = Color::convertTo<T_IN>(Image.pixels);
+    context.measure(Image.name + " " + name + " -> xrgb8888", colors.size() * sizeof(T_IN), [&colors]()
+                    { return Color::convertTo<Color::XRGB8888>(colors).size() * sizeof(Color::XRGB8888); });
+}
+
+BENCHMARK_CASE("from XRGB8888")
+{
+    measureFromXRGB8888<Color::XRGB1555>(context, "xrgb1555");
+    measureFromXRGB8888<Color::RGB565>(context, "rgb565");
+    measureFromXRGB8888<Color::RGBf>(context, "rgbf");
+    measureFromXRGB8888<Color::CIELabf>(context, "cielabf");
+    measureFromXRGB8888<Color::YCgCoRf>(context, "ycgcorf");
+}
+
+BENCHMARK_CASE("to XRGB8888")
+{
+    measureToXRGB8888<Color::XRGB1555>(context, "xrgb1555");
+    measureToXRGB8888<Color::RGB565>(context, "rgb565");
+    measureToXRGB8888<Color::RGBf>(context, "rgbf");
+    measureToXRGB8888<Color::CIELabf>(context, "cielabf");
+    measureToXRGB8888<Color::YCgCoRf>(context, "ycgcorf");
+}
+
+BENCHMARK_CASE("sRGB to linear")
+{
+    context.measure(Image.name, Image.pixels.size() * sizeof(Color::XRGB8888), []()
+                    { return Color::srgbToLinear(Image.pixels).size() * sizeof(Color::RGBf); });
+}
@@ -0,0 +1,58 @@
+#include "benchmark.h"
+
+#include "image_codec/dxt.h"
+
+#include <string>
+#include <vector>
+
+BENCHMARK_SUITE("DXT")
+
+static const std::vector<std::string> CorpusFiles = {
+    "images/240x160/artificial_240x160.png",
+    "images/240x160/BigBuckBunny_282_240x160.png",
+    "images/240x160/gradient_240x160.png",
+    "images/240x160/squish_240x160.png"};
+
+/// @brief Get synthetic image and corpus images that could be read. Built on first use, so the data path has been set
+static auto images() -> const std::vector<Benchmark::BenchmarkImage> &
+{
+    static const std::vector<Benchmark::BenchmarkImage> result = []()
+    {
+        std::vector<Benchmark::BenchmarkImage> images = {Benchmark::syntheticImage(240, 160)};
+        for (const auto &fileName : CorpusFiles)
+        {
+            auto image = Benchmark::readCorpusImage(fileName);
+            if (!image.pixels.empty())
+            {
+                images.push_back(std::move(image));
+            }
+        }
+        return images;
+    }();
+    return result;
+}
+
+BENCHMARK_CASE("encode")
+{
+    for (const auto &image : images())
+    {
+        for (bool asRGB565 : {false, true})
+        {
+            context.measure(image.name + (asRGB565 ? " rgb565" : " rgb555"), image.pixels.size() * sizeof(Color::XRGB8888), [&image, asRGB565]()
+                            { return DXT::encode(image.pixels, image.width, image.height, asRGB565).size(); });
+        }
+    }
+}
+
+BENCHMARK_CASE("decode")
+{
+    for (const auto &image : images())
+    {
+        for (bool asRGB565 : {false, true})
+        {
+            const auto compressed = DXT::encode(image.pixels, image.width, image.height, asRGB565);
+            context.measure(image.name + (asRGB565 ? " rgb565" : " rgb555"), image.pixels.size() * sizeof(Color::XRGB8888), [&compressed, &image, asRGB565]()
+                            { return DXT::decode(compressed, image.width, image.height, asRGB565).size() * sizeof(Color::XRGB8888); });
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#include "benchmark.h"
+
+#include "compression/lz4.h"
+#include "video_codec/dxtv.h"
+#include "video_codec/framedecoder.h"
+
+#include <string>
+#include <vector>
+
+BENCHMARK_SUITE("DXTV")
+
+static const std::vector<std::string> CorpusFiles = {
+    "videos/240x160/BigBuckBunny_240x160_15fps-178.png",
+    "videos/240x160/BigBuckBunny_240x160_15fps-179.png",
+    "videos/240x160/BigBuckBunny_240x160_15fps-180.png",
+    "videos/240x160/BigBuckBunny_240x160_15fps-181.png"};
+
+static constexpr float Quality = 90.0F;
+
+using Sequence = std::pair<std::string, std::vector<Benchmark::BenchmarkImage>>;
+
+/// @brief Get synthetic sequence and corpus sequence if it could be read. Built on first use, so the data path has been set
+static auto sequences() -> const std::vector<Sequence> &
+{
+    static const std::vector<Sequence> result = []()
+    {
+        std::vector<Sequence> sequences(1);
+        sequences[0].first = "synthetic_240x160 4 frames";
+        for (uint32_t frame = 0; frame < 4; ++frame)
+        {
+            sequences[0].second.push_back(Benchmark::syntheticImage(240, 160, frame));
+        }
+        Sequence corpus = {"BigBuckBunny_240x160_15fps-178-181", {}};
+        for (const auto &fileName : CorpusFiles)
+        {
+            auto image = Benchmark::readCorpusImage(fileName);
+            if (image.pixels.empty())
+            {
+                break;
+            }
+            corpus.second.push_back(std::move(image));
+        }
+        if (corpus.second.size() == CorpusFiles.size())
+        {
+            sequences.push_back(std::move(corpus));
+        }
+        return sequences;
+    }();
+    return result;
+}
+
+/// @brief Get raw size of all frames of a sequence
+static auto sequenceSize(const Sequence &sequence) -> std::size_t
+{
+    std::size_t size = 0;
+    for (const auto &frame : sequence.second)
+    {
+        size += frame.pixels.size() * sizeof(Color::XRGB8888);
+    }
+    return size;
+}
+
+/// @brief Encode all frames of a sequence and return the compressed frames
+static auto encodeSequence(const Sequence &sequence, Video::Dxtv::MotionSearch motionSearch) -> std::vector<std::vector<uint8_t>>
+{
+    std::vector<std::vector<uint8_t>> result;
+    std::vector<Color::XRGB8888> previousImage;
+    for (const auto &frame : sequence.second)
+    {
+        auto [data, decoded] = Video::Dxtv::encode(frame.pixels, previousImage, frame.width, frame.height, Quality, false, motionSearch);
+        result.push_back(std::move(data));
+        previousImage = std::move(decoded);
+    }
+    return result;
+}
+
+BENCHMARK_CASE("encode")
+{
+    for (const auto &sequence : sequences())
+    {
+        context.measure(sequence.first, sequenceSize(sequence), [&sequence]()
+                        {
+            std::size_t size = 0;
+            for (const auto &data : encodeSequence(sequence, Video::Dxtv::MotionSearch::Exhaustive))
+            {
+                size += data.size();
+            }
+            return size; });
+    }
+}
+
+BENCHMARK_CASE("encode fast")
+{
+    for (const auto &sequence : sequences())
+    {
+        context.measure(sequence.first, sequenceSize(sequence), [&sequence]()
+                        {
+            std::size_t size = 0;
+            for (const auto &data : encodeSequence(sequence, Video::Dxtv::MotionSearch::Fast))
+            {
+                size += data.size();
+            }
+            return size; });
+    }
+}
+
+BENCHMARK_CASE("decode")
+{
+    for (const auto &sequence : sequences())
+    {
+        const auto compressed = encodeSequence(sequence, Video::Dxtv::MotionSearch::Exhaustive);
+        const auto width = sequence.second.front().width;
+        const auto height = sequence.second.front().height;
+        context.measure(sequence.first, sequenceSize(sequence), static_cast<uint32_t>(compressed.size()), [&compressed, width, height]()
+                        {
+            std::size_t size = 0;
+            std::vector<Color::XRGB8888> previousImage;
+            for (const auto &data : compressed)
+            {
+                previousImage = Video::Dxtv::decode(data, previousImage, width, height);
+                size += previousImage.size() * sizeof(Color::XRGB8888);
+            }
+            return size; });
+    }
+}
+
+BENCHMARK_CASE("decode buffer")
+{
+    for (const auto &sequence : sequences())
+    {
+        const auto compressed = encodeSequence(sequence, Video::Dxtv::MotionSearch::Exhaustive);
+        const auto width = sequence.second.front().width;
+        const auto height = sequence.second.front().height;
+        std::vector<Color::XRGB8888> currentImage(width * height);
+        std::vector<Color::XRGB8888> previousImage(width * height);
+        context.measure(sequence.first, sequenceSize(sequence), static_cast<uint32_t>(compressed.size()), [&]()
+                        {
+            std::size_t size = 0;
+            for (std::size_t i = 0; i < compressed.size(); ++i)
+            {
+                Video::Dxtv::decode(compressed[i].data(), compressed[i].size(), currentImage.data(), i > 0 ? previousImage.data() : nullptr, width, height);
+                std::swap(currentImage, previousImage);
+                size += previousImage.size() * sizeof(Color::XRGB8888);
+            }
+            return size; });
+    }
+}
+
+/// @brief Encode all frames of a sequence using DXTV, then LZ4, like "vid2h --dxtv --lz4" does
+static auto encodeSequenceLZ4(const Sequence &sequence) -> std::vector<std::vector<uint8_t>>
+{
+    auto result = encodeSequence(sequence, Video::Dxtv::MotionSearch::Exhaustive);
+    for (auto &data : result)
+    {
+        data = Compression::encodeLZ4_40(data);
+    }
+    return result;
+}
+
+BENCHMARK_CASE("decode LZ4 chain")
+{
+    for (const auto &sequence : sequences())
+    {
+        const auto compressed = encodeSequenceLZ4(sequence);
+        const auto width = sequence.second.front().width;
+        const auto height = sequence.second.front().height;
+        context.measure(sequence.first, sequenceSize(sequence), static_cast<uint32_t>(compressed.size()), [&compressed, width, height]()
+                        {
+            std::size_t size = 0;
+            std::vector<Color::XRGB8888> previousImage;
+            for (const auto &data : compressed)
+            {
+                previousImage = Video::Dxtv::decode(Compression::decodeLZ4_40(data), previousImage, width, height);
+                size += previousImage.size() * sizeof(Color::XRGB8888);
+            }
+            return size; });
+    }
+}
+
+BENCHMARK_CASE("decode LZ4 chain frame decoder")
+{
+    for (const auto &sequence : sequences())
+    {
+        const auto compressed = encodeSequenceLZ4(sequence);
+        const auto width = sequence.second.front().width;
+        const auto height = sequence.second.front().height;
+        Video::FrameDecoder decoder({Image::ProcessingType::CompressLZ4_40, Image::ProcessingType::CompressDXTV}, width, height, Color::Format::XRGB8888, false);
+        context.measure(sequence.first, sequenceSize(sequence), static_cast<uint32_t>(compressed.size()), [&compressed, &decoder]()
+                        {
+            std::size_t size = 0;
+            for (const auto &data : compressed)
+            {
+                size += decoder.decode(data.data(), data.size()).size() * sizeof(Color::XRGB8888);
+            }
+            return size; });
+    }
+}
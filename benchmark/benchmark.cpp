@@ -0,0 +1,265 @@
+#include "benchmark.h"
+
+#include "exception.h"
+#include "image/imageio.h"
+#include "statistics/csvio.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <omp.h>
+
+namespace Benchmark
+{
+
+    /// @brief Registered benchmark function
+    struct Entry
+    {
+        std::string suite;
+        std::string name;
+        Function func;
+    };
+
+    /// @brief Get list of registered benchmarks. Function-local, so registration during static initialization is safe
+    static auto entries() -> std::vector<Entry> &
+    {
+        static std::vector<Entry> registeredEntries;
+        return registeredEntries;
+    }
+
+    static std::string CorpusDataPath;
+
+    auto Result::megaBytesPerSecond() const -> double
+    {
+        return medianNs > 0 ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (medianNs / 1e9) : 0.0;
+    }
+
+    auto Result::framesPerSecond() const -> double
+    {
+        return medianNs > 0 ? static_cast<double>(frames) / (medianNs / 1e9) : 0.0;
+    }
+
+    Context::Context(const Options &options, const std::string &suite, const std::string &name, std::vector<Result> &results)
+        : m_options(options), m_suite(suite), m_name(name), m_results(results)
+    {
+    }
+
+    auto Context::measure(const std::string &dataSet, std::size_t bytes, const std::function<std::size_t()> &func) -> void
+    {
+        measure(dataSet, bytes, 0, func);
+    }
+
+    auto Context::measure(const std::string &dataSet, std::size_t bytes, uint32_t frames, const std::function<std::size_t()> &func) -> void
+    {
+        std::vector<double> durationsNs;
+        std::size_t resultBytes = 0;
+        double totalMs = 0;
+        while (durationsNs.size() < m_options.maxIterations && (durationsNs.size() < m_options.minIterations || totalMs < m_options.minTimeMs))
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            resultBytes = func();
+            const auto durationNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+            durationsNs.push_back(durationNs);
+            totalMs += durationNs / 1e6;
+        }
+        Result result;
+        result.suite = m_suite;
+        result.name = m_name;
+        result.dataSet = dataSet;
+        result.bytes = bytes;
+        result.resultBytes = resultBytes;
+        result.frames = frames;
+        result.iterations = static_cast<uint32_t>(durationsNs.size());
+        result.meanNs = std::accumulate(durationsNs.cbegin(), durationsNs.cend(), 0.0) / durationsNs.size();
+        std::sort(durationsNs.begin(), durationsNs.end());
+        result.minNs = durationsNs.front();
+        result.medianNs = durationsNs.size() % 2 == 0 ? (durationsNs[durationsNs.size() / 2 - 1] + durationsNs[durationsNs.size() / 2]) / 2 : durationsNs[durationsNs.size() / 2];
+        std::cout << std::left << std::setw(40) << (m_suite + "::" + m_name) << " " << std::setw(44) << dataSet << std::right << std::fixed << std::setprecision(3) << std::setw(12) << result.medianNs / 1e6 << " ms " << std::setprecision(1) << std::setw(9) << result.megaBytesPerSecond() << " MB/s " << std::setw(9) << resultBytes << " bytes";
+        if (frames > 0)
+        {
+            std::cout << " " << std::setw(9) << result.framesPerSecond() << " fps";
+        }
+        std::cout << std::endl;
+        m_results.push_back(result);
+    }
+
+    auto add(const std::string &suite, const std::string &name, const Function &func) -> bool
+    {
+        entries().push_back({suite, name, func});
+        return true;
+    }
+
+    auto run(const Options &options) -> std::vector<Result>
+    {
+        CorpusDataPath = options.dataPath;
+        std::vector<Result> results;
+        for (const auto &entry : entries())
+        {
+            if (options.filter.empty() || (entry.suite + "::" + entry.name).find(options.filter) != std::string::npos)
+            {
+                Context context(options, entry.suite, entry.name, results);
+                entry.func(context);
+            }
+        }
+        return results;
+    }
+
+    auto list() -> std::vector<std::string>
+    {
+        std::vector<std::string> names;
+        std::transform(entries().cbegin(), entries().cend(), std::back_inserter(names), [](const auto &entry)
+                       { return entry.suite + "::" + entry.name; });
+        return names;
+    }
+
+    /// @brief Escape string for JSON output
+    static auto escapeJSON(const std::string &s) -> std::string
+    {
+        std::string result;
+        for (auto c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result.push_back('\\');
+            }
+            result.push_back(c);
+        }
+        return result;
+    }
+
+    auto writeJSON(const std::string &fileName, const std::vector<Result> &results) -> void
+    {
+        std::ofstream jsonFile(fileName, std::ios::out);
+        REQUIRE(jsonFile.is_open(), std::runtime_error, "Failed to open " << fileName << " for writing");
+        const auto now = std::time(nullptr);
+        char timeString[32] = {};
+        std::strftime(timeString, sizeof(timeString), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        jsonFile << "{" << std::endl;
+        jsonFile << "  \"context\": {" << std::endl;
+        jsonFile << "    \"date\": \"" << timeString << "\"," << std::endl;
+        jsonFile << "    \"compiler\": \"" << escapeJSON(__VERSION__) << "\"," << std::endl;
+        jsonFile << "    \"threads\": " << omp_get_max_threads() << std::endl;
+        jsonFile << "  }," << std::endl;
+        jsonFile << "  \"benchmarks\": [" << std::endl;
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto &r = results[i];
+            jsonFile << "    {\"suite\": \"" << escapeJSON(r.suite) << "\", \"name\": \"" << escapeJSON(r.name) << "\", \"dataset\": \"" << escapeJSON(r.dataSet) << "\", ";
+            jsonFile << "\"bytes\": " << r.bytes << ", \"result_bytes\": " << r.resultBytes << ", \"frames\": " << r.frames << ", \"iterations\": " << r.iterations << ", ";
+            jsonFile << std::fixed << std::setprecision(1) << "\"min_ns\": " << r.minNs << ", \"median_ns\": " << r.medianNs << ", \"mean_ns\": " << r.meanNs << ", ";
+            jsonFile << std::setprecision(3) << "\"mb_per_s\": " << r.megaBytesPerSecond() << ", \"fps\": " << r.framesPerSecond() << "}" << (i < results.size() - 1 ? "," : "") << std::endl;
+        }
+        jsonFile << "  ]" << std::endl;
+        jsonFile << "}" << std::endl;
+    }
+
+    auto writeCSV(const std::string &fileName, const std::vector<Result> &results) -> void
+    {
+        std::ofstream csvFile(fileName, std::ios::out);
+        REQUIRE(csvFile.is_open(), std::runtime_error, "Failed to open " << fileName << " for writing");
+        IO::CSV::writeCSV(csvFile, {"suite", "name", "dataset", "bytes", "result_bytes", "frames", "iterations", "min_ns", "median_ns", "mean_ns", "mb_per_s", "fps"}, results, [](const Result &r, std::size_t index) -> std::string
+                          {
+            switch (index)
+            {
+            case 0: return r.suite;
+            case 1: return r.name;
+            case 2: return r.dataSet;
+            case 3: return std::to_string(r.bytes);
+            case 4: return std::to_string(r.resultBytes);
+            case 5: return std::to_string(r.frames);
+            case 6: return std::to_string(r.iterations);
+            case 7: return std::to_string(r.minNs);
+            case 8: return std::to_string(r.medianNs);
+            case 9: return std::to_string(r.meanNs);
+            case 10: return std::to_string(r.megaBytesPerSecond());
+            default: return std::to_string(r.framesPerSecond());
+            } });
+    }
+
+    auto readCorpusFile(const std::string &fileName) -> std::vector<uint8_t>
+    {
+        std::ifstream fs(CorpusDataPath + fileName, std::ios::binary | std::ios::in);
+        if (!fs.is_open())
+        {
+            return {};
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
+        // files that have not been checked out by Git LFS are only pointers
+        static const std::string LfsPointer = "version https://git-lfs";
+        if (data.size() >= LfsPointer.size() && std::equal(LfsPointer.cbegin(), LfsPointer.cend(), data.cbegin()))
+        {
+            return {};
+        }
+        return data;
+    }
+
+    auto readCorpusImage(const std::string &fileName) -> BenchmarkImage
+    {
+        BenchmarkImage result;
+        result.name = fileName;
+        try
+        {
+            const auto image = IO::File::readImage(CorpusDataPath + fileName);
+            result.pixels = image.data.pixels().convertData<Color::XRGB8888>();
+            result.width = image.info.size.width();
+            result.height = image.info.size.height();
+        }
+        catch (const std::runtime_error &)
+        {
+            result.pixels.clear();
+        }
+        return result;
+    }
+
+    auto randomData(std::size_t size, uint32_t seed) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> data(size);
+        uint32_t random = seed;
+        for (auto &d : data)
+        {
+            random = random * 1664525 + 1013904223;
+            d = static_cast<uint8_t>(random >> 24);
+        }
+        return data;
+    }
+
+    auto syntheticImage(uint32_t width, uint32_t height, uint32_t frame) -> BenchmarkImage
+    {
+        BenchmarkImage result;
+        result.name = "synthetic_" + std::to_string(width) + "x" + std::to_string(height) + "-" + std::to_string(frame);
+        result.width = width;
+        result.height = height;
+        result.pixels.resize(width * height);
+        const auto noise = randomData(width * height, 12345 + frame);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // diagonal gradient in the background moving with the frame number
+                const uint32_t xm = x + 2 * frame;
+                const uint8_t n = noise[y * width + x] & 0x07;
+                uint8_t r = static_cast<uint8_t>((((xm % width) * 255) / width) ^ (n << 1));
+                uint8_t g = static_cast<uint8_t>((y * 255) / height + n);
+                uint8_t b = static_cast<uint8_t>(((xm + y) * 127) / (width + height));
+                // flat rectangle and a checkerboard with hard edges
+                if (xm % width > width / 4 && xm % width < width / 2 && y > height / 4 && y < height / 2)
+                {
+                    r = 200;
+                    g = 40;
+                    b = 40;
+                }
+                else if (y > (2 * height) / 3 && ((x / 8 + y / 8) & 1) == 0)
+                {
+                    r = 250;
+                    g = 250;
+                    b = 250;
+                }
+                result.pixels[y * width + x] = Color::XRGB8888(r, g, b);
+            }
+        }
+        return result;
+    }
+}
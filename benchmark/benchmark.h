@@ -0,0 +1,122 @@
+#pragma once
+
+#include "color/xrgb8888.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+    /// @brief Result of a single benchmark measurement
+    struct Result
+    {
+        std::string suite;           // Benchmark suite name, e.g. "LZ4"
+        std::string name;            // Benchmark name, e.g. "encode optimal"
+        std::string dataSet;         // Name of synthetic data set or corpus file used
+        std::size_t bytes = 0;       // Uncompressed / raw size of the data processed in bytes. Used to calculate throughput
+        std::size_t resultBytes = 0; // Size of result in bytes, e.g. compressed size for encoders
+        uint32_t frames = 0;         // Number of video frames processed per run. 0 if not a video benchmark
+        uint32_t iterations = 0;     // Number of times the function was run
+        double minNs = 0;            // Minimum run time in ns
+        double medianNs = 0;         // Median run time in ns
+        double meanNs = 0;           // Mean run time in ns
+
+        /// @brief Throughput in MB/s calculated from bytes and median run time
+        auto megaBytesPerSecond() const -> double;
+
+        /// @brief Frame rate in frames/s calculated from frames and median run time. 0 if not a video benchmark
+        auto framesPerSecond() const -> double;
+    };
+
+    /// @brief Options for running benchmarks
+    struct Options
+    {
+        std::string filter;            // Only run benchmarks with "suite::name" containing this string. Empty runs all
+        std::string dataPath;          // Path to the data directory of the repository, e.g. "../../data/"
+        double minTimeMs = 200.0;      // Minimum time to run every measurement for
+        uint32_t minIterations = 3;    // Minimum number of runs for every measurement
+        uint32_t maxIterations = 1000; // Maximum number of runs for every measurement
+    };
+
+    /// @brief Passed to benchmark functions to run measurements and collect results
+    class Context
+    {
+    public:
+        Context(const Options &options, const std::string &suite, const std::string &name, std::vector<Result> &results);
+
+        /// @brief Run func repeatedly and record its run time.
+        /// Runs at least Options::minIterations times and until Options::minTimeMs have passed
+        /// @param dataSet Name of data set used
+        /// @param bytes Uncompressed / raw size of the data processed in bytes. Used to calculate throughput
+        /// @param func Function to measure. Must return the size of its result in bytes, so the work can not be optimized away
+        auto measure(const std::string &dataSet, std::size_t bytes, const std::function<std::size_t()> &func) -> void;
+
+        /// @brief Run func repeatedly and record its run time and frame rate
+        /// @param frames Number of video frames func processes per run
+        auto measure(const std::string &dataSet, std::size_t bytes, uint32_t frames, const std::function<std::size_t()> &func) -> void;
+
+    private:
+        const Options &m_options;
+        const std::string m_suite;
+        const std::string m_name;
+        std::vector<Result> &m_results;
+    };
+
+    /// @brief Image to run benchmarks on
+    struct BenchmarkImage
+    {
+        std::string name;                    // Data set name
+        std::vector<Color::XRGB8888> pixels; // sRGB pixels. Empty if the image could not be read
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    using Function = std::function<void(Context &)>;
+
+    /// @brief Register benchmark function. Call through BENCHMARK_CASE
+    auto add(const std::string &suite, const std::string &name, const Function &func) -> bool;
+
+    /// @brief Run all registered benchmarks matching the filter in options
+    auto run(const Options &options) -> std::vector<Result>;
+
+    /// @brief Get "suite::name" of all registered benchmarks
+    auto list() -> std::vector<std::string>;
+
+    /// @brief Write results to JSON file
+    auto writeJSON(const std::string &fileName, const std::vector<Result> &results) -> void;
+
+    /// @brief Write results to CSV file
+    auto writeCSV(const std::string &fileName, const std::vector<Result> &results) -> void;
+
+    /// @brief Read a corpus file from the data directory
+    /// @return File data or an empty vector if the file could not be read, e.g. because it has not been checked out
+    auto readCorpusFile(const std::string &fileName) -> std::vector<uint8_t>;
+
+    /// @brief Read a corpus image from the data directory
+    /// @return Image or an image with empty pixels if the file could not be read
+    auto readCorpusImage(const std::string &fileName) -> BenchmarkImage;
+
+    /// @brief Generate reproducible pseudo-random data
+    auto randomData(std::size_t size, uint32_t seed = 12345) -> std::vector<uint8_t>;
+
+    /// @brief Generate reproducible synthetic image with gradients, flat areas, edges and some noise
+    /// @param frame Frame number. The content moves a bit with every frame, so images can be used as a video sequence
+    auto syntheticImage(uint32_t width, uint32_t height, uint32_t frame = 0) -> BenchmarkImage;
+}
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+
+// Define the benchmark suite name. Call before your first benchmark
+#define BENCHMARK_SUITE(a) static const std::string BENCHMARK_SUITE_NAME = a;
+
+// Define a benchmark function. The function receives a Benchmark::Context &context to run measurements with, e.g.
+// BENCHMARK_SUITE("Foo"); BENCHMARK_CASE("bar") { context.measure("data", data.size(), [&]() { return foo(data).size(); }); }
+#define BENCHMARK_CASE_IMPL(name, func)                                                                      \
+    static void func(Benchmark::Context &context);                                                           \
+    static const bool BENCHMARK_CONCAT(func, Registered) = Benchmark::add(BENCHMARK_SUITE_NAME, name, func); \
+    static void func(Benchmark::Context &context)
+#define BENCHMARK_CASE(name) BENCHMARK_CASE_IMPL(name, BENCHMARK_CONCAT(benchmarkFunction, __LINE__))
@@ -0,0 +1,260 @@
+#include "lz4_multimap.h"
+
+#include "exception.h"
+#include "if/lz4_constants.h"
+
+#include <map>
+
+namespace Benchmark
+{
+    using namespace Compression;
+
+    struct MatchInfo
+    {
+        int32_t distance = 0;
+        int32_t length = 0;
+    };
+
+    static auto findBestMatch(const std::vector<uint8_t> &src, const std::multimap<uint32_t, int32_t> &hashPositions, const int32_t srcPosition) -> MatchInfo
+    {
+        MatchInfo bestMatch = {0, 0};
+        // get hash from srcPosition + MinLength
+        const uint32_t srcPositionHash = *reinterpret_cast<const uint32_t *>(src.data() + srcPosition);
+        // find all possible matches from hash table and exit if we have none
+        const auto possibleMatches = hashPositions.equal_range(srcPositionHash);
+        if (possibleMatches.first == hashPositions.cend())
+        {
+            return bestMatch;
+        }
+        // now find actual matches
+        const int32_t MaxMatchLength = srcPosition + Lz4Constants::MAX_MATCH_LENGTH >= src.size() ? src.size() - srcPosition - 1 : Lz4Constants::MAX_MATCH_LENGTH;
+        for (auto possibleMatchIt = possibleMatches.first; possibleMatchIt != possibleMatches.second; ++possibleMatchIt)
+        {
+            // get position of possible match found in src and make sure it is towards front of buffer
+            const auto matchStartPosition = possibleMatchIt->second;
+            // calculate match distance and make sure it stays below the max. allowed distance
+            const int32_t distance = srcPosition - matchStartPosition;
+            if (matchStartPosition < srcPosition && distance <= static_cast<int32_t>(Lz4Constants::MAX_MATCH_DISTANCE))
+            {
+                // if we currently have no best match, store this one
+                if (bestMatch.distance == 0 && bestMatch.length == 0)
+                {
+                    bestMatch = {distance, Lz4Constants::MIN_MATCH_LENGTH};
+                }
+                // we already know the match length is >= Lz4Constants::MIN_MATCH_LENGTH, so start with Lz4Constants::MIN_MATCH_LENGTH + 1
+                for (int32_t matchLength = (Lz4Constants::MIN_MATCH_LENGTH + 1); matchLength <= MaxMatchLength; ++matchLength)
+                {
+                    // make sure we have enough bytes for a match of matchLength
+                    if ((matchStartPosition + matchLength) >= static_cast<int32_t>(src.size()))
+                    {
+                        return bestMatch;
+                    }
+                    // match byte at match position toward end of buffer and break if it does not match anymore
+                    if (src[matchStartPosition + matchLength - 1] != src[srcPosition + matchLength - 1])
+                    {
+                        break;
+                    }
+                    // check if we've found a better match
+                    if (matchLength > bestMatch.length)
+                    {
+                        bestMatch.distance = distance;
+                        bestMatch.length = matchLength;
+                        // check if we could improve or can return now
+                        if (matchLength >= static_cast<int32_t>(Lz4Constants::MAX_MATCH_LENGTH))
+                        {
+                            return bestMatch;
+                        }
+                    }
+                }
+            }
+        }
+        return bestMatch;
+    }
+
+    static auto extraLengthBytesNeeded(int32_t length) -> uint32_t
+    {
+        uint32_t extraBytesNeeded = 0;
+        // 15 marks the start of a new byte
+        length -= 15;
+        while (length >= 0)
+        {
+            length -= 255;
+            extraBytesNeeded++;
+        }
+        return extraBytesNeeded;
+    }
+
+    struct TokenInfo
+    {
+        std::vector<uint8_t> literals;
+        uint32_t matchLength = 0;
+        uint32_t matchOffset = 0;
+    };
+
+    static auto flushToken(std::vector<uint8_t> &dst, const TokenInfo &token) -> void
+    {
+        uint8_t tokenByte = 0;
+        const auto tokenOffset = dst.size();
+        dst.push_back(0);
+        // check if our token has literal bytes
+        if (!token.literals.empty())
+        {
+            // store literal length
+            int32_t storedLiteralLength = token.literals.size();
+            if (storedLiteralLength < 15)
+            {
+                // store literal length only in token byte
+                tokenByte |= storedLiteralLength << Lz4Constants::LITERAL_LENGTH_SHIFT;
+            }
+            else
+            {
+                // store extra literal length bytes after token
+                tokenByte |= 15 << 4;
+                storedLiteralLength -= 15;
+                while (storedLiteralLength >= 0)
+                {
+                    dst.push_back(storedLiteralLength >= 255 ? 255 : storedLiteralLength);
+                    storedLiteralLength -= 255;
+                }
+            }
+            // store literals
+            std::copy(token.literals.cbegin(), token.literals.cend(), std::back_inserter(dst));
+        }
+        // check if if token has match
+        if (token.matchLength > 0)
+        {
+            // store match offset
+            dst.push_back((token.matchOffset >> 8) & 0xFF);
+            dst.push_back(token.matchOffset & 0xFF);
+            // store literal length
+            int32_t storedMatchLength = token.matchLength - (Lz4Constants::MIN_MATCH_LENGTH - 1);
+            if (storedMatchLength < 15)
+            {
+                // store match length only in token byte
+                tokenByte |= storedMatchLength;
+            }
+            else
+            {
+                // store extra match length bytes after token
+                tokenByte |= 15;
+                storedMatchLength -= 15;
+                while (storedMatchLength >= 0)
+                {
+                    dst.push_back(storedMatchLength >= 255 ? 255 : storedMatchLength);
+                    storedMatchLength -= 255;
+                }
+            }
+        }
+        dst[tokenOffset] = tokenByte;
+    }
+
+    auto encodeLZ4_40Multimap(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    {
+        REQUIRE(src.size() > Lz4Constants::MIN_MATCH_LENGTH, std::runtime_error, "Data too small");
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data too big");
+        // store uncompressed size and LZ4 marker flag at start of destination
+        std::vector<uint8_t> dst(4, 0);
+        *reinterpret_cast<uint32_t *>(dst.data()) = (src.size() << 8) | Lz4Constants::TYPE_MARKER;
+        // build minmatch hash table for input data. it maps a hash (first Lz4Constants::MIN_MATCH_LENGTH bytes of data) to its position(s)
+        std::multimap<uint32_t, int32_t> hashPositions;
+        for (int32_t srcPosition = 0; srcPosition < static_cast<int32_t>(src.size() - Lz4Constants::MIN_MATCH_LENGTH); ++srcPosition)
+        {
+            const uint32_t hash = *reinterpret_cast<const uint32_t *>(src.data() + srcPosition);
+            hashPositions.insert({hash, srcPosition});
+        }
+        // build match information for every byte except the last 4
+        std::map<uint32_t, MatchInfo> matches;
+#pragma omp parallel for
+        for (int srcPosition = 0; srcPosition < static_cast<int>(src.size() - Lz4Constants::MIN_MATCH_LENGTH); ++srcPosition)
+        {
+            auto match = findBestMatch(src, hashPositions, srcPosition);
+            if (match.length >= static_cast<int32_t>(Lz4Constants::MIN_MATCH_LENGTH))
+#pragma omp critical
+            {
+                matches[srcPosition] = match;
+            }
+        }
+        // if we haven't found any matches, no need to check them
+        if (!matches.empty())
+        {
+            // optimize match cost
+            std::vector<uint32_t> cost(src.size(), 0);
+            uint32_t currentCost = 0;
+            // iterate through the matches in reverse until the first match
+            for (int32_t srcPosition = src.size() - 1; srcPosition > static_cast<int32_t>(matches.cbegin()->first); --srcPosition)
+            {
+                auto matchIt = matches.find(srcPosition);
+                if (matchIt != matches.cend())
+                {
+                    // here we are at a match. calculate cost
+                    // a match stores as one byte, plus two bytes offset, plus one byte for match length > 15, two over 270, ...
+                    auto currMatchLength = matchIt->second.length;
+                    auto bestCost = 3 + extraLengthBytesNeeded(currMatchLength - Lz4Constants::MIN_MATCH_LENGTH) + currentCost;
+                    while (currMatchLength >= static_cast<int32_t>(Lz4Constants::MIN_MATCH_LENGTH))
+                    {
+                        // cost of this match is the cost of the match plus the cost of the rest of the new encoding
+                        // which is stored at cost[match_position + match_length]
+                        const auto matchCost = 3 + extraLengthBytesNeeded(currMatchLength - Lz4Constants::MIN_MATCH_LENGTH) + cost[srcPosition + currMatchLength];
+                        if (bestCost > matchCost)
+                        {
+                            bestCost = matchCost;
+                            matchIt->second.length = currMatchLength;
+                        }
+                        --currMatchLength;
+                    }
+                    // a literal stores a one byte, plus one byte for literal length > 15, two over 270, ...
+                    const auto literalCost = 1 + cost[srcPosition + 1];
+                    // check if storing literals is cheaper than the best current match
+                    if (literalCost < bestCost)
+                    {
+                        bestCost = literalCost;
+                        // remove match from list. it is not needed anymore
+                        matches.erase(srcPosition);
+                    }
+                    // store current match cost
+                    cost[srcPosition] = bestCost;
+                    currentCost = bestCost;
+                }
+                else
+                {
+                    // here we have a literal
+                    cost[srcPosition] = ++currentCost;
+                }
+            }
+        }
+        // compress source by iterating through matches
+        TokenInfo currentToken;
+        std::size_t srcPosition = 0;
+        while (srcPosition < src.size())
+        {
+            // check if the current byte will be a match
+            if (auto matchIt = matches.find(srcPosition); matchIt != matches.cend())
+            {
+                // store the match in the current (or new) token
+                currentToken.matchLength = matchIt->second.length;
+                currentToken.matchOffset = matchIt->second.distance;
+                // skip match length bytes in source
+                srcPosition += matchIt->second.length;
+                // flush the token
+                flushToken(dst, currentToken);
+                currentToken = TokenInfo();
+            }
+            else
+            {
+                // no matches found, store literal
+                currentToken.literals.push_back(src[srcPosition++]);
+            }
+        }
+        // if we still have a token pending, flush it
+        if (!currentToken.literals.empty() || currentToken.matchLength > 0)
+        {
+            flushToken(dst, currentToken);
+        }
+        // resize to multiple of 4
+        while ((dst.size() % 4) != 0)
+        {
+            dst.push_back(0);
+        }
+        return dst;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Benchmark
+{
+    /// @brief Compress input data using LZ4 variant 40h with the previous multimap-based match finder.
+    /// Every position is inserted into a std::multimap, all matches are searched in parallel and
+    /// collected into a std::map, then a cost-based parse picks the matches to use.
+    /// Only kept as a reference to compare the hash-chain encoder in Compression::encodeLZ4_40() against.
+    /// Output can be decompressed with Compression::decodeLZ4_40()
+    auto encodeLZ4_40Multimap(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+}
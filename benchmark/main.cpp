@@ -0,0 +1,74 @@
+#include "benchmark.h"
+
+#include "exception.h"
+
+#include <iostream>
+#include <omp.h>
+#include <string>
+
+#include "cxxopts/include/cxxopts.hpp"
+
+int main(int argc, const char *argv[])
+{
+    try
+    {
+        Benchmark::Options options;
+        options.dataPath = "../../data/";
+        std::string jsonFile;
+        std::string csvFile;
+        uint32_t nrOfThreads = 0;
+        cxxopts::Options opts("benchmarks", "Run compression and codec micro-benchmarks on synthetic and corpus data");
+        opts.add_option("", {"h,help", "Print help"});
+        opts.add_option("", {"list", "List all benchmarks and exit"});
+        opts.add_option("", {"filter", "Only run benchmarks with \"suite::name\" containing this string, e.g. \"--filter=LZ4\"", cxxopts::value(options.filter)});
+        opts.add_option("", {"data", "Path to the data directory of the repository (default=\"../../data/\"). Corpus benchmarks are skipped if files can not be read", cxxopts::value(options.dataPath)});
+        opts.add_option("", {"mintime", "Minimum time in ms to run every measurement for (default=200)", cxxopts::value(options.minTimeMs)});
+        opts.add_option("", {"miniterations", "Minimum number of runs for every measurement (default=3)", cxxopts::value(options.minIterations)});
+        opts.add_option("", {"threads", "Number of threads to use for parallel code (default=number of processors)", cxxopts::value(nrOfThreads)});
+        opts.add_option("", {"json", "Write results to JSON file, e.g. \"--json=results.json\"", cxxopts::value(jsonFile)});
+        opts.add_option("", {"csv", "Write results to CSV file, e.g. \"--csv=results.csv\"", cxxopts::value(csvFile)});
+        auto result = opts.parse(argc, argv);
+        if (result.count("help"))
+        {
+            std::cout << opts.help() << std::endl;
+            return 0;
+        }
+        if (result.count("list"))
+        {
+            for (const auto &name : Benchmark::list())
+            {
+                std::cout << name << std::endl;
+            }
+            return 0;
+        }
+        if (!options.dataPath.empty() && options.dataPath.back() != '/')
+        {
+            options.dataPath.push_back('/');
+        }
+        REQUIRE(options.minTimeMs >= 0, std::runtime_error, "Minimum time must be >= 0");
+        REQUIRE(options.minIterations >= 1, std::runtime_error, "Minimum number of iterations must be >= 1");
+        // set up number of cores for parallel processing
+        omp_set_num_threads(nrOfThreads > 0 ? static_cast<int>(nrOfThreads) : omp_get_num_procs());
+        // run benchmarks and store results
+        const auto results = Benchmark::run(options);
+        if (!jsonFile.empty())
+        {
+            Benchmark::writeJSON(jsonFile, results);
+        }
+        if (!csvFile.empty())
+        {
+            Benchmark::writeCSV(csvFile, results);
+        }
+    }
+    catch (const cxxopts::exceptions::parsing &e)
+    {
+        std::cerr << "Argument error: " << e.what() << std::endl;
+        return 2;
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include "sys/interrupts.h"
 #include "sys/memctrl.h"
 #include "tui.h"
+#include "vid2hdecoder.h"
 #include "videoplayer.h"
 
 #include "data/video.h"
@@ -38,6 +39,20 @@ int main()
 	}
 	// get media info and check if we have meta data
 	const auto mediaInfo = IO::Vid2h::GetInfo(reinterpret_cast<const uint32_t *>(VIDEO_DATA), VIDEO_DATA_SIZE);
+	// refuse to play files we can not decode, e.g. made with "vid2h --lzdict"
+	if (!Media::CanDecode(mediaInfo))
+	{
+		TUI::setup();
+		TUI::fillForeground(TUI::Color::Black);
+		TUI::fillBackground(TUI::Color::Black);
+		TUI::setColor(TUI::Color::Black, TUI::Color::Red);
+		TUI::printf(0, 9, "  Unsupported compression type");
+		TUI::printf(0, 10, "    Can not play this file");
+		do
+		{
+			Input::waitForKeysDown(Input::KeyA, true);
+		} while (true);
+	}
 	do
 	{
 		// set up text UI
@@ -9,6 +9,7 @@
 #include "video/dxtv.h"
 
 #include "audio_processingtype.h"
+#include "auto_constants.h"
 #include "image_processingtype.h"
 
 #define USE_ADPCM_ASM
@@ -35,6 +36,55 @@
 namespace Media
 {
 
+    /// @brief Decompress Huffman 20h data using BIOS function HuffUnComp (SWI 13h). Writes 32-bit units, so this is safe for VRAM
+    IWRAM_FUNC static auto HuffUnComp(const uint32_t *src, uint32_t *dst) -> void
+    {
+        register const uint32_t *r0 asm("r0") = src;
+        register uint32_t *r1 asm("r1") = dst;
+        // BIOS calls follow the AAPCS, so they may change r0-r3, r12, lr and the flags
+#if defined(__thumb__)
+        asm volatile("swi 0x13" : "+r"(r0), "+r"(r1) : : "r2", "r3", "r12", "lr", "cc", "memory");
+#else
+        asm volatile("swi 0x130000" : "+r"(r0), "+r"(r1) : : "r2", "r3", "r12", "lr", "cc", "memory");
+#endif
+    }
+
+    auto CanDecode(const IO::Vid2h::Info &info) -> bool
+    {
+        for (uint32_t pi = 0; pi < info.nrOfVideoProcessings; ++pi)
+        {
+            switch (info.video.processing[pi])
+            {
+            case Image::ProcessingType::Uncompressed:
+            case Image::ProcessingType::CompressRLE:
+            case Image::ProcessingType::CompressLZSS_10:
+            case Image::ProcessingType::CompressHuffman_20:
+            case Image::ProcessingType::CompressLZ4_40:
+            case Image::ProcessingType::CompressAuto:
+            case Image::ProcessingType::CompressDXTV:
+                break;
+            default:
+                // e.g. CompressLZ4Dictionary_40, which needs the previous frame as LZ4 dictionary
+                return false;
+            }
+        }
+        for (uint32_t pi = 0; pi < info.nrOfAudioProcessings; ++pi)
+        {
+            switch (info.audio.processing[pi])
+            {
+            case Audio::ProcessingType::Uncompressed:
+            case Audio::ProcessingType::CompressRLE:
+            case Audio::ProcessingType::CompressLZSS_10:
+            case Audio::ProcessingType::CompressLZ4_40:
+            case Audio::ProcessingType::CompressADPCM:
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
     IWRAM_FUNC auto DecodeVideo(uint32_t *scratchPad32, const uint32_t scratchPadSize8, uint8_t *vramPtr8, const uint32_t vramLineStride8, const IO::Vid2h::Info &info, const IO::Vid2h::Frame &frame) -> std::pair<const uint32_t *, uint32_t>
     {
         auto currentSrc32 = frame.data;
@@ -53,6 +103,13 @@ namespace Media
             case Image::ProcessingType::CompressLZSS_10:
                 uncompressedSize8 = Compression::BIOSUnCompGetSize_ASM(currentSrc32);
                 break;
+            case Image::ProcessingType::CompressHuffman_20:
+                uncompressedSize8 = Compression::BIOSUnCompGetSize_ASM(currentSrc32);
+                break;
+            case Image::ProcessingType::CompressAuto:
+                // all automatically compressed data has the size in the upper 3 bytes of the header
+                uncompressedSize8 = Compression::BIOSUnCompGetSize_ASM(currentSrc32);
+                break;
             case Image::ProcessingType::CompressLZ4_40:
 #ifdef USE_LZ4_ASM
                 uncompressedSize8 = Compression::LZ4UnCompGetSize_ASM(currentSrc32);
@@ -86,6 +143,9 @@ namespace Media
             case Image::ProcessingType::CompressLZSS_10:
                 dstInVRAM ? Compression::LZ77UnCompWrite16bit_ASM(currentSrc32, currentDst32) : Compression::LZ77UnCompWrite8bit_ASM(currentSrc32, currentDst32);
                 break;
+            case Image::ProcessingType::CompressHuffman_20:
+                HuffUnComp(currentSrc32, currentDst32);
+                break;
             case Image::ProcessingType::CompressLZ4_40:
 #ifdef USE_LZ4_ASM
                 Compression::LZ4UnCompWrite16bit_ASM(currentSrc32, currentDst32);
@@ -93,6 +153,25 @@ namespace Media
                 Compression::LZ4UnCompWrite8bit(currentSrc32, currentDst32);
 #endif
                 break;
+            case Image::ProcessingType::CompressAuto:
+                // dispatch on the type marker of the compressor chosen for this frame
+                switch (*currentSrc32 & 0xFF)
+                {
+                case Compression::AutoConstants::TYPE_MARKER_LZSS_10:
+                    dstInVRAM ? Compression::LZ77UnCompWrite16bit_ASM(currentSrc32, currentDst32) : Compression::LZ77UnCompWrite8bit_ASM(currentSrc32, currentDst32);
+                    break;
+                case Compression::AutoConstants::TYPE_MARKER_LZ4_40:
+#ifdef USE_LZ4_ASM
+                    Compression::LZ4UnCompWrite16bit_ASM(currentSrc32, currentDst32);
+#else
+                    Compression::LZ4UnCompWrite8bit(currentSrc32, currentDst32);
+#endif
+                    break;
+                default:
+                    Memory::memcpy32(currentDst32, currentSrc32 + 1, (uncompressedSize8 + 3) / 4);
+                    break;
+                }
+                break;
             case Image::ProcessingType::CompressDXTV:
 #ifdef USE_DXTV_ASM
                 Dxtv::UnCompWrite16bit_ASM(currentSrc32, currentDst32, (const uint32_t *)vramPtr8, vramLineStride8, info.video.width, info.video.height);
@@ -8,6 +8,11 @@
 namespace Media
 {
 
+    /// @brief Check if all video and audio processing steps in a file can be decoded by the GBA player
+    /// @param info Static video info
+    /// @return Returns true if all processing steps are supported
+    auto CanDecode(const IO::Vid2h::Info &info) -> bool;
+
     /// @brief Decode video frame to scratchPad, possibly using a scratchPad as intermediate memory
     /// @param scratchPad32 Memory for decoding in bytes. Must be able to hold a full decoded frame AND intermediate memory. Must be aligned to 4 bytes!
     /// @param scratchPadSize8 Size of memory for decoding in bytes. Must be a multiple of 4 bytes!
@@ -19,6 +19,7 @@ namespace Audio
             {ProcessingType::Resample, {"resample", ConvertFunc(resample)}},
             {ProcessingType::Repackage, {"repackage", ConvertFunc(repackage)}},
             {ProcessingType::CompressLZ4_40, {"compress LZ4 40h", ConvertFunc(compressLZ4_40)}},
+            {ProcessingType::CompressLZ4Dictionary_40, {"compress LZ4 40h dictionary", ConvertStateFunc(compressLZ4Dictionary_40)}},
             {ProcessingType::CompressLZSS_10, {"compress LZSS 10h", ConvertFunc(compressLZSS_10)}},
             {ProcessingType::CompressRANS_50, {"compress rANS 50h", ConvertFunc(compressRANS_50)}},
             //{ProcessingType::CompressRLE, {"compress RLE", ConvertFunc(compressRLE)}},
@@ -97,11 +98,12 @@ namespace Audio
     std::optional<Frame> Processing::compressLZ4_40(Processing &processing, const Frame &frame, const std::vector<Parameter> &parameters, bool flushBuffers, Statistics::Frame::SPtr statistics)
     {
         // get parameter(s)
-        REQUIRE(VariantHelpers::hasTypes<bool>(parameters), std::runtime_error, "compressLZ4_40 expects a bool VRAMcompatible parameter");
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZ4_40 expects a bool VRAMcompatible and a bool optimal parse parameter");
         const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
         // compress data
         auto result = frame;
-        result.data = Compression::encodeLZ4_40(AudioHelpers::toRawData(result.data, result.info.channelFormat), vramCompatible);
+        result.data = Compression::encodeLZ4_40(AudioHelpers::toRawData(result.data, result.info.channelFormat), vramCompatible, optimalParse);
         result.info.compressed = true;
         // print statistics
         if (statistics != nullptr)
@@ -112,14 +114,36 @@ namespace Audio
         return result;
     }
 
+    std::optional<Frame> Processing::compressLZ4Dictionary_40(Processing &processing, const Frame &frame, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, bool flushBuffers, Statistics::Frame::SPtr statistics)
+    {
+        // get parameter(s)
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZ4Dictionary_40 expects a bool VRAMcompatible and a bool optimal parse parameter");
+        const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
+        // compress data. the uncompressed data of the previous frame is used as dictionary
+        auto result = frame;
+        auto rawData = AudioHelpers::toRawData(result.data, result.info.channelFormat);
+        result.data = Compression::encodeLZ4_40(rawData, state, vramCompatible, optimalParse);
+        result.info.compressed = true;
+        state = std::move(rawData);
+        // print statistics
+        if (statistics != nullptr)
+        {
+            const auto ratioPercent = static_cast<double>(AudioHelpers::rawDataSize(result.data) * 100.0 / static_cast<double>(AudioHelpers::rawDataSize(frame.data)));
+            std::cout << "LZ4 40h dictionary compression ratio: " << std::fixed << std::setprecision(1) << ratioPercent << "%" << std::endl;
+        }
+        return result;
+    }
+
     std::optional<Frame> Processing::compressLZSS_10(Processing &processing, const Frame &frame, const std::vector<Parameter> &parameters, bool flushBuffers, Statistics::Frame::SPtr statistics)
     {
         // get parameter(s)
-        REQUIRE(VariantHelpers::hasTypes<bool>(parameters), std::runtime_error, "compressLZSS_10 expects a bool VRAMcompatible parameter");
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZSS_10 expects a bool VRAMcompatible and a bool optimal parse parameter");
         const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
         // compress data
         auto result = frame;
-        result.data = Compression::encodeLZSS_10(AudioHelpers::toRawData(result.data, result.info.channelFormat), vramCompatible);
+        result.data = Compression::encodeLZSS_10(AudioHelpers::toRawData(result.data, result.info.channelFormat), vramCompatible, optimalParse);
         result.info.compressed = true;
         // print statistics
         if (statistics != nullptr)
@@ -104,14 +104,26 @@ namespace Audio
         /// @brief Compress audio data using LZ4 variant 40h
         /// @param parameters:
         /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
         /// @param flushBuffers Pass true to dump queued data from internal buffers to the output frame
         /// @param statistics Statistics container to write statistics to
         /// @return Compressed frame
         static std::optional<Frame> compressLZ4_40(Processing &processing, const Frame &frame, const std::vector<Parameter> &parameters, bool flushBuffers, Statistics::Frame::SPtr statistics);
 
+        /// @brief Compress audio data using LZ4 variant 40h with the previous frame as dictionary
+        /// @param parameters:
+        /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
+        /// @param state Uncompressed data of previous frame
+        /// @param flushBuffers Pass true to dump queued data from internal buffers to the output frame
+        /// @param statistics Statistics container to write statistics to
+        /// @return Compressed frame
+        static std::optional<Frame> compressLZ4Dictionary_40(Processing &processing, const Frame &frame, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, bool flushBuffers, Statistics::Frame::SPtr statistics);
+
         /// @brief Compress audio data using LZSS variant 10h
         /// @param parameters:
         /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
         /// @param flushBuffers Pass true to dump queued data from internal buffers to the output frame
         /// @param statistics Statistics container to write statistics to
         /// @return Compressed frame
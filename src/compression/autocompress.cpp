@@ -0,0 +1,112 @@
+#include "autocompress.h"
+
+#include "exception.h"
+#include "if/auto_constants.h"
+#include "lz4.h"
+#include "lzss.h"
+
+namespace Compression
+{
+
+    auto estimateDecodeCycles(uint8_t typeMarker, uint32_t compressedSize, uint32_t uncompressedSize) -> double
+    {
+        DecodeCycles cycles;
+        switch (typeMarker)
+        {
+        case AutoConstants::TYPE_MARKER_UNCOMPRESSED:
+            cycles = AUTO_CYCLES_UNCOMPRESSED;
+            break;
+        case AutoConstants::TYPE_MARKER_LZ4_40:
+            cycles = AUTO_CYCLES_LZ4_40;
+            break;
+        case AutoConstants::TYPE_MARKER_LZSS_10:
+            cycles = AUTO_CYCLES_LZSS_10;
+            break;
+        default:
+            THROW(std::runtime_error, "Unsupported compression type " << static_cast<uint32_t>(typeMarker));
+        }
+        return cycles.perInputByte * compressedSize + cycles.perOutputByte * uncompressedSize;
+    }
+
+    /// @brief Store data uncompressed with a 4 byte header and pad to a multiple of 4 bytes
+    static auto storeUncompressed(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> dst(4);
+        *reinterpret_cast<uint32_t *>(dst.data()) = (static_cast<uint32_t>(src.size()) << 8) | AutoConstants::TYPE_MARKER_UNCOMPRESSED;
+        dst.insert(dst.end(), src.cbegin(), src.cend());
+        dst.resize((dst.size() + 3) & ~3U, 0);
+        return dst;
+    }
+
+    auto encodeAuto(const std::vector<uint8_t> &src, bool useLZ4, bool useLZSS, bool vramCompatible, bool optimalParse, double cycleWeight) -> std::vector<uint8_t>
+    {
+        REQUIRE(!src.empty(), std::runtime_error, "Data can not be empty");
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data size must be < 16MB");
+        REQUIRE(cycleWeight >= 0.0, std::runtime_error, "Cycle weight must be >= 0");
+        // candidates are in order of decoding speed, so on equal cost the faster one wins
+        std::vector<uint8_t> typeMarkers = {AutoConstants::TYPE_MARKER_UNCOMPRESSED};
+        if (useLZ4)
+        {
+            typeMarkers.push_back(AutoConstants::TYPE_MARKER_LZ4_40);
+        }
+        if (useLZSS)
+        {
+            typeMarkers.push_back(AutoConstants::TYPE_MARKER_LZSS_10);
+        }
+        std::vector<std::vector<uint8_t>> results(typeMarkers.size());
+#pragma omp parallel for
+        for (int32_t i = 0; i < static_cast<int32_t>(typeMarkers.size()); ++i)
+        {
+            switch (typeMarkers[i])
+            {
+            case AutoConstants::TYPE_MARKER_LZ4_40:
+                results[i] = encodeLZ4_40(src, vramCompatible, optimalParse);
+                break;
+            case AutoConstants::TYPE_MARKER_LZSS_10:
+                results[i] = encodeLZSS_10(src, vramCompatible, optimalParse);
+                break;
+            default:
+                results[i] = storeUncompressed(src);
+                break;
+            }
+        }
+        // find result with lowest cost
+        std::size_t bestIndex = 0;
+        double bestCost = 0.0;
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto cost = results[i].size() + cycleWeight * estimateDecodeCycles(typeMarkers[i], static_cast<uint32_t>(results[i].size()), static_cast<uint32_t>(src.size()));
+            if (i == 0 || cost < bestCost)
+            {
+                bestIndex = i;
+                bestCost = cost;
+            }
+        }
+        // pad to multiple of 4 bytes
+        auto dst = std::move(results[bestIndex]);
+        dst.resize((dst.size() + 3) & ~3U, 0);
+        return dst;
+    }
+
+    auto decodeAuto(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    {
+        REQUIRE(src.size() >= 4, std::runtime_error, "Data too small");
+        const uint32_t header = *reinterpret_cast<const uint32_t *>(src.data());
+        const uint8_t typeMarker = header & 0xFF;
+        switch (typeMarker)
+        {
+        case AutoConstants::TYPE_MARKER_UNCOMPRESSED:
+        {
+            const uint32_t uncompressedSize = header >> 8;
+            REQUIRE(src.size() >= 4 + uncompressedSize, std::runtime_error, "Data too small");
+            return std::vector<uint8_t>(std::next(src.cbegin(), 4), std::next(src.cbegin(), 4 + uncompressedSize));
+        }
+        case AutoConstants::TYPE_MARKER_LZ4_40:
+            return decodeLZ4_40(src);
+        case AutoConstants::TYPE_MARKER_LZSS_10:
+            return decodeLZSS_10(src);
+        default:
+            THROW(std::runtime_error, "Unsupported compression type " << static_cast<uint32_t>(typeMarker));
+        }
+    }
+}
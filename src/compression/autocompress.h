@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Compression
+{
+    /// @brief Rough estimate of GBA decoding cycles for a compression type
+    struct DecodeCycles
+    {
+        double perInputByte = 0.0;  // Cycles per compressed byte read
+        double perOutputByte = 0.0; // Cycles per decompressed byte written
+    };
+
+    constexpr DecodeCycles AUTO_CYCLES_UNCOMPRESSED = {0.0, 1.5}; // 32-bit copy from ROM
+    constexpr DecodeCycles AUTO_CYCLES_LZ4_40 = {4.0, 1.5};       // LZ4 ASM decoder, copies matches using 16-bit writes
+    constexpr DecodeCycles AUTO_CYCLES_LZSS_10 = {8.0, 3.0};      // LZSS ASM decoder, flag byte per 8 tokens and byte-wise match copies
+
+    /// @brief Estimate GBA decoding cycles for data
+    /// @param typeMarker Compression type marker from AutoConstants
+    /// @param compressedSize Size of compressed data in bytes
+    /// @param uncompressedSize Size of uncompressed data in bytes
+    auto estimateDecodeCycles(uint8_t typeMarker, uint32_t compressedSize, uint32_t uncompressedSize) -> double;
+
+    /// @brief Compress input data with all enabled compressors and store it uncompressed, then return the result with the lowest cost.
+    /// The cost is: compressed size in bytes + cycleWeight * estimated GBA decode cycles. The compressors are run in parallel.
+    /// The result starts with the 4 byte header of the compressor chosen, so the type marker in the lowest byte tells the decoder what to do
+    /// @param useLZ4 Try LZ4 variant 40h
+    /// @param useLZSS Try LZSS variant 10h
+    /// @param vramCompatible If true no matches with distance 1 are used, so data can be decompressed to VRAM
+    /// @param optimalParse If true use optimal parsing for the LZ compressors
+    /// @param cycleWeight How many bytes one decode cycle is worth. 0 always picks the smallest result. Must be >= 0
+    /// @note Results are padded to a multiple of 4 bytes
+    auto encodeAuto(const std::vector<uint8_t> &data, bool useLZ4, bool useLZSS, bool vramCompatible = false, bool optimalParse = false, double cycleWeight = 0.0) -> std::vector<uint8_t>;
+
+    /// @brief Decompress automatically compressed data by dispatching on the type marker in the header
+    auto decodeAuto(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+}
@@ -0,0 +1,104 @@
+#include "chunked.h"
+
+#include "autocompress.h"
+#include "exception.h"
+#include "if/chunked_constants.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace Compression
+{
+
+    static auto readUint32(const std::vector<uint8_t> &data, std::size_t offset) -> uint32_t
+    {
+        REQUIRE(offset + 4 <= data.size(), std::runtime_error, "Data too small");
+        return *reinterpret_cast<const uint32_t *>(data.data() + offset);
+    }
+
+    /// @brief Read and check header of chunked data
+    /// @return Uncompressed size, chunk size and number of chunks
+    static auto readDirectory(const std::vector<uint8_t> &data) -> std::tuple<uint32_t, uint32_t, uint32_t>
+    {
+        const uint32_t header = readUint32(data, 0);
+        REQUIRE((header & 0xFF) == ChunkedConstants::TYPE_MARKER, std::runtime_error, "Data is not chunked");
+        const uint32_t uncompressedSize = header >> 8;
+        const uint32_t chunkSize = readUint32(data, 4);
+        REQUIRE(chunkSize > 0, std::runtime_error, "Bad chunk size");
+        const uint32_t nrOfChunks = (uncompressedSize + chunkSize - 1) / chunkSize;
+        REQUIRE(ChunkedConstants::DIRECTORY_OFFSET + 4 * static_cast<std::size_t>(nrOfChunks) <= data.size(), std::runtime_error, "Data too small");
+        return {uncompressedSize, chunkSize, nrOfChunks};
+    }
+
+    auto encodeChunked(const std::vector<uint8_t> &src, uint32_t chunkSize, const ChunkEncodeFunc &encodeChunk) -> std::vector<uint8_t>
+    {
+        REQUIRE(!src.empty(), std::runtime_error, "Data can not be empty");
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data size must be < 16MB");
+        REQUIRE(chunkSize > 0 && chunkSize % 4 == 0, std::runtime_error, "Chunk size must be > 0 and a multiple of 4");
+        const auto srcSize = static_cast<uint32_t>(src.size());
+        const uint32_t nrOfChunks = (srcSize + chunkSize - 1) / chunkSize;
+        // compress chunks in parallel
+        std::vector<std::vector<uint8_t>> chunks(nrOfChunks);
+#pragma omp parallel for schedule(dynamic)
+        for (int32_t i = 0; i < static_cast<int32_t>(nrOfChunks); ++i)
+        {
+            const uint32_t chunkStart = i * chunkSize;
+            const uint32_t chunkEnd = std::min(chunkStart + chunkSize, srcSize);
+            chunks[i] = encodeChunk(std::vector<uint8_t>(std::next(src.cbegin(), chunkStart), std::next(src.cbegin(), chunkEnd)));
+            chunks[i].resize((chunks[i].size() + 3) & ~3U, 0);
+        }
+        // build directory and append chunks
+        std::vector<uint8_t> dst(ChunkedConstants::DIRECTORY_OFFSET + 4 * nrOfChunks);
+        auto dst32 = reinterpret_cast<uint32_t *>(dst.data());
+        dst32[0] = (srcSize << 8) | ChunkedConstants::TYPE_MARKER;
+        dst32[1] = chunkSize;
+        for (uint32_t i = 0; i < nrOfChunks; ++i)
+        {
+            *reinterpret_cast<uint32_t *>(dst.data() + ChunkedConstants::DIRECTORY_OFFSET + 4 * i) = static_cast<uint32_t>(dst.size());
+            dst.insert(dst.end(), chunks[i].cbegin(), chunks[i].cend());
+        }
+        return dst;
+    }
+
+    auto chunkCount(const std::vector<uint8_t> &data) -> uint32_t
+    {
+        return std::get<2>(readDirectory(data));
+    }
+
+    auto decodeChunk(const std::vector<uint8_t> &data, uint32_t index) -> std::vector<uint8_t>
+    {
+        const auto [uncompressedSize, chunkSize, nrOfChunks] = readDirectory(data);
+        REQUIRE(index < nrOfChunks, std::runtime_error, "Chunk index out of range");
+        const uint32_t chunkStart = readUint32(data, ChunkedConstants::DIRECTORY_OFFSET + 4 * index);
+        const uint32_t chunkEnd = index + 1 < nrOfChunks ? readUint32(data, ChunkedConstants::DIRECTORY_OFFSET + 4 * (index + 1)) : static_cast<uint32_t>(data.size());
+        REQUIRE(chunkStart < chunkEnd && chunkEnd <= data.size(), std::runtime_error, "Bad chunk offset");
+        auto chunk = decodeAuto(std::vector<uint8_t>(std::next(data.cbegin(), chunkStart), std::next(data.cbegin(), chunkEnd)));
+        const uint32_t expectedSize = std::min(chunkSize, uncompressedSize - index * chunkSize);
+        REQUIRE(chunk.size() == expectedSize, std::runtime_error, "Bad chunk size " << chunk.size() << ", expected " << expectedSize);
+        return chunk;
+    }
+
+    auto decodeChunked(const std::vector<uint8_t> &data) -> std::vector<uint8_t>
+    {
+        const auto [uncompressedSize, chunkSize, nrOfChunks] = readDirectory(data);
+        std::vector<uint8_t> dst(uncompressedSize);
+        // decode chunks in parallel. they do not overlap in the output
+        bool failed = false;
+#pragma omp parallel for
+        for (int32_t i = 0; i < static_cast<int32_t>(nrOfChunks); ++i)
+        {
+            try
+            {
+                const auto chunk = decodeChunk(data, i);
+                std::copy(chunk.cbegin(), chunk.cend(), std::next(dst.begin(), i * chunkSize));
+            }
+            catch (const std::runtime_error &)
+            {
+#pragma omp atomic write
+                failed = true;
+            }
+        }
+        REQUIRE(!failed, std::runtime_error, "Failed to decode chunk");
+        return dst;
+    }
+}
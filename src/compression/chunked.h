@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Compression
+{
+    /// @brief Function compressing one chunk of data. The result must start with a 4 byte header with the type marker in the lowest byte
+    using ChunkEncodeFunc = std::function<std::vector<uint8_t>(const std::vector<uint8_t> &)>;
+
+    /// @brief Split data into chunks of chunkSize bytes and compress them independently and in parallel.
+    /// The result starts with a chunk directory, so decoders can decompress single chunks (see ChunkedConstants)
+    /// @param data Input data
+    /// @param chunkSize Uncompressed size of chunks in bytes. Must be a multiple of 4, so chunks stay 32-bit aligned when decompressing
+    /// @param encodeChunk Function used to compress a chunk. Must be thread-safe. Chunks are decompressed with decodeAuto(), so the result must be understood by it
+    /// @note Results are padded to a multiple of 4 bytes
+    auto encodeChunked(const std::vector<uint8_t> &data, uint32_t chunkSize, const ChunkEncodeFunc &encodeChunk) -> std::vector<uint8_t>;
+
+    /// @brief Get the number of chunks in chunked data
+    auto chunkCount(const std::vector<uint8_t> &data) -> uint32_t;
+
+    /// @brief Decompress a single chunk of chunked data
+    /// @param data Chunked data
+    /// @param index Chunk index in [0, chunkCount(data))
+    auto decodeChunk(const std::vector<uint8_t> &data, uint32_t index) -> std::vector<uint8_t>;
+
+    /// @brief Decompress all chunks of chunked data in parallel
+    auto decodeChunked(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+}
@@ -0,0 +1,85 @@
+#include "hashchain.h"
+
+#include "exception.h"
+
+#include <algorithm>
+
+namespace Compression
+{
+
+    HashChain::HashChain(const std::vector<uint8_t> &data, uint32_t minLength, uint32_t maxLength, uint32_t maxDistance, uint32_t minDistance, uint32_t maxChainDepth)
+        : m_data(data), m_minLength(minLength), m_maxLength(maxLength), m_maxDistance(maxDistance), m_minDistance(minDistance), m_maxChainDepth(maxChainDepth), m_head(1 << HashBits, -1), m_chain(data.size(), -1)
+    {
+        REQUIRE(m_minLength >= 3 && m_minLength <= 4, std::runtime_error, "Minimum match length must be in [3,4]");
+        REQUIRE(m_maxLength >= m_minLength, std::runtime_error, "Maximum match length must be >= minimum match length");
+        REQUIRE(m_minDistance >= 1 && m_minDistance <= m_maxDistance, std::runtime_error, "Match distance range invalid");
+        REQUIRE(m_maxChainDepth >= 1, std::runtime_error, "Chain depth must be >= 1");
+    }
+
+    auto HashChain::hash(uint32_t position) const -> uint32_t
+    {
+        // multiplicative hash of the first minLength bytes
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < m_minLength; ++i)
+        {
+            value |= static_cast<uint32_t>(m_data[position + i]) << (8 * i);
+        }
+        return (value * 2654435761U) >> (32 - HashBits);
+    }
+
+    auto HashChain::insert(uint32_t position) -> void
+    {
+        if (position + m_minLength <= m_data.size())
+        {
+            auto &head = m_head[hash(position)];
+            m_chain[position] = head;
+            head = static_cast<int32_t>(position);
+        }
+    }
+
+    auto HashChain::findMatch(uint32_t position, uint32_t maxLength) const -> Match
+    {
+        Match bestMatch;
+        const uint32_t bytesLeft = position < m_data.size() ? static_cast<uint32_t>(m_data.size()) - position : 0;
+        maxLength = std::min({maxLength, m_maxLength, bytesLeft});
+        if (maxLength < m_minLength)
+        {
+            return bestMatch;
+        }
+        const auto current = m_data.data() + position;
+        // walk chain from the nearest to the farthest position
+        auto candidate = m_head[hash(position)];
+        for (uint32_t depth = 0; candidate >= 0 && depth < m_maxChainDepth; ++depth, candidate = m_chain[candidate])
+        {
+            const uint32_t distance = position - static_cast<uint32_t>(candidate);
+            if (distance > m_maxDistance)
+            {
+                break;
+            }
+            if (distance < m_minDistance)
+            {
+                continue;
+            }
+            const auto previous = m_data.data() + candidate;
+            // the candidate can only be better if it matches the byte after the best match found so far
+            if (bestMatch.length > 0 && previous[bestMatch.length] != current[bestMatch.length])
+            {
+                continue;
+            }
+            uint32_t length = 0;
+            while (length < maxLength && previous[length] == current[length])
+            {
+                ++length;
+            }
+            if (length >= m_minLength && length > bestMatch.length)
+            {
+                bestMatch = {distance, length};
+                if (length >= maxLength)
+                {
+                    break;
+                }
+            }
+        }
+        return bestMatch;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Compression
+{
+    /// @brief Match finder for LZ-style compressors using a hash head table and a chain table.
+    /// The head table stores the last position for every hash of the first minLength bytes,
+    /// the chain table links every position to the previous position with the same hash.
+    /// Positions must be inserted in increasing order. Matches are only found in positions inserted before
+    class HashChain
+    {
+    public:
+        /// @brief Match found in data
+        struct Match
+        {
+            uint32_t distance = 0; // Distance of match start to current position. 0 if no match was found
+            uint32_t length = 0;   // Length of match in bytes. 0 if no match was found
+        };
+
+        /// @brief Construct match finder for data
+        /// @param data Input data. Must stay valid and unchanged while the match finder is used
+        /// @param minLength Minimum length of a match in [3,4]. This many bytes are hashed
+        /// @param maxLength Maximum length of a match
+        /// @param maxDistance Maximum distance of a match
+        /// @param minDistance Minimum distance of a match, e.g. 2 for VRAM-compatible data
+        /// @param maxChainDepth Maximum number of positions to check per match search. Higher values find better matches, but are slower
+        HashChain(const std::vector<uint8_t> &data, uint32_t minLength, uint32_t maxLength, uint32_t maxDistance, uint32_t minDistance, uint32_t maxChainDepth);
+
+        /// @brief Insert position into hash table. Positions with less than minLength bytes left are ignored
+        auto insert(uint32_t position) -> void;
+
+        /// @brief Find the longest match for the data at position in all positions inserted before.
+        /// Of matches with the same length the one with the smallest distance is returned
+        /// @param position Position to find match for
+        /// @param maxLength Maximum match length allowed. Will be clamped to the maximum match length and the data left
+        /// @return Longest match found or {0, 0} if no match with at least minLength bytes exists
+        auto findMatch(uint32_t position, uint32_t maxLength) const -> Match;
+
+    private:
+        static constexpr uint32_t HashBits = 16;
+
+        auto hash(uint32_t position) const -> uint32_t;
+
+        const std::vector<uint8_t> &m_data;
+        const uint32_t m_minLength;
+        const uint32_t m_maxLength;
+        const uint32_t m_maxDistance;
+        const uint32_t m_minDistance;
+        const uint32_t m_maxChainDepth;
+        std::vector<int32_t> m_head;  // Last position inserted for hash value or -1
+        std::vector<int32_t> m_chain; // Previous position with the same hash value or -1
+    };
+}
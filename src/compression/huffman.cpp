@@ -0,0 +1,291 @@
+#include "huffman.h"
+
+#include "exception.h"
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+
+namespace Compression
+{
+
+    /// @brief Node in a Huffman tree
+    struct HuffmanNode
+    {
+        uint32_t count = 0;             // Number of occurrences of symbol or sum of child counts
+        int32_t children[2] = {-1, -1}; // Indices of child nodes or -1 for leaf nodes
+        uint8_t symbol = 0;             // Symbol for leaf nodes
+        uint32_t nrOfInternalNodes = 0; // Number of internal nodes in subtree including this node
+
+        auto isLeaf() const -> bool
+        {
+            return children[0] < 0;
+        }
+    };
+
+    /// @brief Build Huffman tree from symbol counts. There are always >= 2 leaf nodes, so the root is an internal node
+    /// @return Tree nodes. The root node is the last node
+    static auto buildTree(const std::vector<uint32_t> &counts) -> std::vector<HuffmanNode>
+    {
+        std::vector<HuffmanNode> nodes;
+        for (uint32_t symbol = 0; symbol < counts.size(); ++symbol)
+        {
+            if (counts[symbol] > 0)
+            {
+                HuffmanNode leaf;
+                leaf.count = counts[symbol];
+                leaf.symbol = static_cast<uint8_t>(symbol);
+                nodes.push_back(leaf);
+            }
+        }
+        // the tree needs an internal root node, so add an unused symbol if there is only one
+        if (nodes.size() == 1)
+        {
+            HuffmanNode leaf;
+            leaf.symbol = nodes.front().symbol ^ 1;
+            nodes.push_back(leaf);
+        }
+        // combine the two nodes with the smallest counts until only the root is left. ties go to the older node for deterministic trees
+        auto greater = [&nodes](int32_t a, int32_t b)
+        {
+            return nodes[a].count != nodes[b].count ? nodes[a].count > nodes[b].count : a > b;
+        };
+        std::priority_queue<int32_t, std::vector<int32_t>, decltype(greater)> queue(greater);
+        for (int32_t i = 0; i < static_cast<int32_t>(nodes.size()); ++i)
+        {
+            queue.push(i);
+        }
+        while (queue.size() > 1)
+        {
+            const auto child0 = queue.top();
+            queue.pop();
+            const auto child1 = queue.top();
+            queue.pop();
+            HuffmanNode node;
+            node.count = nodes[child0].count + nodes[child1].count;
+            node.children[0] = child0;
+            node.children[1] = child1;
+            node.nrOfInternalNodes = 1 + nodes[child0].nrOfInternalNodes + nodes[child1].nrOfInternalNodes;
+            nodes.push_back(node);
+            queue.push(static_cast<int32_t>(nodes.size()) - 1);
+        }
+        return nodes;
+    }
+
+    /// @brief Store tree in BIOS format. Every internal node stores its children as a pair of nodes
+    /// at most HUFFMAN_MAX_NODE_OFFSET pairs after its own pair, so the order pairs are stored in matters.
+    /// Children of the internal node with the smallest subtree are stored first, which keeps the number of
+    /// nodes waiting for their children small, unless a node waiting would run out of offset range
+    /// @return Tree table including the tree size byte, padded to a multiple of 4 bytes or std::nullopt if a node offset does not fit
+    static auto storeTree(const std::vector<HuffmanNode> &nodes) -> std::optional<std::vector<uint8_t>>
+    {
+        struct Pending
+        {
+            int32_t node;      // Index of internal node waiting for its children to be stored
+            uint32_t position; // Position of node in table
+        };
+        // the tree size byte and the root node form the first pair
+        std::vector<uint8_t> table(2, 0);
+        std::vector<Pending> pending = {{static_cast<int32_t>(nodes.size()) - 1, 1}};
+        while (!pending.empty())
+        {
+            const uint32_t pairIndex = static_cast<uint32_t>(table.size() / 2);
+            // check if the node with the smallest offset range left must be stored now
+            std::sort(pending.begin(), pending.end(), [](const auto &a, const auto &b)
+                      { return a.position < b.position; });
+            bool mustStoreFirst = false;
+            for (uint32_t i = 0; i < pending.size(); ++i)
+            {
+                const uint32_t lastPairIndex = pending[i].position / 2 + 1 + HUFFMAN_MAX_NODE_OFFSET;
+                if (lastPairIndex < pairIndex + i)
+                {
+                    return std::nullopt;
+                }
+                mustStoreFirst = mustStoreFirst || lastPairIndex == pairIndex + i;
+            }
+            // else store the children of the node with the smallest subtree
+            auto pIt = pending.begin();
+            if (!mustStoreFirst)
+            {
+                pIt = std::min_element(pending.begin(), pending.end(), [&nodes](const auto &a, const auto &b)
+                                       { return nodes[a.node].nrOfInternalNodes < nodes[b.node].nrOfInternalNodes; });
+            }
+            const auto current = *pIt;
+            pending.erase(pIt);
+            // store offset to children in node and children in new pair
+            const auto &node = nodes[current.node];
+            uint8_t value = static_cast<uint8_t>(pairIndex - current.position / 2 - 1);
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                const auto &child = nodes[node.children[i]];
+                if (child.isLeaf())
+                {
+                    value |= (i == 0 ? 0x80 : 0x40);
+                    table.push_back(child.symbol);
+                }
+                else
+                {
+                    pending.push_back({node.children[i], static_cast<uint32_t>(table.size())});
+                    table.push_back(0);
+                }
+            }
+            table[current.position] = value;
+        }
+        // pad table, so the bit stream starts at a multiple of 4 bytes (the header has 4 bytes)
+        table.resize((table.size() + 3) & ~3U, 0);
+        table[0] = static_cast<uint8_t>(table.size() / 2 - 1);
+        return table;
+    }
+
+    /// @brief Get code bits for all symbols, first bit first
+    static auto buildCodes(const std::vector<HuffmanNode> &nodes, int32_t nodeIndex, std::vector<bool> &code, std::vector<std::vector<bool>> &codes) -> void
+    {
+        const auto &node = nodes[nodeIndex];
+        if (node.isLeaf())
+        {
+            codes[node.symbol] = code;
+            return;
+        }
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            code.push_back(i != 0);
+            buildCodes(nodes, node.children[i], code, codes);
+            code.pop_back();
+        }
+    }
+
+    auto encodeHuffman_20(const std::vector<uint8_t> &src, uint32_t bitsPerSymbol) -> std::vector<uint8_t>
+    {
+        REQUIRE(!src.empty(), std::runtime_error, "Data too small");
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data too big");
+        REQUIRE(bitsPerSymbol == 4 || bitsPerSymbol == 8, std::runtime_error, "Bits per symbol must be 4 or 8");
+        const auto srcSize = static_cast<uint32_t>(src.size());
+        // the BIOS writes 32-bit units, so we need symbols for padded data
+        auto data = src;
+        data.resize((data.size() + 3) & ~3U, 0);
+        std::vector<uint8_t> symbols;
+        if (bitsPerSymbol == 4)
+        {
+            symbols.reserve(data.size() * 2);
+            for (const auto d : data)
+            {
+                symbols.push_back(d & 0x0F);
+                symbols.push_back(d >> 4);
+            }
+        }
+        else
+        {
+            symbols = std::move(data);
+        }
+        // build tree and codes from symbol counts
+        std::vector<uint32_t> counts(1 << bitsPerSymbol, 0);
+        for (const auto s : symbols)
+        {
+            ++counts[s];
+        }
+        auto nodes = buildTree(counts);
+        auto table = storeTree(nodes);
+        // if the node offsets do not fit into 6 bits, halve the symbol counts to get a flatter, shallower tree and try again.
+        // counts stay >= 1, so all symbols keep a code. At worst all counts end up equal, which gives a balanced tree.
+        // storeTree() needs offsets of at most 36 pairs for a balanced tree of 256 symbols, so that tree always fits
+        while (!table)
+        {
+            REQUIRE(std::any_of(counts.cbegin(), counts.cend(), [](auto c)
+                                { return c > 1; }),
+                    std::runtime_error, "Failed to store Huffman tree");
+            std::transform(counts.cbegin(), counts.cend(), counts.begin(), [](auto c)
+                           { return (c + 1) / 2; });
+            nodes = buildTree(counts);
+            table = storeTree(nodes);
+        }
+        std::vector<std::vector<bool>> codes(1 << bitsPerSymbol);
+        std::vector<bool> code;
+        buildCodes(nodes, static_cast<int32_t>(nodes.size()) - 1, code, codes);
+        // store uncompressed size, Huffman marker and bits per symbol at start of destination, followed by the tree
+        std::vector<uint8_t> dst(4, 0);
+        *reinterpret_cast<uint32_t *>(dst.data()) = (srcSize << 8) | HUFFMAN_TYPE_MARKER | bitsPerSymbol;
+        dst.insert(dst.end(), table->cbegin(), table->cend());
+        // store bit stream in 32-bit units, first bit in bit 31
+        uint32_t bits = 0;
+        uint32_t nrOfBits = 0;
+        auto storeBits = [&dst](uint32_t value)
+        {
+            dst.push_back(value & 0xFF);
+            dst.push_back((value >> 8) & 0xFF);
+            dst.push_back((value >> 16) & 0xFF);
+            dst.push_back(value >> 24);
+        };
+        for (const auto s : symbols)
+        {
+            for (const auto bit : codes[s])
+            {
+                bits = (bits << 1) | (bit ? 1 : 0);
+                if (++nrOfBits == 32)
+                {
+                    storeBits(bits);
+                    bits = 0;
+                    nrOfBits = 0;
+                }
+            }
+        }
+        if (nrOfBits > 0)
+        {
+            storeBits(bits << (32 - nrOfBits));
+        }
+        return dst;
+    }
+
+    auto decodeHuffman_20(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    {
+        REQUIRE(src.size() > 8, std::runtime_error, "Data too small");
+        const uint32_t header = *reinterpret_cast<const uint32_t *>(src.data());
+        REQUIRE((header & 0xF0) == HUFFMAN_TYPE_MARKER, std::runtime_error, "Compression type not Huffman (" << uint32_t(HUFFMAN_TYPE_MARKER) << ")");
+        const uint32_t bitsPerSymbol = header & 0x0F;
+        REQUIRE(bitsPerSymbol == 4 || bitsPerSymbol == 8, std::runtime_error, "Bits per symbol must be 4 or 8");
+        const uint32_t uncompressedSize = header >> 8;
+        REQUIRE(uncompressedSize > 0, std::runtime_error, "Bad uncompressed size");
+        // tree starts after header, bit stream after tree
+        constexpr uint32_t TreeStart = 4;
+        constexpr uint32_t RootPosition = TreeStart + 1;
+        const uint32_t bitStreamStart = TreeStart + (static_cast<uint32_t>(src[TreeStart]) + 1) * 2;
+        REQUIRE(bitStreamStart <= src.size(), std::runtime_error, "Tree size out of range");
+        // decode symbols until we have decoded padded data, like the BIOS
+        const uint32_t paddedSize = (uncompressedSize + 3) & ~3U;
+        std::vector<uint8_t> dst;
+        dst.reserve(paddedSize);
+        uint8_t value = 0;
+        uint32_t nrOfSymbolBits = 0;
+        uint32_t nodePosition = RootPosition;
+        for (uint32_t srcPosition = bitStreamStart; dst.size() < paddedSize; srcPosition += 4)
+        {
+            REQUIRE(srcPosition + 4 <= src.size(), std::runtime_error, "Bit stream too short");
+            const uint32_t bits = *reinterpret_cast<const uint32_t *>(src.data() + srcPosition);
+            for (int32_t bitIndex = 31; bitIndex >= 0 && dst.size() < paddedSize; --bitIndex)
+            {
+                const uint32_t bit = (bits >> bitIndex) & 1;
+                const uint8_t node = src[nodePosition];
+                const uint32_t childPosition = (nodePosition & ~1U) + (node & 0x3F) * 2 + 2 + bit;
+                REQUIRE(childPosition < bitStreamStart, std::runtime_error, "Tree node offset out of range");
+                if (node & (bit ? 0x40 : 0x80))
+                {
+                    // child is a leaf. store symbol and start over at root
+                    value |= src[childPosition] << nrOfSymbolBits;
+                    nrOfSymbolBits += bitsPerSymbol;
+                    if (nrOfSymbolBits == 8)
+                    {
+                        dst.push_back(value);
+                        value = 0;
+                        nrOfSymbolBits = 0;
+                    }
+                    nodePosition = RootPosition;
+                }
+                else
+                {
+                    nodePosition = childPosition;
+                }
+            }
+        }
+        dst.resize(uncompressedSize);
+        return dst;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Compression
+{
+
+    constexpr uint8_t HUFFMAN_TYPE_MARKER = 0x20;    // Used to detect Huffman compression in data. The lower 4 bits store the bits per symbol
+    constexpr uint32_t HUFFMAN_MAX_NODE_OFFSET = 63; // We have max. 6 bits to encode the offset to the child nodes
+
+    /// @brief Compress input data using Huffman variant 20h
+    /// Compatible with : https://problemkaputt.de/gbatek.htm#biosdecompressionfunctions
+    /// The tree is stored so all child node offsets fit into 6 bits
+    /// @param bitsPerSymbol Size of Huffman symbols in bits. Must be 4 or 8. 4-bit symbols are read from the low nibble of a byte first
+    /// @note The BIOS writes 32-bit units, so input data is padded with 0s to a multiple of 4 bytes for encoding
+    auto encodeHuffman_20(const std::vector<uint8_t> &data, uint32_t bitsPerSymbol = 8) -> std::vector<uint8_t>;
+
+    /// @brief Decompress input data using Huffman variant 20h
+    auto decodeHuffman_20(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+}
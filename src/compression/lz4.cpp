@@ -1,9 +1,11 @@
 #include "lz4.h"
 
 #include "exception.h"
+#include "hashchain.h"
 #include "if/lz4_constants.h"
 
-#include <map>
+#include <algorithm>
+#include <cstring>
 
 // #define DEBUG_TOKENS
 #ifdef DEBUG_TOKENS
@@ -15,109 +17,23 @@
 namespace Compression
 {
 
-    struct MatchInfo
-    {
-        int32_t distance = 0;
-        int32_t length = 0;
-    };
-
-    auto findBestMatch(const std::vector<uint8_t> &src, const std::multimap<uint32_t, int32_t> &hashPositions, const int32_t srcPosition, const bool vramCompatible) -> MatchInfo
-    {
-        MatchInfo bestMatch = {0, 0};
-        // get hash from srcPosition + MinLength
-        const uint32_t srcPositionHash = *reinterpret_cast<const uint32_t *>(src.data() + srcPosition);
-        // find all possible matches from hash table and exit if we have none
-        const auto possibleMatches = hashPositions.equal_range(srcPositionHash);
-        if (possibleMatches.first == hashPositions.cend())
-        {
-            return bestMatch;
-        }
-        // now find actual matches
-        const int32_t MaxMatchLength = srcPosition + Lz4Constants::MAX_MATCH_LENGTH >= src.size() ? src.size() - srcPosition - 1 : Lz4Constants::MAX_MATCH_LENGTH;
-        auto possibleMatchIt = possibleMatches.first;
-        while (possibleMatchIt != possibleMatches.second)
-        {
-            // get position of possible match found in src and make sure it is towards front of buffer
-            const auto matchStartPosition = possibleMatchIt->second;
-            // calculate match distance and make sure it stays below the max. allowed distance
-            const int32_t distance = srcPosition - matchStartPosition;
-            // if we want to be VRAM-compatible, skip matches with a distance of 1
-            if (vramCompatible && (distance == 1))
-            {
-                continue;
-            }
-            if (matchStartPosition < srcPosition && distance <= Lz4Constants::MAX_MATCH_DISTANCE)
-            {
-                // if we currently have no best match, store this one
-                if (bestMatch.distance == 0 && bestMatch.length == 0)
-                {
-                    bestMatch = {distance, Lz4Constants::MIN_MATCH_LENGTH};
-                }
-                // we already know the match length is >= Lz4Constants::MIN_MATCH_LENGTH, so start with Lz4Constants::MIN_MATCH_LENGTH + 1
-                for (int32_t matchLength = (Lz4Constants::MIN_MATCH_LENGTH + 1); matchLength <= MaxMatchLength; ++matchLength)
-                {
-                    // make sure we have enough bytes for a match of matchLength
-                    if ((matchStartPosition + matchLength) >= src.size())
-                    {
-                        // we can't get better as don't have more bytes (should never happen)
-                        return bestMatch;
-                    }
-                    // match byte at match position toward end of buffer and break if it does not match anymore
-                    if (src[matchStartPosition + matchLength - 1] != src[srcPosition + matchLength - 1])
-                    {
-                        break;
-                    }
-                    // check if we've found a better match
-                    if (matchLength > bestMatch.length)
-                    {
-                        bestMatch.distance = distance;
-                        bestMatch.length = matchLength;
-                        // check if we could improve or can return now
-                        if (matchLength >= Lz4Constants::MAX_MATCH_LENGTH)
-                        {
-                            return bestMatch;
-                        }
-                    }
-                }
-            }
-            ++possibleMatchIt;
-        }
-        return bestMatch;
-    }
-
-    auto extraLengthBytesNeeded(int32_t length) -> uint32_t
-    {
-        uint32_t extraBytesNeeded = 0;
-        // 15 marks the start of a new byte
-        length -= 15;
-        while (length >= 0)
-        {
-            length -= 255;
-            extraBytesNeeded++;
-        }
-        return extraBytesNeeded;
-    }
-
-    struct TokenInfo
-    {
-        std::vector<uint8_t> literals;
-        uint32_t matchLength = 0;
-        uint32_t matchOffset = 0;
-    };
-
-    auto flushToken(std::vector<uint8_t> &dst, const TokenInfo &token) -> void
+    /// @brief Write a token with literals and a match to dst
+    /// @param literals Pointer to literal bytes
+    /// @param literalLength Number of literal bytes. Can be 0
+    /// @param match Match following the literals. Length can be 0 for the last token in the stream
+    auto writeToken(std::vector<uint8_t> &dst, const uint8_t *literals, uint32_t literalLength, const HashChain::Match &match) -> void
     {
         uint8_t tokenByte = 0;
         const auto tokenOffset = dst.size();
         dst.push_back(0);
         // check if our token has literal bytes
-        if (!token.literals.empty())
+        if (literalLength > 0)
         {
             // store literal length
-            int32_t storedLiteralLength = token.literals.size();
+            int32_t storedLiteralLength = literalLength;
 #ifdef DEBUG_TOKENS
-            std::cout << "L(" << storedLiteralLength << "): \"" << std::string(reinterpret_cast<const char *>(token.literals.data()), token.literals.size()) << "\"";
-            if (token.matchLength > 0)
+            std::cout << "L(" << storedLiteralLength << "): \"" << std::string(reinterpret_cast<const char *>(literals), literalLength) << "\"";
+            if (match.length > 0)
             {
                 std::cout << ", ";
             }
@@ -143,21 +59,21 @@ namespace Compression
                 }
             }
             // store literals
-            std::copy(token.literals.cbegin(), token.literals.cend(), std::back_inserter(dst));
+            dst.insert(dst.end(), literals, literals + literalLength);
         }
         // check if if token has match
-        if (token.matchLength > 0)
+        if (match.length > 0)
         {
 #ifdef DEBUG_TOKENS
-            std::cout << "M(" << token.matchOffset << "," << token.matchLength << ")" << std::endl;
+            std::cout << "M(" << match.distance << "," << match.length << ")" << std::endl;
 #endif
             // store match offset
-            REQUIRE(token.matchOffset > 0 && token.matchOffset <= Lz4Constants::MAX_MATCH_DISTANCE, std::runtime_error, "Match offset out of range [1,65535]");
-            dst.push_back((token.matchOffset >> 8) & 0xFF);
-            dst.push_back(token.matchOffset & 0xFF);
-            // store literal length
-            REQUIRE(token.matchLength >= Lz4Constants::MIN_MATCH_LENGTH, std::runtime_error, "Match length too small");
-            int32_t storedMatchLength = token.matchLength - (Lz4Constants::MIN_MATCH_LENGTH - 1);
+            REQUIRE(match.distance > 0 && match.distance <= Lz4Constants::MAX_MATCH_DISTANCE, std::runtime_error, "Match offset out of range [1,65535]");
+            dst.push_back((match.distance >> 8) & 0xFF);
+            dst.push_back(match.distance & 0xFF);
+            // store match length
+            REQUIRE(match.length >= Lz4Constants::MIN_MATCH_LENGTH, std::runtime_error, "Match length too small");
+            int32_t storedMatchLength = match.length - (Lz4Constants::MIN_MATCH_LENGTH - 1);
             if (storedMatchLength < 15)
             {
                 // store match length only in token byte
@@ -178,119 +94,157 @@ namespace Compression
         dst[tokenOffset] = tokenByte;
     }
 
-    auto encodeLZ4_40(const std::vector<uint8_t> &src, bool vramCompatible) -> std::vector<uint8_t>
+    /// @brief Parse input using lazy matching: a match is only taken if the match at the next byte is not longer
+    /// @param srcStart Position in src to start parsing at. Data before is only used as dictionary
+    template <typename FindMatch, typename InsertUpTo>
+    auto parseLazy(std::vector<uint8_t> &dst, const std::vector<uint8_t> &src, uint32_t srcStart, FindMatch findMatch, InsertUpTo insertUpTo) -> void
     {
-        REQUIRE(!src.empty(), std::runtime_error, "Data too small");
-        REQUIRE(src.size() < 2 ^ 24, std::runtime_error, "Data too big");
-        const auto srcSize = src.size();
-        // store uncompressed size and LZ4 marker flag at start of destination
-        std::vector<uint8_t> dst(4, 0);
-        *reinterpret_cast<uint32_t *>(dst.data()) = (src.size() << 8) | Lz4Constants::TYPE_MARKER;
-        // build minmatch hash table for input data. it maps a hash (first Lz4Constants::MIN_MATCH_LENGTH bytes of data) to its position(s)
-        std::multimap<uint32_t, int32_t> hashPositions;
-        for (int32_t srcPosition = 0; srcPosition < static_cast<int32_t>(src.size() - Lz4Constants::MIN_MATCH_LENGTH); ++srcPosition)
-        {
-            const uint32_t hash = *reinterpret_cast<const uint32_t *>(src.data() + srcPosition);
-            hashPositions.insert({hash, srcPosition});
-        }
-        // build match information for every byte except the last 4
-        std::map<uint32_t, MatchInfo> matches;
-#pragma omp parallel for
-        for (int srcPosition = 0; srcPosition < static_cast<int>(src.size() - Lz4Constants::MIN_MATCH_LENGTH); ++srcPosition)
+        const auto srcSize = static_cast<uint32_t>(src.size());
+        uint32_t literalStart = srcStart;
+        uint32_t srcPosition = srcStart;
+        auto match = findMatch(srcPosition);
+        while (srcPosition < srcSize)
         {
-            auto match = findBestMatch(src, hashPositions, srcPosition, vramCompatible);
-            if (match.length >= Lz4Constants::MIN_MATCH_LENGTH)
-#pragma omp critical
+            insertUpTo(srcPosition + 1);
+            if (match.length == 0)
+            {
+                match = findMatch(++srcPosition);
+                continue;
+            }
+            const auto nextMatch = findMatch(srcPosition + 1);
+            if (nextMatch.length > match.length)
             {
-                matches[srcPosition] = match;
+                // store current byte as literal and use next match
+                match = nextMatch;
+                ++srcPosition;
+                continue;
             }
+            // store literals and match as token
+            writeToken(dst, src.data() + literalStart, srcPosition - literalStart, match);
+            srcPosition += match.length;
+            literalStart = srcPosition;
+            insertUpTo(srcPosition);
+            match = findMatch(srcPosition);
+        }
+        // store remaining literals
+        if (literalStart < srcSize)
+        {
+            writeToken(dst, src.data() + literalStart, srcSize - literalStart, HashChain::Match());
+        }
+    }
+
+    /// @brief Parse input by finding the match sequence with the smallest encoded size (shortest path).
+    /// All match distances cost the same, so the longest match at every position and all shorter lengths are enough to consider
+    /// @param srcStart Position in src to start parsing at. Data before is only used as dictionary
+    template <typename FindMatch, typename InsertUpTo>
+    auto parseOptimal(std::vector<uint8_t> &dst, const std::vector<uint8_t> &src, uint32_t srcStart, FindMatch findMatch, InsertUpTo insertUpTo) -> void
+    {
+        const auto srcSize = static_cast<uint32_t>(src.size());
+        // find longest match for every position
+        std::vector<HashChain::Match> matches(srcSize);
+        for (uint32_t srcPosition = srcStart; srcPosition < srcSize; ++srcPosition)
+        {
+            matches[srcPosition] = findMatch(srcPosition);
+            insertUpTo(srcPosition + 1);
         }
-        // if we haven't found any matches, no need to check them
-        if (!matches.empty())
+        // price of a match in bytes: token, 2 bytes offset and extra length bytes
+        auto matchPrice = [](uint32_t matchLength) -> uint32_t
         {
-            // optimize match cost
-            std::vector<uint32_t> cost(src.size(), 0);
-            uint32_t currentCost = 0;
-            // iterate through the matches in reverse until the first match
-            auto prevMatch = matches.cend();
-            for (int32_t srcPosition = src.size() - 1; srcPosition > matches.cbegin()->first; --srcPosition)
+            const uint32_t storedMatchLength = matchLength - (Lz4Constants::MIN_MATCH_LENGTH - 1);
+            return 3 + (storedMatchLength < 15 ? 0 : 1 + (storedMatchLength - 15) / 255);
+        };
+        // find cheapest encoding of the rest of the data for every position by iterating through the data in reverse.
+        // literals cost 1 byte. Extra literal length bytes are rare and ignored
+        std::vector<uint32_t> price(srcSize + 1, 0);
+        for (int32_t srcPosition = srcSize - 1; srcPosition >= static_cast<int32_t>(srcStart); --srcPosition)
+        {
+            auto &match = matches[srcPosition];
+            auto bestPrice = 1 + price[srcPosition + 1];
+            uint32_t bestLength = 0;
+            for (uint32_t matchLength = match.length; matchLength >= Lz4Constants::MIN_MATCH_LENGTH; --matchLength)
             {
-                auto matchIt = matches.find(srcPosition);
-                if (matchIt != matches.cend())
-                {
-                    // here we are at a match. calculate cost
-                    // a match stores as one byte, plus two bytes offset, plus one byte for match length > 15, two over 270, ...
-                    auto bestLength = matchIt->second.length;
-                    auto currMatchLength = bestLength;
-                    auto bestCost = 3 + extraLengthBytesNeeded(currMatchLength - Lz4Constants::MIN_MATCH_LENGTH) + currentCost;
-                    while (currMatchLength >= Lz4Constants::MIN_MATCH_LENGTH)
-                    {
-                        // cost of this match is the cost of the match plus the cost of the rest of the new encoding
-                        // which is stored at cost[match_position + match_length]
-                        const auto matchCost = 3 + extraLengthBytesNeeded(currMatchLength - Lz4Constants::MIN_MATCH_LENGTH) + cost[srcPosition + currMatchLength];
-                        if (bestCost > matchCost)
-                        {
-                            bestCost = matchCost;
-                            bestLength = currMatchLength;
-                            matchIt->second.length = currMatchLength;
-                        }
-                        --currMatchLength;
-                    }
-                    // we need to find the length of the current literal run to determine how many length bytes we need
-                    // a literal stores a one byte, plus one byte for literal length > 15, two over 270, ...
-                    const uint32_t extraLiteralCost = matchIt != matches.cend() ? extraLengthBytesNeeded(matchIt->first - srcPosition - 1) : 0;
-                    const auto literalCost = 1 + extraLiteralCost + cost[srcPosition + 1];
-                    // check if storing literals is cheaper than the best current match
-                    if (literalCost < bestCost)
-                    {
-                        bestCost = literalCost;
-                        bestLength = 1;
-                        // remove match from list. it is not needed anymore
-                        matches.erase(srcPosition);
-                    }
-                    else
-                    {
-                        // store current match
-                        prevMatch = matchIt;
-                    }
-                    // store current match cost
-                    cost[srcPosition] = bestCost;
-                    currentCost = bestCost;
-                }
-                else
+                const auto currentPrice = matchPrice(matchLength) + price[srcPosition + matchLength];
+                if (currentPrice < bestPrice || (currentPrice == bestPrice && bestLength == 0))
                 {
-                    // here we have a literal
-                    cost[srcPosition] = ++currentCost;
+                    bestPrice = currentPrice;
+                    bestLength = matchLength;
                 }
             }
+            match.length = bestLength;
+            price[srcPosition] = bestPrice;
         }
-        // compress source by iterating through matches
-        TokenInfo currentToken;
-        std::size_t srcPosition = 0;
-        while (srcPosition < src.size())
+        // store tokens along the cheapest path
+        uint32_t literalStart = srcStart;
+        uint32_t srcPosition = srcStart;
+        while (srcPosition < srcSize)
         {
-            // check if the current byte will be a match
-            if (auto matchIt = matches.find(srcPosition); matchIt != matches.cend())
+            if (const auto &match = matches[srcPosition]; match.length > 0)
             {
-                // store the match in the current (or new) token
-                currentToken.matchLength = matchIt->second.length;
-                currentToken.matchOffset = matchIt->second.distance;
-                // skip match length bytes in source
-                srcPosition += matchIt->second.length;
-                // flush the token
-                flushToken(dst, currentToken);
-                currentToken = TokenInfo();
+                writeToken(dst, src.data() + literalStart, srcPosition - literalStart, match);
+                srcPosition += match.length;
+                literalStart = srcPosition;
             }
             else
             {
-                // no matches found, store literal
-                currentToken.literals.push_back(src[srcPosition++]);
+                ++srcPosition;
             }
         }
-        // if we still have a token pending, flush it
-        if (!currentToken.literals.empty() || currentToken.matchLength > 0)
+        // store remaining literals
+        if (literalStart < srcSize)
         {
-            flushToken(dst, currentToken);
+            writeToken(dst, src.data() + literalStart, srcSize - literalStart, HashChain::Match());
+        }
+    }
+
+    auto encodeLZ4_40(const std::vector<uint8_t> &src, bool vramCompatible, bool optimalParse, uint32_t maxChainDepth) -> std::vector<uint8_t>
+    {
+        return encodeLZ4_40(src, {}, vramCompatible, optimalParse, maxChainDepth);
+    }
+
+    auto encodeLZ4_40(const std::vector<uint8_t> &src, const std::vector<uint8_t> &dictionary, bool vramCompatible, bool optimalParse, uint32_t maxChainDepth) -> std::vector<uint8_t>
+    {
+        REQUIRE(!src.empty(), std::runtime_error, "Data too small");
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data too big");
+        const auto srcSize = static_cast<uint32_t>(src.size());
+        // store uncompressed size and LZ4 marker flag at start of destination
+        std::vector<uint8_t> dst(4, 0);
+        *reinterpret_cast<uint32_t *>(dst.data()) = (srcSize << 8) | Lz4Constants::TYPE_MARKER;
+        dst.reserve(4 + srcSize + srcSize / 255 + 16);
+        // put the tail of the dictionary in front of the data, so matches can reach into it
+        const auto dictionarySize = static_cast<uint32_t>(std::min<std::size_t>(dictionary.size(), Lz4Constants::MAX_MATCH_DISTANCE));
+        std::vector<uint8_t> window;
+        if (dictionarySize > 0)
+        {
+            window.reserve(dictionarySize + srcSize);
+            window.insert(window.end(), std::prev(dictionary.cend(), dictionarySize), dictionary.cend());
+            window.insert(window.end(), src.cbegin(), src.cend());
+        }
+        const auto &data = dictionarySize > 0 ? window : src;
+        const auto dataSize = static_cast<uint32_t>(data.size());
+        // if we want to be VRAM-compatible, skip matches with a distance of 1
+        HashChain matchFinder(data, Lz4Constants::MIN_MATCH_LENGTH, Lz4Constants::MAX_MATCH_LENGTH, Lz4Constants::MAX_MATCH_DISTANCE, vramCompatible ? 2 : 1, maxChainDepth);
+        // matches may start before the last Lz4Constants::MIN_MATCH_LENGTH bytes and the last byte is always stored as a literal
+        auto findMatch = [&matchFinder, dataSize](uint32_t position) -> HashChain::Match
+        {
+            return position + Lz4Constants::MIN_MATCH_LENGTH < dataSize ? matchFinder.findMatch(position, dataSize - position - 1) : HashChain::Match();
+        };
+        // insert all positions before end into the hash chain
+        uint32_t insertPosition = 0;
+        auto insertUpTo = [&matchFinder, &insertPosition](uint32_t end)
+        {
+            for (; insertPosition < end; ++insertPosition)
+            {
+                matchFinder.insert(insertPosition);
+            }
+        };
+        insertUpTo(dictionarySize);
+        if (optimalParse)
+        {
+            parseOptimal(dst, data, dictionarySize, findMatch, insertUpTo);
+        }
+        else
+        {
+            parseLazy(dst, data, dictionarySize, findMatch, insertUpTo);
         }
         // resize to multiple of 4
         while ((dst.size() % 4) != 0)
@@ -298,21 +252,29 @@ namespace Compression
             dst.push_back(0);
         }
 #ifdef TEST_ROUNDTRIP
-        const auto result = decodeLZ4_40(dst, vramCompatible);
+        const auto result = decodeLZ4_40(dst, dictionary, vramCompatible);
         REQUIRE(src == result, std::runtime_error, "Compression roundtrip failed");
 #endif
         return dst;
     }
 
     auto decodeLZ4_40(const std::vector<uint8_t> &src, bool vramCompatible) -> std::vector<uint8_t>
+    {
+        return decodeLZ4_40(src, {}, vramCompatible);
+    }
+
+    auto decodeLZ4_40(const std::vector<uint8_t> &src, const std::vector<uint8_t> &dictionary, bool vramCompatible) -> std::vector<uint8_t>
     {
         REQUIRE(src.size() > 4, std::runtime_error, "Data too small");
         uint32_t header = *reinterpret_cast<const uint32_t *>(src.data());
         REQUIRE((header & 0xFF) == Lz4Constants::TYPE_MARKER, std::runtime_error, "Compression type not LZ4 (" << uint32_t(Lz4Constants::TYPE_MARKER) << ")");
-        const uint32_t uncompressedSize = (header >> 8);
-        REQUIRE(uncompressedSize > 0, std::runtime_error, "Bad uncompressed size");
+        // decode behind the tail of the dictionary, so matches can reach into it
+        const auto dictionarySize = static_cast<uint32_t>(std::min<std::size_t>(dictionary.size(), Lz4Constants::MAX_MATCH_DISTANCE));
+        const uint32_t uncompressedSize = dictionarySize + (header >> 8);
+        REQUIRE(uncompressedSize > dictionarySize, std::runtime_error, "Bad uncompressed size");
         std::vector<uint8_t> dst;
         dst.reserve(uncompressedSize);
+        dst.insert(dst.end(), std::prev(dictionary.cend(), dictionarySize), dictionary.cend());
         // skip header in source data
         auto srcIt = std::next(src.cbegin(), 4);
         // decompress data
@@ -392,6 +354,113 @@ namespace Compression
                 }
             }
         }
+        // remove dictionary from output
+        dst.erase(dst.begin(), std::next(dst.begin(), dictionarySize));
         return dst;
     }
+
+    /// @brief Read extra literal or match length bytes following a token
+    static inline auto readExtraLength(const uint8_t *&src, const uint8_t *srcEnd) -> std::size_t
+    {
+        std::size_t length = 0;
+        uint8_t extraLength = 0;
+        do
+        {
+            REQUIRE(src < srcEnd, std::runtime_error, "Length past end of data");
+            extraLength = *src++;
+            length += extraLength;
+        } while (extraLength == 255);
+        return length;
+    }
+
+    /// @brief Copy data in 8 byte chunks. Might read and write up to 7 bytes more than size
+    static inline auto wildCopy(uint8_t *dst, const uint8_t *src, std::size_t size) -> void
+    {
+        const auto dstEnd = dst + size;
+        do
+        {
+            std::memcpy(dst, src, 8);
+            dst += 8;
+            src += 8;
+        } while (dst < dstEnd);
+    }
+
+    auto decodeLZ4_40(const uint8_t *data, std::size_t dataSize, uint8_t *dst, std::size_t dstSize, std::size_t dictionarySize) -> std::size_t
+    {
+        REQUIRE(data != nullptr && dataSize > 4, std::runtime_error, "Data too small");
+        REQUIRE(dst != nullptr, std::runtime_error, "Destination can not be nullptr");
+        uint32_t header = 0;
+        std::memcpy(&header, data, sizeof(header));
+        REQUIRE((header & 0xFF) == Lz4Constants::TYPE_MARKER, std::runtime_error, "Compression type not LZ4 (" << uint32_t(Lz4Constants::TYPE_MARKER) << ")");
+        const std::size_t uncompressedSize = header >> 8;
+        REQUIRE(uncompressedSize > 0, std::runtime_error, "Bad uncompressed size");
+        REQUIRE(uncompressedSize <= dstSize, std::runtime_error, "Destination buffer too small");
+        // skip header in source data
+        auto srcPtr = data + 4;
+        const auto srcEnd = data + dataSize;
+        auto dstPtr = dst;
+        const auto dstEnd = dst + uncompressedSize;
+        const auto dstLimit = dst + dstSize;
+        const auto dictionaryStart = dst - std::min<std::size_t>(dictionarySize, Lz4Constants::MAX_MATCH_DISTANCE);
+        // decompress data
+        while (dstPtr < dstEnd)
+        {
+            // read token
+            REQUIRE(srcPtr < srcEnd, std::runtime_error, "Token past end of data");
+            const uint8_t token = *srcPtr++;
+            std::size_t literalLength = (token >> Lz4Constants::LITERAL_LENGTH_SHIFT) & Lz4Constants::LENGTH_MASK;
+            std::size_t matchLength = token & Lz4Constants::LENGTH_MASK;
+            if (literalLength > 0)
+            {
+                if (literalLength == 15)
+                {
+                    literalLength += readExtraLength(srcPtr, srcEnd);
+                }
+                REQUIRE(literalLength <= static_cast<std::size_t>(srcEnd - srcPtr), std::runtime_error, "Literals past end of data");
+                REQUIRE(literalLength <= static_cast<std::size_t>(dstEnd - dstPtr), std::runtime_error, "Literals past end of uncompressed data");
+                // copy in chunks if neither source nor destination can be overrun
+                if (literalLength + LZ4_WILDCOPY_PADDING <= static_cast<std::size_t>(srcEnd - srcPtr) && literalLength + LZ4_WILDCOPY_PADDING <= static_cast<std::size_t>(dstLimit - dstPtr))
+                {
+                    wildCopy(dstPtr, srcPtr, literalLength);
+                }
+                else
+                {
+                    std::memcpy(dstPtr, srcPtr, literalLength);
+                }
+                srcPtr += literalLength;
+                dstPtr += literalLength;
+            }
+            if (matchLength > 0)
+            {
+                // read match offset
+                REQUIRE(srcEnd - srcPtr >= 2, std::runtime_error, "Match offset past end of data");
+                const std::size_t matchOffset = (static_cast<std::size_t>(srcPtr[0]) << 8) | srcPtr[1];
+                srcPtr += 2;
+                REQUIRE(matchOffset > 0, std::runtime_error, "Zero match offset");
+                REQUIRE(matchOffset <= static_cast<std::size_t>(dstPtr - dictionaryStart), std::runtime_error, "Match offset past start of data");
+                if (matchLength == 15)
+                {
+                    matchLength += readExtraLength(srcPtr, srcEnd);
+                }
+                matchLength += (Lz4Constants::MIN_MATCH_LENGTH - 1);
+                REQUIRE(matchLength <= static_cast<std::size_t>(dstEnd - dstPtr), std::runtime_error, "Match past end of uncompressed data");
+                const uint8_t *matchPtr = dstPtr - matchOffset;
+                // with an offset >= 8 every chunk only reads bytes that have already been written
+                if (matchOffset >= 8 && matchLength + LZ4_WILDCOPY_PADDING <= static_cast<std::size_t>(dstLimit - dstPtr))
+                {
+                    wildCopy(dstPtr, matchPtr, matchLength);
+                }
+                else
+                {
+                    // overlapping copy
+                    for (std::size_t i = 0; i < matchLength; ++i)
+                    {
+                        dstPtr[i] = matchPtr[i];
+                    }
+                }
+                dstPtr += matchLength;
+            }
+        }
+        return uncompressedSize;
+    }
 }
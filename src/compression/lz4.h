@@ -1,15 +1,47 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace Compression
 {
+    /// @brief Default number of positions checked per match search when compressing LZ4
+    constexpr uint32_t LZ4_DEFAULT_CHAIN_DEPTH = 256;
+
+    /// @brief Number of bytes the fast LZ4 decoder may write past the end of the uncompressed data.
+    /// Destination buffers with this much extra room let the decoder copy literals and matches in 8 byte chunks
+    constexpr std::size_t LZ4_WILDCOPY_PADDING = 8;
+
     /// @brief Compress input data using LZ4 variant 40h
+    /// Matches are found using a hash chain and data is parsed using lazy matching or optimal parsing
+    /// @param vramCompatible If true no matches with distance 1 are used, so data can be decompressed to VRAM
+    /// @param optimalParse If true the sequence of literals and matches with the smallest encoded size is chosen. Slower, but compresses better
+    /// @param maxChainDepth Maximum number of positions checked per match search. Higher values compress better, but slower
     /// @note This is probably not 100% stream compatible with regular LZ4
-    auto encodeLZ4_40(const std::vector<uint8_t> &data, bool vramCompatible = false) -> std::vector<uint8_t>;
+    auto encodeLZ4_40(const std::vector<uint8_t> &data, bool vramCompatible = false, bool optimalParse = false, uint32_t maxChainDepth = LZ4_DEFAULT_CHAIN_DEPTH) -> std::vector<uint8_t>;
+
+    /// @brief Compress input data using LZ4 variant 40h with a preset dictionary.
+    /// Matches can reach back into the last 64kB of the dictionary, e.g. the previous frame's uncompressed data.
+    /// The stream format is the same, but the decoder needs the same dictionary to decompress the data
+    /// @param dictionary Data preceding the input data. Can be empty
+    auto encodeLZ4_40(const std::vector<uint8_t> &data, const std::vector<uint8_t> &dictionary, bool vramCompatible = false, bool optimalParse = false, uint32_t maxChainDepth = LZ4_DEFAULT_CHAIN_DEPTH) -> std::vector<uint8_t>;
 
     /// @brief Decompress input data using LZ4 variant 40h
     auto decodeLZ4_40(const std::vector<uint8_t> &data, bool vramCompatible = false) -> std::vector<uint8_t>;
+
+    /// @brief Decompress input data using LZ4 variant 40h with a preset dictionary
+    /// @param dictionary Dictionary used when compressing the data. Can be empty
+    auto decodeLZ4_40(const std::vector<uint8_t> &data, const std::vector<uint8_t> &dictionary, bool vramCompatible = false) -> std::vector<uint8_t>;
+
+    /// @brief Decompress input data using LZ4 variant 40h directly into a caller-provided buffer. Does not allocate heap memory.
+    /// Literals and matches are copied in 8 byte chunks ("wildcopy") while the buffers have enough room left
+    /// @param data Compressed data
+    /// @param dataSize Size of compressed data in bytes
+    /// @param dst Destination buffer. Should have LZ4_WILDCOPY_PADDING bytes of room after the uncompressed data for best speed
+    /// @param dstSize Size of destination buffer in bytes. Must be >= uncompressed size
+    /// @param dictionarySize Number of bytes directly preceding dst that matches may reference, e.g. the tail of the previous frame
+    /// @return Uncompressed size in bytes
+    auto decodeLZ4_40(const uint8_t *data, std::size_t dataSize, uint8_t *dst, std::size_t dstSize, std::size_t dictionarySize = 0) -> std::size_t;
 }
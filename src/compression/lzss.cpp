@@ -1,137 +1,60 @@
 #include "lzss.h"
 
 #include "exception.h"
+#include "hashchain.h"
 
-#include <map>
+#include <cstring>
 
 namespace Compression
 {
 
-    struct MatchInfo
-    {
-        int32_t distance = 0;
-        int32_t length = 0;
-    };
-
-    template <int32_t MinLength, int32_t MaxLength>
-    auto findBestMatch(const std::vector<uint8_t> &src, const int32_t startPosition, const bool vramCompatible) -> MatchInfo
-    {
-        MatchInfo bestMatch = {0, 0};
-        for (int32_t matchLength = MinLength; matchLength <= MaxLength; ++matchLength)
-        {
-            // make sure we have enough bytes for a match of matchLength
-            if ((startPosition + matchLength) >= src.size())
-            {
-                // we can't get better as don't have more bytes
-                return bestMatch;
-            }
-            // start matching matchLength bytes backwards and move towards front of buffer
-            for (auto matchPosition = startPosition - matchLength; matchPosition >= 0; --matchPosition)
-            {
-                // calculate match distance and make sure it stays below the max. allowed distance
-                int32_t distance = startPosition - matchPosition;
-                if ((distance - 1) > LZSS_MAX_MATCH_DISTANCE)
-                {
-                    break;
-                }
-                // if we want to be VRAM-compatible, skip matches with a distance of 1
-                if (vramCompatible && (distance == 1))
-                {
-                    continue;
-                }
-                bool match = true;
-                for (int32_t i = 0; i < matchLength; ++i)
-                {
-                    if (src[matchPosition + i] != src[startPosition + i])
-                    {
-                        match = false;
-                        break;
-                    }
-                }
-                if (match)
-                {
-                    bestMatch = {distance, matchLength};
-                    break;
-                }
-            }
-        }
-        return bestMatch;
-    }
-
-    auto encodeLZSS_10(const std::vector<uint8_t> &src, bool vramCompatible) -> std::vector<uint8_t>
+    auto encodeLZSS_10(const std::vector<uint8_t> &src, bool vramCompatible, bool optimalParse, uint32_t maxChainDepth) -> std::vector<uint8_t>
     {
         REQUIRE(!src.empty(), std::runtime_error, "Data too small");
-        REQUIRE(src.size() < 2 ^ 24, std::runtime_error, "Data too big");
-        const auto srcSize = src.size();
+        REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data too big");
+        const auto srcSize = static_cast<uint32_t>(src.size());
         // store uncompressed size and LZ10 marker flag at start of destination
         std::vector<uint8_t> dst(4, 0);
-        *reinterpret_cast<uint32_t *>(dst.data()) = (src.size() << 8) | LZSS_TYPE_MARKER;
-        // build match information for every byte
-        std::map<uint32_t, MatchInfo> matches;
-#pragma omp parallel for
-        for (int srcPosition = 0; srcPosition < static_cast<int>(src.size()); ++srcPosition)
+        *reinterpret_cast<uint32_t *>(dst.data()) = (srcSize << 8) | LZSS_TYPE_MARKER;
+        dst.reserve(4 + srcSize + srcSize / 8 + 4);
+        // find longest match for every byte in one pass over the data. The last byte is always stored verbatim.
+        // if we want to be VRAM-compatible, skip matches with a distance of 1
+        HashChain matchFinder(src, LZSS_MIN_MATCH_LENGTH, LZSS_MAX_MATCH_LENGTH, LZSS_MAX_MATCH_DISTANCE + 1, vramCompatible ? 2 : 1, maxChainDepth);
+        std::vector<HashChain::Match> matches(srcSize);
+        for (uint32_t srcPosition = 0; srcPosition < srcSize; ++srcPosition)
         {
-            auto match = findBestMatch<LZSS_MIN_MATCH_LENGTH, LZSS_MAX_MATCH_LENGTH>(src, srcPosition, vramCompatible);
-            if (match.length >= LZSS_MIN_MATCH_LENGTH)
-#pragma omp critical
-            {
-                matches[srcPosition] = match;
-            }
+            matches[srcPosition] = matchFinder.findMatch(srcPosition, srcSize - srcPosition - 1);
+            matchFinder.insert(srcPosition);
         }
-        // if we haven't found any matches, no need to check them
-        if (!matches.empty())
+        // optimize match cost by iterating through the data in reverse.
+        // a match costs 2 bytes, a verbatim byte costs 1 byte. matches might be shortened if that is cheaper.
+        // when parsing optimally, costs are in bits and include the flag bit every match or verbatim byte needs
+        const uint32_t literalCost = optimalParse ? 9 : 1;
+        const uint32_t matchCost = optimalParse ? 17 : 2;
+        std::vector<uint32_t> cost(srcSize + 1, 0);
+        for (int32_t srcPosition = srcSize - 1; srcPosition >= 0; --srcPosition)
         {
-            // optimize match cost
-            std::vector<uint32_t> cost(src.size(), 0);
-            uint32_t currentCost = 0;
-            // iterate through the matches in reverse until the first match
-            for (uint32_t srcPosition = src.size() - 1; srcPosition > matches.cbegin()->first; --srcPosition)
+            auto &match = matches[srcPosition];
+            auto bestCost = literalCost + cost[srcPosition + 1];
+            uint32_t bestLength = 0;
+            for (uint32_t matchLength = match.length; matchLength >= LZSS_MIN_MATCH_LENGTH; --matchLength)
             {
-                auto matchIt = matches.find(srcPosition);
-                if (matchIt != matches.cend())
-                {
-                    // here we are at a match. calculate cost
-                    auto bestCost = 2 + currentCost;
-                    auto bestLength = matchIt->second.length;
-                    auto currMatchLength = bestLength;
-                    while (currMatchLength >= LZSS_MIN_MATCH_LENGTH)
-                    {
-                        // cost of this match is the cost of the match plus the cost of the rest of the new encoding
-                        // which is stored at cost[match_position + match_length]
-                        const auto matchCost = 2 + cost[srcPosition + currMatchLength];
-                        if (bestCost > matchCost)
-                        {
-                            bestCost = matchCost;
-                            bestLength = currMatchLength;
-                            matchIt->second.length = currMatchLength;
-                        }
-                        --currMatchLength;
-                    }
-                    // check if storing literals is cheaper than the best current match
-                    const auto literalCost = 1 + cost[srcPosition + 1];
-                    if (literalCost < bestCost)
-                    {
-                        bestCost = literalCost;
-                        bestLength = 1;
-                        // remove match from list. it is not needed anymore
-                        matches.erase(srcPosition);
-                    }
-                    // store current match cost
-                    cost[srcPosition] = bestCost;
-                    currentCost = bestCost;
-                }
-                else
+                // cost of this match is the cost of the match plus the cost of the rest of the encoding
+                const auto currentCost = matchCost + cost[srcPosition + matchLength];
+                if (currentCost <= bestCost && (bestLength == 0 || currentCost < bestCost))
                 {
-                    // here we have a literal
-                    cost[srcPosition] = ++currentCost;
+                    bestCost = currentCost;
+                    bestLength = matchLength;
                 }
             }
+            match.length = bestLength;
+            cost[srcPosition] = bestCost;
         }
         // compress source by iterating through matches
         std::size_t dstFlagPosition = 0;
         int32_t flagBitIndex = 7;
-        std::size_t srcPosition = 0;
-        while (srcPosition < src.size())
+        uint32_t srcPosition = 0;
+        while (srcPosition < srcSize)
         {
             if (flagBitIndex++ == 7)
             {
@@ -141,20 +64,20 @@ namespace Compression
                 flagBitIndex = 0;
             }
             // check if the current byte will be a match
-            if (auto matchIt = matches.find(srcPosition); matchIt != matches.cend())
+            if (const auto &match = matches[srcPosition]; match.length > 0)
             {
                 // yes. compress the match
-                auto storedMatchLength = matchIt->second.length - LZSS_MIN_MATCH_LENGTH;
-                REQUIRE(storedMatchLength >= 0 && storedMatchLength < 16, std::runtime_error, "Stored match length out of range [0,15]");
-                auto storedDistance = matchIt->second.distance - 1;
-                REQUIRE(storedDistance >= 0 && storedDistance <= LZSS_MAX_MATCH_DISTANCE, std::runtime_error, "Stored match distance out of range [0,0xFFF]");
+                auto storedMatchLength = match.length - LZSS_MIN_MATCH_LENGTH;
+                REQUIRE(storedMatchLength < 16, std::runtime_error, "Stored match length out of range [0,15]");
+                auto storedDistance = match.distance - 1;
+                REQUIRE(storedDistance <= LZSS_MAX_MATCH_DISTANCE, std::runtime_error, "Stored match distance out of range [0,0xFFF]");
                 // store 4 bits of match length and 12 bits of match distance
                 dst.push_back((storedMatchLength << 4) | (storedDistance >> 8));
                 dst.push_back(storedDistance & 0xFF);
                 // store "compressed" flag
                 dst[dstFlagPosition] |= (0x80 >> flagBitIndex);
                 // skip match length bytes in source
-                srcPosition += matchIt->second.length;
+                srcPosition += match.length;
             }
             else
             {
@@ -195,11 +118,15 @@ namespace Compression
                     uint32_t matchLenght = (*srcIt >> 4) + LZSS_MIN_MATCH_LENGTH;
                     uint32_t matchDistance = (*srcIt++ & 0xF) << 8;
                     matchDistance |= *srcIt++;
-                    auto copyStartIt = std::prev(dst.cend(), matchDistance + 1);
+                    REQUIRE(matchDistance < dst.size(), std::runtime_error, "Match distance past start of data");
                     // make sure to clamp copy size to not overrun buffer
                     auto copyLength = std::min(uncompressedSize - static_cast<uint32_t>(dst.size()), matchLenght);
-                    auto copyEndIt = std::next(copyStartIt, copyLength);
-                    std::copy(copyStartIt, copyEndIt, std::back_inserter(dst));
+                    // copy byte-wise, because matches can overlap the data being copied
+                    const auto copyStart = dst.size() - (matchDistance + 1);
+                    for (uint32_t i = 0; i < copyLength; ++i)
+                    {
+                        dst.push_back(dst[copyStart + i]);
+                    }
                 }
                 else
                 {
@@ -210,4 +137,63 @@ namespace Compression
         }
         return dst;
     }
+
+    auto decodeLZSS_10(const uint8_t *data, std::size_t dataSize, uint8_t *dst, std::size_t dstSize) -> std::size_t
+    {
+        REQUIRE(data != nullptr && dataSize > 4, std::runtime_error, "Data too small");
+        REQUIRE(dst != nullptr, std::runtime_error, "Destination can not be nullptr");
+        uint32_t header = 0;
+        std::memcpy(&header, data, sizeof(header));
+        REQUIRE((header & 0xFF) == LZSS_TYPE_MARKER, std::runtime_error, "Compression type not LZSS (" << uint32_t(LZSS_TYPE_MARKER) << ")");
+        const std::size_t uncompressedSize = (header >> 8);
+        REQUIRE(uncompressedSize > 0, std::runtime_error, "Bad uncompressed size");
+        REQUIRE(uncompressedSize <= dstSize, std::runtime_error, "Destination buffer too small");
+        // skip header in source data
+        auto srcPtr = data + 4;
+        const auto srcEnd = data + dataSize;
+        auto dstPtr = dst;
+        const auto dstEnd = dst + uncompressedSize;
+        // decompress data
+        while (dstPtr < dstEnd)
+        {
+            // read flags for next 8 tokens
+            REQUIRE(srcPtr < srcEnd, std::runtime_error, "Flags past end of data");
+            uint8_t flags = *srcPtr++;
+            for (int32_t flagBitIndex = 0; flagBitIndex < 8 && dstPtr < dstEnd; ++flagBitIndex, flags <<= 1)
+            {
+                // check if next token is match or verbatim byte
+                if ((flags & 0x80) != 0)
+                {
+                    REQUIRE(srcEnd - srcPtr >= 2, std::runtime_error, "Match past end of data");
+                    const std::size_t matchLength = (srcPtr[0] >> 4) + LZSS_MIN_MATCH_LENGTH;
+                    const std::size_t matchDistance = (((srcPtr[0] & 0xF) << 8) | srcPtr[1]) + 1;
+                    srcPtr += 2;
+                    REQUIRE(matchDistance <= static_cast<std::size_t>(dstPtr - dst), std::runtime_error, "Match distance past start of data");
+                    // make sure to clamp copy size to not overrun buffer
+                    const auto copyLength = std::min(static_cast<std::size_t>(dstEnd - dstPtr), matchLength);
+                    const uint8_t *matchPtr = dstPtr - matchDistance;
+                    if (matchDistance >= copyLength)
+                    {
+                        std::memcpy(dstPtr, matchPtr, copyLength);
+                    }
+                    else
+                    {
+                        // copy byte-wise, because the match overlaps the data being copied
+                        for (std::size_t i = 0; i < copyLength; ++i)
+                        {
+                            dstPtr[i] = matchPtr[i];
+                        }
+                    }
+                    dstPtr += copyLength;
+                }
+                else
+                {
+                    // store verbatim byte
+                    REQUIRE(srcPtr < srcEnd, std::runtime_error, "Literal past end of data");
+                    *dstPtr++ = *srcPtr++;
+                }
+            }
+        }
+        return uncompressedSize;
+    }
 }
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace Compression
@@ -12,10 +13,24 @@ namespace Compression
     constexpr uint32_t LZSS_MAX_MATCH_LENGTH = 18;      // We have max. 4 bits to encode match length [3,18]
     constexpr uint32_t LZSS_MAX_MATCH_DISTANCE = 0xFFF; // We have max. 12 bits to encode match distance
 
+    constexpr uint32_t LZSS_DEFAULT_CHAIN_DEPTH = 512;  // Default number of positions checked per match search
+
     /// @brief Compress input data using LZSS variant 10
     /// Compatible with : https://problemkaputt.de/gbatek.htm#biosdecompressionfunctions
-    auto encodeLZSS_10(const std::vector<uint8_t> &data, bool vramCompatible = false) -> std::vector<uint8_t>;
+    /// Matches are found using a hash chain
+    /// @param vramCompatible If true no matches with distance 1 are used, so data can be decompressed to VRAM
+    /// @param optimalParse If true the sequence of literals and matches with the smallest encoded size in bits is chosen
+    /// @param maxChainDepth Maximum number of positions checked per match search. Higher values compress better, but slower
+    auto encodeLZSS_10(const std::vector<uint8_t> &data, bool vramCompatible = false, bool optimalParse = false, uint32_t maxChainDepth = LZSS_DEFAULT_CHAIN_DEPTH) -> std::vector<uint8_t>;
 
     /// @brief Decompress input data using LZSS variant 10
     auto decodeLZSS_10(const std::vector<uint8_t> &data, bool vramCompatible = false) -> std::vector<uint8_t>;
+
+    /// @brief Decompress input data using LZSS variant 10 directly into a caller-provided buffer. Does not allocate heap memory
+    /// @param data Compressed data
+    /// @param dataSize Size of compressed data in bytes
+    /// @param dst Destination buffer
+    /// @param dstSize Size of destination buffer in bytes. Must be >= uncompressed size
+    /// @return Uncompressed size in bytes
+    auto decodeLZSS_10(const uint8_t *data, std::size_t dataSize, uint8_t *dst, std::size_t dstSize) -> std::size_t;
 }
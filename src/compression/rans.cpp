@@ -3,9 +3,11 @@
 #include "exception.h"
 #include "math/histogram.h"
 
-#include <map>
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
+#include <numeric>
 
 namespace Compression
 {
@@ -94,11 +96,327 @@ namespace Compression
         return counts;
     }
 
-    auto encodeRANS_50(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    /// @brief Adaptive order-0 model. Symbols are counted while coding and the rANS counts
+    /// are rebuilt from the frequencies every RANS_ADAPTIVE_BLOCK_SIZE symbols, so the encoder and decoder stay in sync
+    class AdaptiveModel
+    {
+    public:
+        /// @brief Construct model from frequencies. Uses a uniform model if frequencies are empty
+        explicit AdaptiveModel(const RansModel &frequencies)
+            : m_frequencies(frequencies.empty() ? RansModel(RANS_ALPHABET_SIZE, 0) : frequencies)
+        {
+            REQUIRE(m_frequencies.size() == RANS_ALPHABET_SIZE, std::runtime_error, "Model must have " << RANS_ALPHABET_SIZE << " frequencies");
+            rebuild();
+        }
+
+        auto start(uint8_t symbol) const -> uint32_t
+        {
+            return m_starts[symbol];
+        }
+
+        auto count(uint8_t symbol) const -> uint32_t
+        {
+            return m_starts[symbol + 1] - m_starts[symbol];
+        }
+
+        /// @brief Find symbol for rANS slot in [0, RANS_M)
+        auto symbol(uint32_t slot) const -> uint8_t
+        {
+            // start with the first symbol in the slot's bucket and search forward
+            uint32_t symbol = m_lookup[slot >> LookupShift];
+            while (m_starts[symbol + 1] <= slot)
+            {
+                ++symbol;
+            }
+            return static_cast<uint8_t>(symbol);
+        }
+
+        /// @brief Count symbol and rebuild counts at the end of a block
+        auto update(uint8_t symbol) -> void
+        {
+            m_frequencies[symbol]++;
+            if (++m_blockSize >= RANS_ADAPTIVE_BLOCK_SIZE)
+            {
+                rebuild();
+                m_blockSize = 0;
+            }
+        }
+
+        auto frequencies() const -> const RansModel &
+        {
+            return m_frequencies;
+        }
+
+    private:
+        /// @brief Halve frequencies if needed and calculate counts that sum up to RANS_M.
+        /// Every symbol gets a count of at least 1, because it might occur later
+        auto rebuild() -> void
+        {
+            uint32_t total = std::accumulate(m_frequencies.cbegin(), m_frequencies.cend(), uint32_t(0));
+            if (total > RANS_ADAPTIVE_MAX_TOTAL)
+            {
+                total = 0;
+                for (auto &f : m_frequencies)
+                {
+                    f >>= 1;
+                    total += f;
+                }
+            }
+            std::array<uint32_t, RANS_ALPHABET_SIZE> counts;
+            if (total == 0)
+            {
+                counts.fill(RANS_M / RANS_ALPHABET_SIZE);
+            }
+            else
+            {
+                // distribute counts proportionally to frequencies and give rest to most frequent symbol.
+                // scale using a 16.16 fixed-point factor to avoid a division per symbol
+                const uint64_t scale = (uint64_t(RANS_M - RANS_ALPHABET_SIZE) << 16) / total;
+                uint32_t totalM = 0;
+                for (uint32_t i = 0; i < RANS_ALPHABET_SIZE; ++i)
+                {
+                    counts[i] = 1 + static_cast<uint32_t>((m_frequencies[i] * scale) >> 16);
+                    totalM += counts[i];
+                }
+                const auto maxIndex = std::distance(m_frequencies.cbegin(), std::max_element(m_frequencies.cbegin(), m_frequencies.cend()));
+                counts[maxIndex] += RANS_M - totalM;
+            }
+            m_starts[0] = 0;
+            for (uint32_t i = 0; i < RANS_ALPHABET_SIZE; ++i)
+            {
+                m_starts[i + 1] = m_starts[i] + counts[i];
+            }
+            // store the symbol at the start of every bucket of slots
+            uint32_t symbol = 0;
+            for (uint32_t bucket = 0; bucket < m_lookup.size(); ++bucket)
+            {
+                while (m_starts[symbol + 1] <= (bucket << LookupShift))
+                {
+                    ++symbol;
+                }
+                m_lookup[bucket] = static_cast<uint8_t>(symbol);
+            }
+        }
+
+        static constexpr uint32_t LookupShift = RANS_M_BITS - 8;
+
+        RansModel m_frequencies;
+        std::array<uint32_t, RANS_ALPHABET_SIZE + 1> m_starts;
+        std::array<uint8_t, (RANS_M >> LookupShift)> m_lookup;
+        uint32_t m_blockSize = 0;
+    };
+
+    /// @brief Static model built from a count table stored in the header
+    class StaticModel
+    {
+    public:
+        template <typename CountType>
+        explicit StaticModel(const std::vector<CountType> &counts)
+            : m_symbols(RANS_M)
+        {
+            REQUIRE(counts.size() == RANS_ALPHABET_SIZE, std::runtime_error, "Model must have " << RANS_ALPHABET_SIZE << " counts");
+            // build starts and symbol table
+            m_starts[0] = 0;
+            for (uint32_t symbol = 0; symbol < RANS_ALPHABET_SIZE; ++symbol)
+            {
+                m_starts[symbol + 1] = m_starts[symbol] + counts[symbol];
+                REQUIRE(m_starts[symbol + 1] <= RANS_M, std::runtime_error, "Counts must sum up to RANS_M");
+                std::fill(std::next(m_symbols.begin(), m_starts[symbol]), std::next(m_symbols.begin(), m_starts[symbol + 1]), static_cast<uint8_t>(symbol));
+            }
+            REQUIRE(m_starts[RANS_ALPHABET_SIZE] == RANS_M, std::runtime_error, "Counts must sum up to RANS_M");
+        }
+
+        auto start(uint8_t symbol) const -> uint32_t
+        {
+            return m_starts[symbol];
+        }
+
+        auto count(uint8_t symbol) const -> uint32_t
+        {
+            return m_starts[symbol + 1] - m_starts[symbol];
+        }
+
+        auto symbol(uint32_t slot) const -> uint8_t
+        {
+            return m_symbols[slot];
+        }
+
+        auto update(uint8_t /*symbol*/) -> void
+        {
+        }
+
+    private:
+        std::array<uint32_t, RANS_ALPHABET_SIZE + 1> m_starts;
+        std::vector<uint8_t> m_symbols;
+    };
+
+    /// @brief rANS-encode symbols backwards and append initial states and compressed data to destination.
+    /// Symbol i is encoded with state i % nrOfStates. All states write to the same byte stream
+    /// @param startAndCount Function returning the symbol start and count for a symbol index
+    template <typename F>
+    static auto encodeSymbols(std::vector<uint8_t> &dst, std::size_t nrOfSymbols, uint32_t nrOfStates, F startAndCount) -> void
+    {
+        // reserve worst case size temporary vector (input size + small margin)
+        std::vector<uint8_t> temp;
+        temp.reserve(nrOfSymbols + 16);
+        // encode backwards
+        std::array<uint32_t, RANS_INTERLEAVED_STATES> states;
+        states.fill(RANS_L);
+        for (auto i = nrOfSymbols; i-- > 0;)
+        {
+            auto &x = states[i % nrOfStates];
+            const auto [start, count] = startAndCount(i);
+            REQUIRE(count > 0, std::runtime_error, "Zero-count symbol in encoder");
+            // renormalize: emit bytes while x >= x_max
+            const uint32_t x_max = ((RANS_L >> RANS_M_BITS) << 8) * count;
+            while (x >= x_max)
+            {
+                temp.push_back(static_cast<uint8_t>(x));
+                x >>= 8;
+            }
+            // Encode update
+            uint32_t q = x / count;
+            uint32_t r = x % count;
+            x = (q << RANS_M_BITS) + r + start;
+        }
+        for (uint32_t s = 0; s < nrOfStates; ++s)
+        {
+            // check how many bytes are needed for final state
+            const auto x_final = states[s];
+            uint32_t x = x_final;
+            uint32_t x_statebytes = 0;
+            while (x > 0)
+            {
+                x_statebytes++;
+                x >>= 8;
+            }
+            REQUIRE(x_statebytes <= 4, std::runtime_error, "State too large for 32-bit");
+            // flush final state with length prefix directly to destination
+            dst.push_back(static_cast<uint8_t>(x_statebytes));
+            for (int i = int(x_statebytes) - 1; i >= 0; --i)
+            {
+                dst.push_back(static_cast<uint8_t>(x_final >> (i * 8)));
+            }
+        }
+        // copy compressed data to end of destination in reverse
+        std::copy(temp.crbegin(), temp.crend(), std::back_inserter(dst));
+    }
+
+    /// @brief Read initial rANS states and decode symbols using NrOfStates interleaved states
+    template <uint32_t NrOfStates, typename Model>
+    static auto decodeSymbols(std::vector<uint8_t> &dst, uint32_t nrOfSymbols, std::vector<uint8_t>::const_iterator srcIt, std::vector<uint8_t>::const_iterator srcEnd, Model &model) -> void
+    {
+        static_assert(RANS_ADAPTIVE_BLOCK_SIZE % NrOfStates == 0, "Adaptive model must not change inside a group of interleaved symbols");
+        // read rANS state size byte and initial rANS state
+        std::array<uint32_t, NrOfStates> states;
+        for (auto &x : states)
+        {
+            REQUIRE(srcIt != srcEnd, std::runtime_error, "Missing rANS state size");
+            const uint8_t stateSize = *srcIt++;
+            REQUIRE(stateSize >= 0 && stateSize <= 4, std::runtime_error, "Bad state length");
+            REQUIRE(std::distance(srcIt, srcEnd) >= stateSize, std::runtime_error, "Missing rANS state data");
+            x = 0;
+            for (uint8_t i = 0; i < stateSize; ++i)
+            {
+                x = (x << 8) | *srcIt++;
+            }
+            REQUIRE(x >= RANS_M, std::runtime_error, "Initial rANS state too small");
+        }
+        dst.resize(nrOfSymbols);
+        auto dstIt = dst.begin();
+        // decode one symbol with each state. The symbols of a group do not depend on each other, so a CPU can overlap their decoding
+        auto decodeGroup = [&states, &model, &dstIt, &srcIt, &srcEnd](uint32_t groupSize)
+        {
+            std::array<uint8_t, NrOfStates> symbols;
+            for (uint32_t s = 0; s < groupSize; ++s)
+            {
+                auto &x = states[s];
+                const uint32_t x_tilde = x & (RANS_M - 1);
+                symbols[s] = model.symbol(x_tilde);
+                x = model.count(symbols[s]) * (x >> RANS_M_BITS) + (x_tilde - model.start(symbols[s]));
+            }
+            // renormalize states in encoding order and update model
+            for (uint32_t s = 0; s < groupSize; ++s)
+            {
+                auto &x = states[s];
+                if (std::distance(srcIt, srcEnd) >= 2)
+                {
+                    // a state needs at most 2 bytes to get back into [RANS_L, RANS_L << 8). Read them without branches
+                    const uint32_t nrOfBytes = (x < RANS_L ? 1 : 0) + (x < (RANS_L >> 8) ? 1 : 0);
+                    const uint32_t b0 = srcIt[0];
+                    const uint32_t b1 = srcIt[1];
+                    x = nrOfBytes == 0 ? x : (nrOfBytes == 1 ? ((x << 8) | b0) : ((x << 16) | (b0 << 8) | b1));
+                    srcIt += nrOfBytes;
+                }
+                else
+                {
+                    while (x < RANS_L)
+                    {
+                        REQUIRE(srcIt != srcEnd, std::runtime_error, "Unexpected end of compressed stream while renormalizing");
+                        x = (x << 8) | *srcIt++;
+                    }
+                }
+                *dstIt++ = symbols[s];
+                model.update(symbols[s]);
+            }
+        };
+        const uint32_t nrOfFullGroups = nrOfSymbols / NrOfStates;
+        for (uint32_t i = 0; i < nrOfFullGroups; ++i)
+        {
+            decodeGroup(NrOfStates);
+        }
+        decodeGroup(nrOfSymbols % NrOfStates);
+    }
+
+    /// @brief Encode data using a static frequency table stored in the header
+    static auto encodeStatic(std::vector<uint8_t> &dst, const std::vector<uint8_t> &src, const std::vector<uint32_t> &histogram, bool interleaved, RansModel &model) -> void
+    {
+#if RANS_M_BITS <= 8
+        auto counts = calculateCounts<uint8_t>(histogram);
+#else
+        auto counts = calculateCounts<uint16_t>(histogram);
+#endif
+        // store marker for 256-count header mode
+        dst.push_back(RANS_HEADER_MODE_256 | (interleaved ? RANS_HEADER_INTERLEAVED : 0));
+        // store frequency table in header
+        const auto countsSize8 = counts.size() * sizeof(decltype(counts.front()));
+        dst.resize(dst.size() + countsSize8);
+        std::memcpy(dst.data() + dst.size() - countsSize8, reinterpret_cast<const uint8_t *>(counts.data()), countsSize8);
+        const StaticModel staticModel(counts);
+        encodeSymbols(dst, src.size(), interleaved ? RANS_INTERLEAVED_STATES : 1, [&](std::size_t i)
+                      { return std::make_pair(staticModel.start(src[i]), staticModel.count(src[i])); });
+        // the static counts are the model for the next buffer
+        model.assign(counts.cbegin(), counts.cend());
+    }
+
+    /// @brief Encode data using the adaptive model. No frequency table is stored
+    static auto encodeAdaptive(std::vector<uint8_t> &dst, const std::vector<uint8_t> &src, bool usePreviousModel, bool interleaved, RansModel &model) -> void
+    {
+        dst.push_back(RANS_HEADER_MODE_ADAPTIVE | (usePreviousModel ? RANS_HEADER_ADAPTIVE_PREVIOUS : 0) | (interleaved ? RANS_HEADER_INTERLEAVED : 0));
+        // the model adapts while coding forward, but rANS encodes backwards, so record symbol starts and counts first
+        AdaptiveModel adaptiveModel(usePreviousModel ? model : RansModel());
+        std::vector<std::pair<uint32_t, uint32_t>> startsAndCounts(src.size());
+        for (std::size_t i = 0; i < src.size(); ++i)
+        {
+            startsAndCounts[i] = {adaptiveModel.start(src[i]), adaptiveModel.count(src[i])};
+            adaptiveModel.update(src[i]);
+        }
+        encodeSymbols(dst, src.size(), interleaved ? RANS_INTERLEAVED_STATES : 1, [&startsAndCounts](std::size_t i)
+                      { return startsAndCounts[i]; });
+        model = adaptiveModel.frequencies();
+    }
+
+    auto encodeRANS_50(const std::vector<uint8_t> &src, bool interleaved) -> std::vector<uint8_t>
+    {
+        RansModel model;
+        return encodeRANS_50(src, model, interleaved);
+    }
+
+    auto encodeRANS_50(const std::vector<uint8_t> &src, RansModel &model, bool interleaved, bool adaptive) -> std::vector<uint8_t>
     {
         REQUIRE(!src.empty(), std::runtime_error, "Data too small");
         REQUIRE(src.size() < (1 << 24), std::runtime_error, "Data too big");
-        const auto srcSize = src.size();
+        REQUIRE(model.empty() || model.size() == RANS_ALPHABET_SIZE, std::runtime_error, "Model must be empty or have " << RANS_ALPHABET_SIZE << " frequencies");
         // store uncompressed size and rANS type flag at start of destination
         std::vector<uint8_t> dst(4, 0);
         *reinterpret_cast<uint32_t *>(dst.data()) = (src.size() << 8) | RANS_TYPE_MARKER;
@@ -119,74 +437,34 @@ namespace Compression
                 nrOfSymbols++;
             }
         }
-        // if we have only a single symbol, change to a different encoding
+        // if we have only a single symbol, change to a different encoding. The model stays unchanged
         if (nrOfSymbols == 1)
         {
             dst.push_back(RANS_HEADER_MODE_SINGLE);
             dst.push_back(singleSymbol);
             return dst;
         }
-        // else calculate counts
-#if RANS_M_BITS <= 8
-        auto counts = calculateCounts<uint8_t>(histogram);
-#else
-        auto counts = calculateCounts<uint16_t>(histogram);
-#endif
-        // store marker for 256-count header mode
-        dst.push_back(RANS_HEADER_MODE_256);
-        // store frequency table in header
-        const auto countsSize8 = counts.size() * sizeof(decltype(counts.front()));
-        dst.resize(dst.size() + countsSize8);
-        std::memcpy(dst.data() + dst.size() - countsSize8, reinterpret_cast<const uint8_t *>(counts.data()), countsSize8);
-        // calculate symbol starts
-        std::vector<uint32_t> starts(RANS_ALPHABET_SIZE, 0);
-        uint32_t currentStart = 0;
-        for (uint32_t i = 0; i < RANS_ALPHABET_SIZE; i++)
-        {
-            starts[i] = currentStart;
-            currentStart += counts[i];
-        }
-        REQUIRE(currentStart == RANS_M, std::runtime_error, "Counts must sum up to RANS_M");
-        // reserve worst case size temporary vector (input size + small margin)
-        std::vector<uint8_t> temp;
-        temp.reserve(src.size() + 16);
-        // encode backwards
-        uint32_t x = RANS_L;
-        for (auto srcIt = src.crbegin(); srcIt != src.crend(); ++srcIt)
+        // else use static table. if allowed, try adaptive model with and without the previous model and use the smallest result
+        auto bestDst = dst;
+        auto bestModel = model;
+        encodeStatic(bestDst, src, histogram, interleaved, bestModel);
+        for (bool usePreviousModel : {false, true})
         {
-            uint8_t symbol = *srcIt;
-            uint32_t count = counts[symbol];
-            uint32_t start = starts[symbol];
-            REQUIRE(count > 0, std::runtime_error, "Zero-count symbol in encoder");
-            // renormalize: emit bytes while x >= x_max
-            const uint32_t x_max = ((RANS_L >> RANS_M_BITS) << 8) * count;
-            while (x >= x_max)
+            if (!adaptive || (usePreviousModel && model.empty()))
             {
-                temp.push_back(static_cast<uint8_t>(x));
-                x >>= 8;
+                continue;
+            }
+            auto adaptiveDst = dst;
+            auto adaptiveModel = model;
+            encodeAdaptive(adaptiveDst, src, usePreviousModel, interleaved, adaptiveModel);
+            if (adaptiveDst.size() < bestDst.size())
+            {
+                bestDst = std::move(adaptiveDst);
+                bestModel = std::move(adaptiveModel);
             }
-            // Encode update
-            uint32_t q = x / count;
-            uint32_t r = x % count;
-            x = (q << RANS_M_BITS) + r + start;
-        }
-        // check how many bytes are needed for final state
-        const auto x_final = x;
-        uint32_t x_statebytes = 0;
-        while (x > 0)
-        {
-            x_statebytes++;
-            x >>= 8;
-        }
-        REQUIRE(x_statebytes <= 4, std::runtime_error, "State too large for 32-bit");
-        // flush final state with length prefix directly to destination
-        dst.push_back(static_cast<uint8_t>(x_statebytes));
-        for (int i = int(x_statebytes) - 1; i >= 0; --i)
-        {
-            dst.push_back(static_cast<uint8_t>(x_final >> (i * 8)));
         }
-        // copy compressed data to end of destination in reverse
-        std::copy(temp.crbegin(), temp.crend(), std::back_inserter(dst));
+        dst = std::move(bestDst);
+        model = std::move(bestModel);
         // resize to multiple of 4
         while ((dst.size() % 4) != 0)
         {
@@ -196,6 +474,12 @@ namespace Compression
     }
 
     auto decodeRANS_50(const std::vector<uint8_t> &src) -> std::vector<uint8_t>
+    {
+        RansModel model;
+        return decodeRANS_50(src, model);
+    }
+
+    auto decodeRANS_50(const std::vector<uint8_t> &src, RansModel &model) -> std::vector<uint8_t>
     {
         REQUIRE(src.size() >= (4 + 1 + 1), std::runtime_error, "Data too small");
         const uint32_t header = *reinterpret_cast<const uint32_t *>(src.data());
@@ -203,7 +487,6 @@ namespace Compression
         const uint32_t uncompressedSize = (header >> 8);
         REQUIRE(uncompressedSize > 0, std::runtime_error, "Bad uncompressed size");
         std::vector<uint8_t> dst;
-        dst.reserve(uncompressedSize);
         // check header byte
         auto srcIt = std::next(src.cbegin(), 4);
         const auto mode = *srcIt++;
@@ -214,6 +497,23 @@ namespace Compression
             dst.resize(uncompressedSize, singleSymbol);
             return dst;
         }
+        const bool interleaved = (mode & RANS_HEADER_INTERLEAVED) != 0;
+        if ((mode & RANS_HEADER_MODE_MASK) == RANS_HEADER_MODE_ADAPTIVE)
+        {
+            const bool usePreviousModel = (mode & RANS_HEADER_ADAPTIVE_PREVIOUS) != 0;
+            REQUIRE(!usePreviousModel || !model.empty(), std::runtime_error, "Data needs model of previous buffer");
+            AdaptiveModel adaptiveModel(usePreviousModel ? model : RansModel());
+            if (interleaved)
+            {
+                decodeSymbols<RANS_INTERLEAVED_STATES>(dst, uncompressedSize, srcIt, src.cend(), adaptiveModel);
+            }
+            else
+            {
+                decodeSymbols<1>(dst, uncompressedSize, srcIt, src.cend(), adaptiveModel);
+            }
+            model = adaptiveModel.frequencies();
+            return dst;
+        }
         // make sure header mode is 256-count mode
         REQUIRE((mode & RANS_HEADER_MODE_MASK) == RANS_HEADER_MODE_256, std::runtime_error, "Bad header mode");
         // read count table
@@ -223,59 +523,21 @@ namespace Compression
         std::vector<uint16_t> counts(RANS_ALPHABET_SIZE, 0);
 #endif
         const auto countsSize8 = counts.size() * sizeof(decltype(counts.front()));
+        REQUIRE(src.size() >= 4 + 1 + countsSize8, std::runtime_error, "Data too small for count table");
         std::memcpy(counts.data(), &*srcIt, countsSize8);
         // skip header and frequency table in source data
         srcIt = std::next(srcIt, countsSize8);
-        // build starts table
-        std::vector<uint16_t> starts(RANS_ALPHABET_SIZE, 0);
-        uint16_t currentStart = 0;
-        for (size_t i = 0; i < RANS_ALPHABET_SIZE; ++i)
-        {
-            starts[i] = currentStart;
-            currentStart += counts[i];
-        }
-        REQUIRE(currentStart == RANS_M, std::runtime_error, "Counts must sum up to RANS_M");
-        // build symbol table
-        std::vector<uint8_t> symbols(RANS_M);
-        uint16_t index = 0;
-        for (uint32_t symbol = 0; symbol < RANS_ALPHABET_SIZE; ++symbol)
+        StaticModel staticModel(counts);
+        if (interleaved)
         {
-            auto count = counts[symbol];
-            for (uint32_t j = 0; j < count; ++j)
-            {
-                REQUIRE(index < RANS_M, std::runtime_error, "Symbol index overflow");
-                symbols[index++] = static_cast<uint8_t>(symbol);
-            }
+            decodeSymbols<RANS_INTERLEAVED_STATES>(dst, uncompressedSize, srcIt, src.cend(), staticModel);
         }
-        REQUIRE(index == RANS_M, std::runtime_error, "Max. symbol index must be == RANS_M");
-        // read rANS state size byte
-        const uint8_t stateSize = *srcIt++;
-        REQUIRE(stateSize >= 0 && stateSize <= 4, std::runtime_error, "Bad state length");
-        REQUIRE(srcIt != src.cend(), std::runtime_error, "Missing rANS state data");
-        // read initial rANS state
-        uint32_t x = 0;
-        for (uint8_t i = 0; i < stateSize; ++i)
+        else
         {
-            x = (x << 8) | *srcIt++;
-        }
-        REQUIRE(x >= RANS_M, std::runtime_error, "Initial rANS state too small");
-        // decompress data
-        while (dst.size() < uncompressedSize)
-        {
-            uint32_t x_tilde = x & (RANS_M - 1);
-            uint8_t symbol = symbols[x_tilde];
-            dst.push_back(symbol);
-            auto count = counts[symbol];
-            REQUIRE(count > 0, std::runtime_error, "Zero-count symbol in decoder");
-            auto start = starts[symbol];
-            x = count * (x >> RANS_M_BITS) + (x_tilde - start);
-            while (x < RANS_L)
-            {
-                REQUIRE(srcIt != src.cend(), std::runtime_error, "Unexpected end of compressed stream while renormalizing");
-                x = (x << 8) | *srcIt++;
-            }
+            decodeSymbols<1>(dst, uncompressedSize, srcIt, src.cend(), staticModel);
         }
-        REQUIRE(dst.size() == uncompressedSize, std::runtime_error, "Bad data size after decoding");
+        // the static counts are the model for the next buffer
+        model.assign(counts.cbegin(), counts.cend());
         return dst;
     }
-}
\ No newline at end of file
+}
@@ -19,18 +19,45 @@ namespace Compression
     static constexpr uint8_t RANS_HEADER_MODE_SINGLE = 0 << RANS_HEADER_MIN_BITS; // Flag value for single-symbol mode
     static constexpr uint8_t RANS_HEADER_MODE_256 = 1 << RANS_HEADER_MIN_BITS;    // Flag value for 256 count mode
     static constexpr uint8_t RANS_HEADER_MODE_RLE = 2 << RANS_HEADER_MIN_BITS;    // Flag value for RLE mode (not implemented)
+    static constexpr uint8_t RANS_HEADER_MODE_ADAPTIVE = 3 << RANS_HEADER_MIN_BITS; // Flag value for adaptive mode
+    static constexpr uint8_t RANS_HEADER_ADAPTIVE_PREVIOUS = 1;                   // Flag value for adaptive mode: Start with model of previous buffer
+    static constexpr uint8_t RANS_HEADER_INTERLEAVED = 2;                         // Flag value for 256 count and adaptive mode: Data uses RANS_INTERLEAVED_STATES states
+
+    static constexpr uint32_t RANS_ADAPTIVE_BLOCK_SIZE = 256;   // Number of symbols after which the adaptive model counts are rebuilt
+    static constexpr uint32_t RANS_ADAPTIVE_MAX_TOTAL = 1 << 12; // Adaptive model frequencies are halved when their sum exceeds this
+    static constexpr uint32_t RANS_INTERLEAVED_STATES = 4;      // Number of rANS states in interleaved mode
+
+    /// @brief Symbol frequencies of the adaptive model, carried from one buffer to the next.
+    /// Empty if there is no model yet, else RANS_ALPHABET_SIZE entries
+    using RansModel = std::vector<uint16_t>;
 
     /// @brief Compress input data using rANS with a 256-byte alphabet and RANS_M = 256.
+    /// Uses a static frequency table stored in the header or single-symbol mode.
     /// Stream format:
     ///       0: 3 bytes uncompressed size
     ///       3: 1 byte rANS type marker "0x40"
     ///       4: 1 byte rANS header mode
-    ///       5: C bytes symbol frequencies (256 or 512 bytes)
+    ///       5: C bytes symbol frequencies (512 bytes in 256-count mode, 0 bytes in adaptive mode)
     ///     5+C: 1 byte initial rANS state size S
     ///   5+C+1: 0-4 byte initial rANS state
+    ///          In interleaved mode RANS_INTERLEAVED_STATES state sizes and states follow each other
     /// 5+C+1+S: N compressed data
-    auto encodeRANS_50(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+    /// @param interleaved If true symbol i is coded with state i % RANS_INTERLEAVED_STATES, so a decoder can decode multiple symbols in parallel
+    auto encodeRANS_50(const std::vector<uint8_t> &data, bool interleaved = false) -> std::vector<uint8_t>;
+
+    /// @brief Compress input data using rANS like encodeRANS_50() and track the model for the next buffer.
+    /// If adaptive is set, uses whichever is smallest of the static frequency table or an adaptive model
+    /// that is rebuilt every RANS_ADAPTIVE_BLOCK_SIZE symbols and needs no table. The adaptive model
+    /// may start with the model of the previous buffer instead of a uniform model. The model is not stored in the stream
+    /// @param model Model of the previous buffer or empty. Will be set to the model to use for the next buffer
+    /// @param interleaved If true symbol i is coded with state i % RANS_INTERLEAVED_STATES, so a decoder can decode multiple symbols in parallel
+    /// @param adaptive If true the adaptive model may be used. Streams then can not be decoded without the model of the previous buffer
+    auto encodeRANS_50(const std::vector<uint8_t> &data, RansModel &model, bool interleaved = false, bool adaptive = false) -> std::vector<uint8_t>;
 
     /// @brief Decompress input data using rANS with a 256-byte alphabet and RANS_M = 256
     auto decodeRANS_50(const std::vector<uint8_t> &data) -> std::vector<uint8_t>;
+
+    /// @brief Decompress input data using rANS like decodeRANS_50(), but with the model of the previous buffer
+    /// @param model Model of the previous buffer or empty. Will be set to the model to use for the next buffer
+    auto decodeRANS_50(const std::vector<uint8_t> &data, RansModel &model) -> std::vector<uint8_t>;
 }
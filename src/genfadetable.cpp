@@ -337,6 +337,9 @@ int main(int argc, const char *argv[])
         case Image::Quantization::Method::AtkinsonDither:
             finalImg = Image::Quantization::atkinsonDither(img.data, img.info.size.width(), img.info.size.height(), colorMapping);
             break;
+        case Image::Quantization::Method::OrderedDither:
+            finalImg = Image::Quantization::orderedDither(img.data, img.info.size.width(), img.info.size.height(), colorMapping);
+            break;
         default:
             THROW(std::runtime_error, "Unsupported quantization method " << Image::Quantization::toString(m_quantizationMethod));
         }
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Automatic compression constants for including in C++ files
+namespace Compression::AutoConstants
+{
+    // Automatically compressed data starts with the regular 4 byte header of the compressor chosen.
+    // The lowest byte of the header is the type marker, the upper 3 bytes are the uncompressed size
+    constexpr uint8_t TYPE_MARKER_UNCOMPRESSED = 0x00; // Data is stored uncompressed after the header
+    constexpr uint8_t TYPE_MARKER_LZSS_10 = 0x10;      // Data is compressed using LZSS variant 10h
+    constexpr uint8_t TYPE_MARKER_LZ4_40 = 0x40;       // Data is compressed using LZ4 variant 40h
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// Chunked compression constants for including in C++ files
+namespace Compression::ChunkedConstants
+{
+    // Chunked data is a directory followed by independently compressed chunks. All values are 32-bit little-endian:
+    // uint32_t header: (uncompressed size << 8) | TYPE_MARKER
+    // uint32_t chunkSize: Uncompressed size of every chunk in bytes. The last chunk may be smaller
+    // uint32_t offsets[nrOfChunks]: Offset of every chunk from the start of the header. nrOfChunks = ceil(uncompressed size / chunkSize)
+    // Chunk data: Every chunk starts with the 4 byte header of the compressor used (see AutoConstants) and is padded to a multiple of 4 bytes
+    constexpr uint8_t TYPE_MARKER = 0x60;            // Used to detect chunked compression in data
+    constexpr uint32_t DIRECTORY_OFFSET = 8;         // Offset of the chunk offset table from the start of the header
+}
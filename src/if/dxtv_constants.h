@@ -4,7 +4,7 @@
 //
 // Header:
 //
-// uint16_t frameFlags -> General frame flags, e.g. FRAME_KEEP
+// uint16_t frameFlags -> General frame flags, e.g. FRAME_KEEP or FRAME_IS_KEY
 // uint16_t dummy -> empty atm
 //
 // Image data:
@@ -46,6 +46,7 @@
 namespace Video::DxtvConstants
 {
     static constexpr uint8_t FRAME_KEEP = 0x40;                                           // 1 for frames that are considered a direct copy of the previous frame and can be kept
+    static constexpr uint8_t FRAME_IS_KEY = 0x80;                                         // 1 for key frames, e.g. after a scene cut. They do not reference the previous frame
     static constexpr uint32_t BLOCK_MIN_DIM = 4;                                          // Minimum block size is 4x4 pixels
     static constexpr uint32_t BLOCK_MAX_DIM = 8;                                          // Maximum block size is 8x8 pixels
     static constexpr bool BLOCK_NO_SPLIT = false;                                         // The block is a full block
@@ -63,6 +64,7 @@ namespace Video::DxtvConstants
 #else
 // DXTV frame format constants for including in assembly files
 #define DXTV_CONSTANTS_FRAME_KEEP 0x40                                                    // 1 for frames that are considered a direct copy of the previous frame and can be kept
+#define DXTV_CONSTANTS_FRAME_IS_KEY 0x80                                                  // 1 for key frames, e.g. after a scene cut. They do not reference the previous frame
 #define DXTV_CONSTANTS_BLOCK_MIN_SHIFT 2                                                  // Minumum block size is 4x4 pixels
 #define DXTV_CONSTANTS_BLOCK_MIN_DIM (1 << DXTV_CONSTANTS_BLOCK_MIN_SHIFT)                // Maximum block size is 8x8 pixels
 #define DXTV_CONSTANTS_BLOCK_MAX_SHIFT 3                                                  // Maximum block size is 8x8 pixels
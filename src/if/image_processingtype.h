@@ -26,8 +26,12 @@ namespace Image
         DeltaImage = 55,                   // Calculate signed pixel difference between successive images
         CompressRLE = 60,                  // Compress image data using run-length-encoding
         CompressLZSS_10 = 61,              // Compress image data using LZSS variant 10h
+        CompressHuffman_20 = 62,           // Compress image data using Huffman variant 20h
         CompressLZ4_40 = 64,               // Compress image data using LZ4 variant 40h
         CompressRANS_50 = 65,              // Compress image data using rANS variant 50h
+        CompressLZ4Dictionary_40 = 66,     // Compress image data using LZ4 variant 40h with the previous image as dictionary
+        CompressAuto = 68,                 // Compress image data using the best of LZSS 10h, LZ4 40h or no compression per image
+        CompressChunked = 69,              // Compress image data in independent chunks using the best of LZSS 10h, LZ4 40h or no compression per chunk
         CompressDXT = 70,                  // Compress image data using DXT
         CompressDXTV = 71,                 // Compress image data using DXTV
         CompressGVID = 72,                 // Compress image data using GVID
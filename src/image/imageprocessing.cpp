@@ -6,6 +6,9 @@
 #include "color/rgb565.h"
 #include "color/xrgb1555.h"
 #include "color/xrgb8888.h"
+#include "compression/autocompress.h"
+#include "compression/chunked.h"
+#include "compression/huffman.h"
 #include "compression/lz4.h"
 #include "compression/lzss.h"
 #include "compression/rans.h"
@@ -49,8 +52,12 @@ namespace Image
             {ProcessingType::ConvertDelta16, {"delta-16", ConvertFunc(toDelta16)}},
             {ProcessingType::DeltaImage, {"pixel diff", ConvertStateFunc(pixelDiff)}},
             {ProcessingType::CompressLZ4_40, {"compress LZ4 40h", ConvertFunc(compressLZ4_40)}},
+            {ProcessingType::CompressLZ4Dictionary_40, {"compress LZ4 40h dictionary", ConvertStateFunc(compressLZ4Dictionary_40)}},
             {ProcessingType::CompressLZSS_10, {"compress LZSS 10h", ConvertFunc(compressLZSS_10)}},
-            {ProcessingType::CompressRANS_50, {"compress rANS 50h", ConvertFunc(compressRANS_50)}},
+            {ProcessingType::CompressHuffman_20, {"compress Huffman 20h", ConvertFunc(compressHuffman_20)}},
+            {ProcessingType::CompressRANS_50, {"compress rANS 50h", ConvertStateFunc(compressRANS_50)}},
+            {ProcessingType::CompressAuto, {"compress auto", ConvertFunc(compressAuto)}},
+            {ProcessingType::CompressChunked, {"compress chunked", ConvertFunc(compressChunked)}},
             //{ProcessingType::CompressRLE, {"compress RLE", ConvertFunc(compressRLE)}},
             {ProcessingType::CompressDXT, {"compress DXT", ConvertFunc(compressDXT)}},
             {ProcessingType::CompressDXTV, {"compress DXTV", ConvertStateFunc(compressDXTV)}},
@@ -107,6 +114,9 @@ namespace Image
         case Quantization::Method::AtkinsonDither:
             result.data = Quantization::atkinsonDither(data.data, data.info.size.width(), data.info.size.height(), colorMapping);
             break;
+        case Quantization::Method::OrderedDither:
+            result.data = Quantization::orderedDither(data.data, data.info.size.width(), data.info.size.height(), colorMapping);
+            break;
         default:
             THROW(std::runtime_error, "Unsupported quantization method " << Quantization::toString(quantizationMethod));
         }
@@ -154,6 +164,9 @@ namespace Image
             case Quantization::Method::AtkinsonDither:
                 r.data = Quantization::atkinsonDither(d.data, d.info.size.width(), d.info.size.height(), colorMapping);
                 break;
+            case Quantization::Method::OrderedDither:
+                r.data = Quantization::orderedDither(d.data, d.info.size.width(), d.info.size.height(), colorMapping);
+                break;
             default:
                 THROW(std::runtime_error, "Unsupported quantization method " << Quantization::toString(quantizationMethod));
             }
@@ -389,11 +402,12 @@ namespace Image
     Frame Processing::compressLZ4_40(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
     {
         // get parameter(s)
-        REQUIRE(VariantHelpers::hasTypes<bool>(parameters), std::runtime_error, "compressLZ4_40 expects a bool VRAMcompatible parameter");
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZ4_40 expects a bool VRAMcompatible and a bool optimal parse parameter");
         const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
         // compress data
         auto result = data;
-        result.data.pixels() = PixelData(Compression::encodeLZ4_40(result.data.pixels().convertDataToRaw(), vramCompatible), Color::Format::Unknown);
+        result.data.pixels() = PixelData(Compression::encodeLZ4_40(result.data.pixels().convertDataToRaw(), vramCompatible, optimalParse), Color::Format::Unknown);
         result.type.setCompressed();
         // print statistics
         if (statistics != nullptr)
@@ -404,14 +418,36 @@ namespace Image
         return result;
     }
 
+    Frame Processing::compressLZ4Dictionary_40(const Frame &data, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, Statistics::Frame::SPtr statistics)
+    {
+        // get parameter(s)
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZ4Dictionary_40 expects a bool VRAMcompatible and a bool optimal parse parameter");
+        const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
+        // compress data. the uncompressed data of the previous image is used as dictionary
+        auto result = data;
+        auto rawData = result.data.pixels().convertDataToRaw();
+        result.data.pixels() = PixelData(Compression::encodeLZ4_40(rawData, state, vramCompatible, optimalParse), Color::Format::Unknown);
+        result.type.setCompressed();
+        state = std::move(rawData);
+        // print statistics
+        if (statistics != nullptr)
+        {
+            const auto ratioPercent = static_cast<double>(result.data.pixels().rawSize() * 100.0 / static_cast<double>(data.data.pixels().rawSize()));
+            std::cout << "LZ4 40h dictionary compression ratio: " << std::fixed << std::setprecision(1) << ratioPercent << "%" << std::endl;
+        }
+        return result;
+    }
+
     Frame Processing::compressLZSS_10(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
     {
         // get parameter(s)
-        REQUIRE(VariantHelpers::hasTypes<bool>(parameters), std::runtime_error, "compressLZSS_10 expects a bool VRAMcompatible parameter");
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressLZSS_10 expects a bool VRAMcompatible and a bool optimal parse parameter");
         const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
         // compress data
         auto result = data;
-        result.data.pixels() = PixelData(Compression::encodeLZSS_10(result.data.pixels().convertDataToRaw(), vramCompatible), Color::Format::Unknown);
+        result.data.pixels() = PixelData(Compression::encodeLZSS_10(result.data.pixels().convertDataToRaw(), vramCompatible, optimalParse), Color::Format::Unknown);
         result.type.setCompressed();
         // print statistics
         if (statistics != nullptr)
@@ -422,11 +458,87 @@ namespace Image
         return result;
     }
 
-    Frame Processing::compressRANS_50(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
+    Frame Processing::compressHuffman_20(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
     {
+        // get parameter(s)
+        REQUIRE(VariantHelpers::hasTypes<uint32_t>(parameters), std::runtime_error, "compressHuffman_20 expects a uint32_t bits per symbol parameter");
+        const auto bitsPerSymbol = VariantHelpers::getValue<uint32_t, 0>(parameters);
+        REQUIRE(bitsPerSymbol == 4 || bitsPerSymbol == 8, std::runtime_error, "Bits per symbol must be 4 or 8");
         // compress data
         auto result = data;
-        result.data.pixels() = PixelData(Compression::encodeRANS_50(result.data.pixels().convertDataToRaw()), Color::Format::Unknown);
+        result.data.pixels() = PixelData(Compression::encodeHuffman_20(result.data.pixels().convertDataToRaw(), bitsPerSymbol), Color::Format::Unknown);
+        result.type.setCompressed();
+        // print statistics
+        if (statistics != nullptr)
+        {
+            const auto ratioPercent = static_cast<double>(result.data.pixels().rawSize() * 100.0 / static_cast<double>(data.data.pixels().rawSize()));
+            std::cout << "Huffman 20h compression ratio: " << std::fixed << std::setprecision(1) << ratioPercent << "%" << std::endl;
+        }
+        return result;
+    }
+
+    Frame Processing::compressAuto(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
+    {
+        // get parameter(s)
+        REQUIRE((VariantHelpers::hasTypes<bool, bool, bool, bool, double>(parameters)), std::runtime_error, "compressAuto expects a bool VRAMcompatible, a bool optimal parse, a bool LZ4, a bool LZSS and a double cycle weight parameter");
+        const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
+        const auto useLZ4 = VariantHelpers::getValue<bool, 2>(parameters);
+        const auto useLZSS = VariantHelpers::getValue<bool, 3>(parameters);
+        const auto cycleWeight = VariantHelpers::getValue<double, 4>(parameters);
+        // compress data
+        auto result = data;
+        result.data.pixels() = PixelData(Compression::encodeAuto(result.data.pixels().convertDataToRaw(), useLZ4, useLZSS, vramCompatible, optimalParse, cycleWeight), Color::Format::Unknown);
+        result.type.setCompressed();
+        // print statistics
+        if (statistics != nullptr)
+        {
+            const auto typeMarker = result.data.pixels().convertDataToRaw().front();
+            const auto ratioPercent = static_cast<double>(result.data.pixels().rawSize() * 100.0 / static_cast<double>(data.data.pixels().rawSize()));
+            std::cout << "Auto compression type: 0x" << std::hex << static_cast<uint32_t>(typeMarker) << std::dec << ", ratio: " << std::fixed << std::setprecision(1) << ratioPercent << "%" << std::endl;
+        }
+        return result;
+    }
+
+    Frame Processing::compressChunked(const Frame &data, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics)
+    {
+        // get parameter(s)
+        REQUIRE((VariantHelpers::hasTypes<bool, bool, bool, bool, uint32_t>(parameters)), std::runtime_error, "compressChunked expects a bool VRAMcompatible, a bool optimal parse, a bool LZ4, a bool LZSS and a uint32_t chunk size parameter");
+        const auto vramCompatible = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto optimalParse = VariantHelpers::getValue<bool, 1>(parameters);
+        const auto useLZ4 = VariantHelpers::getValue<bool, 2>(parameters);
+        const auto useLZSS = VariantHelpers::getValue<bool, 3>(parameters);
+        const auto chunkSize = VariantHelpers::getValue<uint32_t, 4>(parameters);
+        // compress data
+        auto result = data;
+        auto encodeChunk = [vramCompatible, optimalParse, useLZ4, useLZSS](const std::vector<uint8_t> &chunk)
+        {
+            return Compression::encodeAuto(chunk, useLZ4, useLZSS, vramCompatible, optimalParse);
+        };
+        result.data.pixels() = PixelData(Compression::encodeChunked(result.data.pixels().convertDataToRaw(), chunkSize, encodeChunk), Color::Format::Unknown);
+        result.type.setCompressed();
+        // print statistics
+        if (statistics != nullptr)
+        {
+            const auto nrOfChunks = Compression::chunkCount(result.data.pixels().convertDataToRaw());
+            const auto ratioPercent = static_cast<double>(result.data.pixels().rawSize() * 100.0 / static_cast<double>(data.data.pixels().rawSize()));
+            std::cout << "Chunked compression chunks: " << nrOfChunks << ", ratio: " << std::fixed << std::setprecision(1) << ratioPercent << "%" << std::endl;
+        }
+        return result;
+    }
+
+    Frame Processing::compressRANS_50(const Frame &data, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, Statistics::Frame::SPtr statistics)
+    {
+        // get parameter(s)
+        REQUIRE((VariantHelpers::hasTypes<bool, bool>(parameters)), std::runtime_error, "compressRANS_50 expects bool interleaved and bool adaptive parameters");
+        const auto interleaved = VariantHelpers::getValue<bool, 0>(parameters);
+        const auto adaptive = VariantHelpers::getValue<bool, 1>(parameters);
+        // compress data. the adaptive model of the previous image is used as a starting point
+        auto model = DataHelpers::convertTo<uint16_t>(state);
+        auto result = data;
+        result.data.pixels() = PixelData(Compression::encodeRANS_50(result.data.pixels().convertDataToRaw(), model, interleaved, adaptive), Color::Format::Unknown);
+        // store adaptive model as state
+        state = DataHelpers::convertTo<uint8_t>(model);
         result.type.setCompressed();
         // print statistics
         if (statistics != nullptr)
@@ -478,15 +590,16 @@ namespace Image
         REQUIRE(data.info.size.width() % 8 == 0, std::runtime_error, "Image width must be a multiple of 8 for DXTV compression");
         REQUIRE(data.info.size.height() % 8 == 0, std::runtime_error, "Image height must be a multiple of 8 for DXTV compression");
         // get parameter(s)
-        REQUIRE((VariantHelpers::hasTypes<Color::Format, double>(parameters)), std::runtime_error, "compressDXTV expects a Color::Format and a double quality parameter");
+        REQUIRE((VariantHelpers::hasTypes<Color::Format, double, bool>(parameters)), std::runtime_error, "compressDXTV expects a Color::Format, a double quality and a bool fast motion search parameter");
         const auto format = VariantHelpers::getValue<Color::Format, 0>(parameters);
         REQUIRE(format == Color::Format::XRGB1555 || format == Color::Format::XBGR1555, std::runtime_error, "Output color format must be in [RGB555, BGR555]");
         auto quality = VariantHelpers::getValue<double, 1>(parameters);
         REQUIRE(quality >= 0 && quality <= 100, std::runtime_error, "compressDXTV quality must be in [0, 100]");
+        const auto motionSearch = VariantHelpers::getValue<bool, 2>(parameters) ? Video::Dxtv::MotionSearch::Fast : Video::Dxtv::MotionSearch::Exhaustive;
         // convert image using DXTV compression
         auto result = data;
         auto previousImage = state.empty() ? std::vector<Color::XRGB8888>() : DataHelpers::convertTo<Color::XRGB8888>(state);
-        auto compressedData = Video::Dxtv::encode(data.data.pixels().data<Color::XRGB8888>(), previousImage, data.info.size.width(), data.info.size.height(), quality, format == Color::Format::XBGR1555, statistics);
+        auto compressedData = Video::Dxtv::encode(data.data.pixels().data<Color::XRGB8888>(), previousImage, data.info.size.width(), data.info.size.height(), quality, format == Color::Format::XBGR1555, motionSearch, Video::Dxtv::ModeDecision::RateDistortion, statistics);
         result.data.pixels() = PixelData(compressedData.first, Color::Format::Unknown);
         result.info.pixelFormat = format;
         result.info.colorMapFormat = Color::Format::Unknown;
@@ -150,16 +150,53 @@ namespace Image
         /// @brief Compress image data using LZ4 variant 40h
         /// @param parameters:
         /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
         static Frame compressLZ4_40(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
 
+        /// @brief Compress image data using LZ4 variant 40h with the previous image as dictionary
+        /// @param parameters:
+        /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
+        /// @param state Uncompressed data of previous image
+        static Frame compressLZ4Dictionary_40(const Frame &image, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, Statistics::Frame::SPtr statistics);
+
         /// @brief Compress image data using LZSS variant 10h
         /// @param parameters:
         /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
         static Frame compressLZSS_10(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
 
+        /// @brief Compress image data using Huffman variant 20h
+        /// @param parameters:
+        /// - Bits per Huffman symbol as uint32_t. Must be 4 or 8
+        static Frame compressHuffman_20(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
+
+        /// @brief Compress image data using the best of LZ4 variant 40h, LZSS variant 10h or no compression.
+        /// The compressor chosen is recorded in the type marker of the data header
+        /// @param parameters:
+        /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
+        /// - Flag to try LZ4 variant 40h as bool
+        /// - Flag to try LZSS variant 10h as bool
+        /// - Weight of estimated GBA decode cycles against compressed size in bytes as double. Must be >= 0
+        static Frame compressAuto(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
+
+        /// @brief Split image data into chunks and compress them independently and in parallel using the best of LZ4 variant 40h, LZSS variant 10h or no compression.
+        /// The data starts with a chunk directory, so single chunks can be decompressed
+        /// @param parameters:
+        /// - Flag for VRAM-compatible compression as bool. Pass true to turn on
+        /// - Flag for optimal parsing as bool. Pass true to turn on
+        /// - Flag to try LZ4 variant 40h as bool
+        /// - Flag to try LZSS variant 10h as bool
+        /// - Uncompressed chunk size in bytes as uint32_t. Must be a multiple of 4
+        static Frame compressChunked(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
+
         /// @brief Compress image data using rANS variant 50h
-        /// @param parameters: none
-        static Frame compressRANS_50(const Frame &image, const std::vector<Parameter> &parameters, Statistics::Frame::SPtr statistics);
+        /// @param parameters:
+        /// - Flag for interleaved rANS states as bool. Pass true to turn on
+        /// - Flag for allowing the adaptive model as bool. Pass true to turn on
+        /// @param state Adaptive model of previous image as Data
+        static Frame compressRANS_50(const Frame &image, const std::vector<Parameter> &parameters, std::vector<uint8_t> &state, Statistics::Frame::SPtr statistics);
 
         /// @brief Compress image data using RLE
         /// @param parameters:
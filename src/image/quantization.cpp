@@ -1,11 +1,111 @@
 #include "quantization.h"
 
+#include "color/cielabf.h"
+#include "color/conversions.h"
+#include "color/gamma.h"
 #include "exception.h"
 #include "math/colorfit.h"
+#include "math/kdtree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
 
 namespace Image
 {
 
+    /// @brief Reverse color mapping from source colors to color map indices using a lookup table with an entry for every 24-bit RGB color.
+    /// The table is not initialized, so only memory pages of mapped colors are touched. A bitset stores which colors are mapped
+    class ReverseMapping
+    {
+    public:
+        ReverseMapping(const std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> &colorMapping)
+            : m_indices(std::make_unique_for_overwrite<uint8_t[]>(NrOfColors)), m_isMapped(NrOfColors / 64, 0)
+        {
+            uint32_t index = 0;
+            for (const auto &m : colorMapping)
+            {
+                for (const auto &srcColor : m.second)
+                {
+                    // if a color is mapped multiple times, the first mapping is used
+                    const auto rgb = static_cast<uint32_t>(srcColor);
+                    if (!isMapped(rgb))
+                    {
+                        m_isMapped[rgb / 64] |= uint64_t(1) << (rgb % 64);
+                        m_indices[rgb] = static_cast<uint8_t>(index);
+                    }
+                }
+                ++index;
+            }
+        }
+
+        /// @brief Get color map index for source color
+        auto at(const Color::XRGB8888 &srcColor) const -> uint8_t
+        {
+            const auto rgb = static_cast<uint32_t>(srcColor);
+            REQUIRE(isMapped(rgb), std::runtime_error, "Color #" << srcColor.toHex() << " not found in color mapping");
+            return m_indices[rgb];
+        }
+
+    private:
+        static constexpr uint32_t NrOfColors = 1 << 24;
+
+        auto isMapped(uint32_t rgb) const -> bool
+        {
+            return (m_isMapped[rgb / 64] >> (rgb % 64)) & 1;
+        }
+
+        std::unique_ptr<uint8_t[]> m_indices; // Color map index for every 24-bit RGB color. Only valid if the color is mapped
+        std::vector<uint64_t> m_isMapped;     // Bitset of mapped 24-bit RGB colors
+    };
+
+    /// @brief Closest color lookup for arbitrary 24-bit RGB colors. Colors are compared in CIELab color space using a kd-tree.
+    /// RGB colors are grouped into cells of 2^(8 - CELL_BITS) colors per channel and the closest color of the cell center is used for all colors in a cell.
+    /// Optionally the closest color of the cell center plus a per-channel offset is looked up, e.g. for ordered dithering.
+    /// Results are cached in a lookup table with an entry for every offset and cell, which is filled when an entry is looked up first
+    template <uint32_t CELL_BITS>
+    class ClosestColorCache
+    {
+    public:
+        ClosestColorCache(const std::vector<Color::XRGB8888> &colorMap, const std::vector<float> &offsets = {0.0F})
+            : m_colorMapTree(Color::convertTo<Color::CIELabf>(Color::srgbToLinear(colorMap))), m_offsets(offsets), m_indices(offsets.size() * NrOfCells, -1)
+        {
+            REQUIRE(colorMap.size() > 0 && colorMap.size() <= 256, std::runtime_error, "Color map must have [1,256] entries");
+            REQUIRE(!offsets.empty(), std::runtime_error, "Offsets can not be empty");
+        }
+
+        /// @brief Get index of color map entry closest to color + offsets[offsetIndex]
+        auto at(const Color::XRGB8888 &color, std::size_t offsetIndex = 0) -> uint8_t
+        {
+            const auto cell = ((static_cast<uint32_t>(color.R()) >> CellShift) << (2 * CELL_BITS)) | ((static_cast<uint32_t>(color.G()) >> CellShift) << CELL_BITS) | (static_cast<uint32_t>(color.B()) >> CellShift);
+            auto &index = m_indices[offsetIndex * NrOfCells + cell];
+            if (index < 0)
+            {
+                std::array<uint8_t, 3> cellCenter;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    const float value = static_cast<float>((color[c] & CellMask) | CellHalf) + m_offsets[offsetIndex];
+                    cellCenter[c] = static_cast<uint8_t>(std::clamp(value, 0.0F, 255.0F) + 0.5F);
+                }
+                index = static_cast<int16_t>(m_colorMapTree.closestIndex(Color::convertTo<Color::CIELabf>(Color::srgbToLinear(Color::XRGB8888(cellCenter)))));
+            }
+            return static_cast<uint8_t>(index);
+        }
+
+    private:
+        static_assert(CELL_BITS >= 1 && CELL_BITS <= 7, "Cell bits must be in [1,7]");
+        static constexpr uint32_t NrOfCells = 1 << (3 * CELL_BITS);
+        static constexpr uint32_t CellShift = 8 - CELL_BITS;
+        static constexpr uint32_t CellMask = (0xFF << CellShift) & 0xFF;
+        static constexpr uint32_t CellHalf = 1 << (CellShift - 1);
+
+        const KdTree<Color::CIELabf> m_colorMapTree; // Color map entries in CIELab color space
+        const std::vector<float> m_offsets;          // Offsets added to all channels of the cell center before looking up the closest color
+        std::vector<int16_t> m_indices;              // Closest color map index for every offset and cell or -1 if not cached yet
+    };
+
     auto Quantization::quantizeThreshold(const ImageData &data, float threshold) -> ImageData
     {
         REQUIRE(!data.pixels().empty(), std::runtime_error, "Input data can not be empty");
@@ -22,16 +122,13 @@ namespace Image
     {
         REQUIRE(!data.pixels().empty(), std::runtime_error, "Input data can not be empty");
         REQUIRE(data.pixels().format() == Color::Format::XRGB8888, std::runtime_error, "RGB888 input data expected");
-        REQUIRE(colorMapping.size() > 0, std::runtime_error, "Color mapping can not be empty");
+        REQUIRE(colorMapping.size() > 0 && colorMapping.size() <= 256, std::runtime_error, "Color mapping must have [1,256] entries");
         // build color map
         std::vector<Color::XRGB8888> resultColorMap;
         std::transform(colorMapping.cbegin(), colorMapping.cend(), std::back_inserter(resultColorMap), [](const auto &m)
                        { return m.first; });
         // reverse color mapping
-        std::map<Color::XRGB8888, uint8_t> reverseMapping;
-        std::for_each(colorMapping.cbegin(), colorMapping.cend(), [&reverseMapping, index = 0](const auto &m) mutable
-                      { std::transform(m.second.cbegin(), m.second.cend(), std::inserter(reverseMapping, reverseMapping.end()), [index](auto srcColor)
-                                      { return std::make_pair(srcColor, index); }); ++index; });
+        const ReverseMapping reverseMapping(colorMapping);
         // map pixel colors to indices
         const auto srcPixels = data.pixels().data<Color::XRGB8888>();
         std::vector<uint8_t> resultPixels;
@@ -46,8 +143,118 @@ namespace Image
         REQUIRE(!data.pixels().empty(), std::runtime_error, "Input data can not be empty");
         REQUIRE(data.pixels().format() == Color::Format::XRGB8888, std::runtime_error, "RGB888 input data expected");
         REQUIRE(width > 0 && height > 0, std::runtime_error, "Bad input image size");
-        REQUIRE(colorMapping.size() > 0, std::runtime_error, "Color mapping can not be empty");
-        return ImageData{};
+        REQUIRE(data.pixels().size() == static_cast<std::size_t>(width) * height, std::runtime_error, "Input data size does not match image size");
+        REQUIRE(colorMapping.size() > 0 && colorMapping.size() <= 256, std::runtime_error, "Color mapping must have [1,256] entries");
+        // build color map
+        std::vector<Color::XRGB8888> resultColorMap;
+        std::transform(colorMapping.cbegin(), colorMapping.cend(), std::back_inserter(resultColorMap), [](const auto &m)
+                       { return m.first; });
+        ClosestColorCache<6> closestColors(resultColorMap);
+        // error rows for the current and the next two rows. Rows have 2 pixels of padding left and right, so errors can be added without bounds checks
+        static constexpr int32_t Padding = 2;
+        const std::size_t errorRowSize = (width + 2 * Padding) * 3;
+        std::array<std::vector<float>, 3> errorRows = {std::vector<float>(errorRowSize, 0.0F), std::vector<float>(errorRowSize, 0.0F), std::vector<float>(errorRowSize, 0.0F)};
+        // dither image in serpentine order, even rows from left to right, odd rows from right to left.
+        // Atkinson dithering spreads 6/8 of the error to these pixels:
+        //     X 1 1
+        //   1 1 1
+        //     1
+        // See: https://beyondloom.com/blog/dither.html
+        const auto &srcPixels = data.pixels().data<Color::XRGB8888>();
+        std::vector<uint8_t> resultPixels(srcPixels.size());
+        for (int32_t y = 0; y < static_cast<int32_t>(height); ++y)
+        {
+            const int32_t direction = (y & 1) == 0 ? 1 : -1;
+            float *error0 = errorRows[0].data() + Padding * 3;
+            float *error1 = errorRows[1].data() + Padding * 3;
+            float *error2 = errorRows[2].data() + Padding * 3;
+            const auto srcRow = srcPixels.data() + static_cast<std::size_t>(y) * width;
+            auto dstRow = resultPixels.data() + static_cast<std::size_t>(y) * width;
+            for (int32_t i = 0; i < static_cast<int32_t>(width); ++i)
+            {
+                const int32_t x = direction > 0 ? i : static_cast<int32_t>(width) - 1 - i;
+                // add error to pixel and find closest color
+                std::array<float, 3> color;
+                std::array<uint8_t, 3> rgb;
+                for (int32_t c = 0; c < 3; ++c)
+                {
+                    color[c] = std::clamp(static_cast<float>(srcRow[x][c]) + error0[x * 3 + c], 0.0F, 255.0F);
+                    rgb[c] = static_cast<uint8_t>(color[c] + 0.5F);
+                }
+                const auto index = closestColors.at(Color::XRGB8888(rgb));
+                dstRow[x] = index;
+                // spread error to neighbours
+                const auto &closestColor = resultColorMap[index];
+                for (int32_t c = 0; c < 3; ++c)
+                {
+                    const float error = (color[c] - static_cast<float>(closestColor[c])) / 8.0F;
+                    error0[(x + direction) * 3 + c] += error;
+                    error0[(x + 2 * direction) * 3 + c] += error;
+                    error1[(x - direction) * 3 + c] += error;
+                    error1[x * 3 + c] += error;
+                    error1[(x + direction) * 3 + c] += error;
+                    error2[x * 3 + c] += error;
+                }
+            }
+            // move to next row and clear error of row after next
+            std::rotate(errorRows.begin(), errorRows.begin() + 1, errorRows.end());
+            std::fill(errorRows[2].begin(), errorRows[2].end(), 0.0F);
+        }
+        return ImageData(resultPixels, Color::Format::Paletted8, resultColorMap);
+    }
+
+    auto Quantization::orderedDither(const ImageData &data, uint32_t width, uint32_t height, const std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> &colorMapping) -> ImageData
+    {
+        REQUIRE(!data.pixels().empty(), std::runtime_error, "Input data can not be empty");
+        REQUIRE(data.pixels().format() == Color::Format::XRGB8888, std::runtime_error, "RGB888 input data expected");
+        REQUIRE(width > 0 && height > 0, std::runtime_error, "Bad input image size");
+        REQUIRE(data.pixels().size() == static_cast<std::size_t>(width) * height, std::runtime_error, "Input data size does not match image size");
+        REQUIRE(colorMapping.size() > 0 && colorMapping.size() <= 256, std::runtime_error, "Color mapping must have [1,256] entries");
+        // build color map
+        std::vector<Color::XRGB8888> resultColorMap;
+        std::transform(colorMapping.cbegin(), colorMapping.cend(), std::back_inserter(resultColorMap), [](const auto &m)
+                       { return m.first; });
+        // spread offsets over the average distance of colors to their closest color in the color map, so flat areas between two colors get dithered
+        double spread = 0.0;
+        for (std::size_t i = 0; i < resultColorMap.size(); ++i)
+        {
+            float closestDistance = std::numeric_limits<float>::max();
+            for (std::size_t j = 0; j < resultColorMap.size(); ++j)
+            {
+                if (i != j)
+                {
+                    float distance = 0.0F;
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        const float delta = static_cast<float>(resultColorMap[i][c]) - static_cast<float>(resultColorMap[j][c]);
+                        distance += delta * delta;
+                    }
+                    closestDistance = std::min(closestDistance, distance);
+                }
+            }
+            spread += resultColorMap.size() > 1 ? std::sqrt(closestDistance) : 0.0;
+        }
+        spread /= resultColorMap.size();
+        // 4x4 Bayer threshold matrix. See: https://en.wikipedia.org/wiki/Ordered_dithering
+        static constexpr std::array<uint32_t, 16> BayerMatrix = {0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5};
+        std::vector<float> offsets;
+        std::transform(BayerMatrix.cbegin(), BayerMatrix.cend(), std::back_inserter(offsets), [spread](auto threshold)
+                       { return static_cast<float>(spread * ((threshold + 0.5) / 16.0 - 0.5)); });
+        // closest colors of every cell of 32x32x32 colors for all thresholds. Every pixel needs one table lookup
+        ClosestColorCache<5> closestColors(resultColorMap, offsets);
+        const auto &srcPixels = data.pixels().data<Color::XRGB8888>();
+        std::vector<uint8_t> resultPixels(srcPixels.size());
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto srcRow = srcPixels.data() + static_cast<std::size_t>(y) * width;
+            auto dstRow = resultPixels.data() + static_cast<std::size_t>(y) * width;
+            const std::size_t thresholdRow = (y & 3) * 4;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                dstRow[x] = closestColors.at(srcRow[x], thresholdRow + (x & 3));
+            }
+        }
+        return ImageData(resultPixels, Color::Format::Paletted8, resultColorMap);
     }
 
 }
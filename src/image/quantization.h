@@ -22,13 +22,24 @@ namespace Image
         /// @return Returns pixel data quantized and converted to Color::Format::Paletted8
         auto quantizeClosest(const ImageData &data, const std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> &colorMapping) -> ImageData;
 
-        /// @brief Quantize pixel data using Atkison error-diffusion dither and choosing colors from given palette
+        /// @brief Quantize pixel data using Atkinson error-diffusion dither and choosing colors from given palette.
+        /// Rows are processed in serpentine order. Closest colors are searched in CIELab color space. The result is deterministic
         /// @param[in] data Input image data
         /// @param[in] width Image width
         /// @param[in] height Image height
-        /// @param[in] colorMapping Mapping of target color -> source colors
+        /// @param[in] colorMapping Mapping of target color -> source colors. Only the target colors are used as palette
         /// @return Returns pixel data quantized and converted to Color::Format::Paletted8
         auto atkinsonDither(const ImageData &data, uint32_t width, uint32_t height, const std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> &colorMapping) -> ImageData;
+
+        /// @brief Quantize pixel data using ordered 4x4 Bayer dither and choosing colors from given palette.
+        /// The dither pattern is fixed to pixel positions, so it does not change between frames of a video. The dither strength is derived from
+        /// the distances between palette colors. Closest colors are searched in CIELab color space and cached, so every pixel costs one table lookup
+        /// @param[in] data Input image data
+        /// @param[in] width Image width
+        /// @param[in] height Image height
+        /// @param[in] colorMapping Mapping of target color -> source colors. Only the target colors are used as palette
+        /// @return Returns pixel data quantized and converted to Color::Format::Paletted8
+        auto orderedDither(const ImageData &data, uint32_t width, uint32_t height, const std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> &colorMapping) -> ImageData;
     }
 
 }
@@ -13,6 +13,8 @@ namespace Image
             return "Closest color";
         case Method::AtkinsonDither:
             return "Atkinson dither";
+        case Method::OrderedDither:
+            return "Ordered dither";
         default:
             THROW(std::runtime_error, "Bad quantization method");
         }
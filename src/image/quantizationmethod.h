@@ -12,8 +12,9 @@ namespace Image
         enum class Method
         {
             None = 0,
-            ClosestColor = 1,  // Choose closest color in target color space and colormap
-            AtkinsonDither = 2 // Dither image using the Atkinson dithering algorithm
+            ClosestColor = 1,   // Choose closest color in target color space and colormap
+            AtkinsonDither = 2, // Dither image using the Atkinson dithering algorithm
+            OrderedDither = 3   // Dither image using an ordered 4x4 Bayer matrix
         };
 
         /// @brief Return quantization method as string
@@ -22,14 +22,18 @@ using namespace Color;
 
 #define CLUSTER_FIT
 
+// DXT endpoint colors c0, c1 and intermediate colors c2, c3
+using Endpoints = std::array<RGBf, 4>;
+
 // Fit a line through colors passed using SVD
 // This is basically the "range fit" method from here: http://www.sjbrown.co.uk/2006/01/19/dxt-compression-techniques/
-auto dxtLineFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std::pair<std::vector<RGBf>, std::vector<RGBf>>
+template <std::size_t N>
+auto dxtLineFit(const std::array<RGBf, N> &colors, const bool asRGB565) -> std::pair<Endpoints, Endpoints>
 {
     // calculate initial line fit through RGB color space
     auto originAndAxis = lineFit(colors);
     // calculate signed distance along line from origin
-    std::vector<float> distanceOnLine(colors.size());
+    std::array<float, N> distanceOnLine;
     std::transform(colors.cbegin(), colors.cend(), distanceOnLine.begin(), [axis = originAndAxis.second](const auto &color)
                    { return color.dot(axis); });
     // get the distance of endpoints c0 and c1 on line
@@ -37,14 +41,14 @@ auto dxtLineFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std::pa
     auto i0 = std::distance(distanceOnLine.cbegin(), minMaxDistance.first);
     auto i1 = std::distance(distanceOnLine.cbegin(), minMaxDistance.second);
     // get colors c0 and c1 on line
-    std::vector<RGBf> e0(4);
+    Endpoints e0;
     e0[0] = RGBf::roundTo(colors[i0], asRGB565 ? RGB565::Max : XRGB1555::Max);
     e0[1] = RGBf::roundTo(colors[i1], asRGB565 ? RGB565::Max : XRGB1555::Max);
     // calculate intermediate colors c2 and c3 at 1/3 and 2/3
     e0[2] = RGBf::roundTo(RGBf((e0[0].cwiseProduct(RGBf(2, 2, 2)) + e0[1]).cwiseQuotient(RGBf(3, 3, 3))), asRGB565 ? RGB565::Max : XRGB1555::Max);
     e0[3] = RGBf::roundTo(RGBf((e0[0] + e0[1].cwiseProduct(RGBf(2, 2, 2))).cwiseQuotient(RGBf(3, 3, 3))), asRGB565 ? RGB565::Max : XRGB1555::Max);
     // get colors c0 and c1 on line
-    std::vector<RGBf> e1(4);
+    Endpoints e1;
     e1[0] = e0[0];
     e1[1] = e0[1];
     // calculate intermediate color c3 at 1/2 and add black
@@ -53,7 +57,8 @@ auto dxtLineFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std::pa
     return {e0, e1};
 }
 
-auto calculateError(const std::vector<RGBf> &endpoints, const std::vector<RGBf> &colors) -> float
+template <std::size_t N>
+auto calculateError(const Endpoints &endpoints, const std::array<RGBf, N> &colors) -> float
 {
     // calculate minimum distance for all colors to endpoints and calculate error to that endpoint
     float error = 0.0F;
@@ -81,7 +86,8 @@ constexpr float LineFitMinC0C1Error = 0.01F;
 
 // Heuristically fit colors to two color endpoints and their 1/3 and 2/3 or 1/2 intermediate points
 // Improves PSNR about 1-2 dB
-auto dxtClusterFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std::pair<std::vector<RGBf>, bool>
+template <std::size_t N>
+auto dxtClusterFit(const std::array<RGBf, N> &colors, const bool asRGB565) -> std::pair<Endpoints, bool>
 {
     // calculate initial line fit through RGB color space
     auto guess = dxtLineFit(colors, asRGB565);
@@ -93,7 +99,7 @@ auto dxtClusterFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std:
     auto bestErrorThird = calculateError(guess.first, colors);
     auto bestErrorHalf = calculateError(guess.second, colors);
     bool isModeThird = bestErrorThird < bestErrorHalf;
-    std::vector<RGBf> endpoints = isModeThird ? guess.first : guess.second;
+    Endpoints endpoints = isModeThird ? guess.first : guess.second;
     auto bestError = isModeThird ? bestErrorThird : bestErrorHalf;
     // return if the error is already optimal
     if (bestError <= ClusterFitMinDxtError)
@@ -103,11 +109,13 @@ auto dxtClusterFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std:
     // do some rounds of k-means clustering for 1/3, 2/3 mode, then 1/2 mode
     for (int mode = 0; mode < 2; ++mode)
     {
-        std::vector<RGBf> centroids = mode == 0 ? guess.first : guess.second;
+        Endpoints centroids = mode == 0 ? guess.first : guess.second;
         for (int iteration = 0; iteration < ClusterFitMaxIterations; ++iteration)
         {
             float iterationError = 0.0F;
-            std::vector<std::vector<RGBf>> clusters(centroids.size());
+            // only the sums of clusters c0 and c1 are needed to update the centroids, so we do not store the points
+            std::array<RGBf, 2> clusterSums = {RGBf(0, 0, 0), RGBf(0, 0, 0)};
+            std::array<uint32_t, 2> clusterSizes = {0, 0};
             for (const auto &point : colors)
             {
                 float minError = std::numeric_limits<float>::max();
@@ -121,19 +129,18 @@ auto dxtClusterFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std:
                         closestCentroid = i;
                     }
                 }
-                REQUIRE(closestCentroid >= 0 && closestCentroid < clusters.size(), std::runtime_error, "Bad cluster index");
-                clusters[closestCentroid].push_back(point);
+                REQUIRE(closestCentroid >= 0 && closestCentroid < centroids.size(), std::runtime_error, "Bad cluster index");
+                if (closestCentroid < 2)
+                {
+                    clusterSums[closestCentroid] += point;
+                    ++clusterSizes[closestCentroid];
+                }
                 iterationError += minError;
             }
             // update centroids of cluster c0 and c1 defining the line
             for (int i = 0; i < 2; ++i)
             {
-                auto sum = RGBf(0, 0, 0);
-                for (const auto &point : clusters[i])
-                {
-                    sum += point;
-                }
-                centroids[i] = RGBf::roundTo(sum / (double)clusters[i].size(), asRGB565 ? RGB565::Max : XRGB1555::Max);
+                centroids[i] = RGBf::roundTo(clusterSums[i] / (double)clusterSizes[i], asRGB565 ? RGB565::Max : XRGB1555::Max);
             }
             if (mode == 0)
             {
@@ -162,12 +169,12 @@ auto dxtClusterFit(const std::vector<RGBf> &colors, const bool asRGB565) -> std:
 // ------------------------------------------------------------------------------------------------
 
 template <unsigned BLOCK_DIM>
-auto encodeBlockInternal(const XRGB8888 *blockStart, const uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> std::vector<uint8_t>
+auto encodeBlockInternal(const XRGB8888 *blockStart, const uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> std::array<uint8_t, DXT::BlockSize<BLOCK_DIM>>
 {
     REQUIRE(pixelsPerScanline % BLOCK_DIM == 0, std::runtime_error, "Image width must be a multiple of " << BLOCK_DIM << " for DXT compression");
     // get block colors for all pixels
     constexpr unsigned NrOfPixels = BLOCK_DIM * BLOCK_DIM;
-    std::vector<RGBf> colors(NrOfPixels);
+    std::array<RGBf, NrOfPixels> colors;
     auto cIt = colors.begin();
     auto pixels = blockStart;
     for (int y = 0; y < BLOCK_DIM; y++)
@@ -183,7 +190,7 @@ auto encodeBlockInternal(const XRGB8888 *blockStart, const uint32_t pixelsPerSca
 #else
     auto guess = dxtLineFit(colors, asRGB565);
     bool isModeThird;
-    std::vector<RGBf> endpoints;
+    Endpoints endpoints;
     if (RGBf::mse(guess.second[0], guess.second[1]) <= LineFitMinC0C1Error)
     {
         // if colors are almost identical, use 1/2 mode and second set of endpoints
@@ -200,7 +207,7 @@ auto encodeBlockInternal(const XRGB8888 *blockStart, const uint32_t pixelsPerSca
     }
 #endif
     // calculate minimum distance for all colors to endpoints to assign indices
-    std::vector<uint32_t> endpointIndices(NrOfPixels);
+    std::array<uint32_t, NrOfPixels> endpointIndices;
     for (uint32_t ci = 0; ci < NrOfPixels; ++ci)
     {
         // calculate minimum distance for each index for this color
@@ -251,7 +258,7 @@ auto encodeBlockInternal(const XRGB8888 *blockStart, const uint32_t pixelsPerSca
         }
     }
     // build result data
-    std::vector<uint8_t> result(2 * 2 + NrOfPixels * 2 / 8);
+    std::array<uint8_t, DXT::BlockSize<BLOCK_DIM>> result;
     // add color endpoints c0 and c1
     auto data16 = reinterpret_cast<uint16_t *>(result.data());
     *data16++ = c0;
@@ -274,6 +281,13 @@ template <>
 auto DXT::encodeBlock<4>(const std::vector<Color::XRGB8888> &block, const bool asRGB565, const bool swapToBGR) -> std::vector<uint8_t>
 {
     REQUIRE(block.size() == 16, std::runtime_error, "Number of pixels in block must be 16");
+    const auto result = encodeBlockInternal<4>(block.data(), 4, asRGB565, swapToBGR);
+    return std::vector<uint8_t>(result.cbegin(), result.cend());
+}
+
+template <>
+auto DXT::encodeBlock<4>(const std::array<Color::XRGB8888, 16> &block, const bool asRGB565, const bool swapToBGR) -> std::array<uint8_t, BlockSize<4>>
+{
     return encodeBlockInternal<4>(block.data(), 4, asRGB565, swapToBGR);
 }
 
@@ -281,6 +295,13 @@ template <>
 auto DXT::encodeBlock<8>(const std::vector<Color::XRGB8888> &block, const bool asRGB565, const bool swapToBGR) -> std::vector<uint8_t>
 {
     REQUIRE(block.size() == 64, std::runtime_error, "Number of pixels in block must be 64");
+    const auto result = encodeBlockInternal<8>(block.data(), 8, asRGB565, swapToBGR);
+    return std::vector<uint8_t>(result.cbegin(), result.cend());
+}
+
+template <>
+auto DXT::encodeBlock<8>(const std::array<Color::XRGB8888, 64> &block, const bool asRGB565, const bool swapToBGR) -> std::array<uint8_t, BlockSize<8>>
+{
     return encodeBlockInternal<8>(block.data(), 8, asRGB565, swapToBGR);
 }
 
@@ -288,6 +309,13 @@ template <>
 auto DXT::encodeBlock<16>(const std::vector<Color::XRGB8888> &block, const bool asRGB565, const bool swapToBGR) -> std::vector<uint8_t>
 {
     REQUIRE(block.size() == 256, std::runtime_error, "Number of pixels in block must be 256");
+    const auto result = encodeBlockInternal<16>(block.data(), 16, asRGB565, swapToBGR);
+    return std::vector<uint8_t>(result.cbegin(), result.cend());
+}
+
+template <>
+auto DXT::encodeBlock<16>(const std::array<Color::XRGB8888, 256> &block, const bool asRGB565, const bool swapToBGR) -> std::array<uint8_t, BlockSize<16>>
+{
     return encodeBlockInternal<16>(block.data(), 16, asRGB565, swapToBGR);
 }
 
@@ -413,6 +441,14 @@ auto DXT::decodeBlock<4>(const std::vector<uint8_t> &data, const bool asRGB565,
     return block;
 }
 
+template <>
+auto DXT::decodeBlock<4>(const std::array<uint8_t, BlockSize<4>> &data, const bool asRGB565, const bool swapToBGR) -> std::array<Color::XRGB8888, 16>
+{
+    std::array<Color::XRGB8888, 16> block;
+    decodeBlockInternal<4>(reinterpret_cast<const uint16_t *>(data.data()), reinterpret_cast<const uint16_t *>(data.data() + 4), block.data(), 4, asRGB565, swapToBGR);
+    return block;
+}
+
 template <>
 auto DXT::decodeBlock<8>(const std::vector<uint8_t> &data, const bool asRGB565, const bool swapToBGR) -> std::vector<Color::XRGB8888>
 {
@@ -422,6 +458,14 @@ auto DXT::decodeBlock<8>(const std::vector<uint8_t> &data, const bool asRGB565,
     return block;
 }
 
+template <>
+auto DXT::decodeBlock<8>(const std::array<uint8_t, BlockSize<8>> &data, const bool asRGB565, const bool swapToBGR) -> std::array<Color::XRGB8888, 64>
+{
+    std::array<Color::XRGB8888, 64> block;
+    decodeBlockInternal<8>(reinterpret_cast<const uint16_t *>(data.data()), reinterpret_cast<const uint16_t *>(data.data() + 4), block.data(), 8, asRGB565, swapToBGR);
+    return block;
+}
+
 template <>
 auto DXT::decodeBlock<16>(const std::vector<uint8_t> &data, const bool asRGB565, const bool swapToBGR) -> std::vector<Color::XRGB8888>
 {
@@ -431,6 +475,32 @@ auto DXT::decodeBlock<16>(const std::vector<uint8_t> &data, const bool asRGB565,
     return block;
 }
 
+template <>
+auto DXT::decodeBlock<16>(const std::array<uint8_t, BlockSize<16>> &data, const bool asRGB565, const bool swapToBGR) -> std::array<Color::XRGB8888, 256>
+{
+    std::array<Color::XRGB8888, 256> block;
+    decodeBlockInternal<16>(reinterpret_cast<const uint16_t *>(data.data()), reinterpret_cast<const uint16_t *>(data.data() + 4), block.data(), 16, asRGB565, swapToBGR);
+    return block;
+}
+
+template <>
+auto DXT::decodeBlock<4>(const uint16_t *data, Color::XRGB8888 *dst, uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> void
+{
+    decodeBlockInternal<4>(data, data + 2, dst, pixelsPerScanline, asRGB565, swapToBGR);
+}
+
+template <>
+auto DXT::decodeBlock<8>(const uint16_t *data, Color::XRGB8888 *dst, uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> void
+{
+    decodeBlockInternal<8>(data, data + 2, dst, pixelsPerScanline, asRGB565, swapToBGR);
+}
+
+template <>
+auto DXT::decodeBlock<16>(const uint16_t *data, Color::XRGB8888 *dst, uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> void
+{
+    decodeBlockInternal<16>(data, data + 2, dst, pixelsPerScanline, asRGB565, swapToBGR);
+}
+
 auto DXT::decode(const std::vector<uint8_t> &data, const uint32_t width, const uint32_t height, const bool asRGB565, const bool swapToBGR) -> std::vector<XRGB8888>
 {
     REQUIRE(width % 4 == 0, std::runtime_error, "Image width must be a multiple of 4 for DXT decompression");
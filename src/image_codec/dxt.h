@@ -3,12 +3,17 @@
 #include "color/xrgb8888.h"
 #include "if/dxt_tables.h"
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
 class DXT
 {
 public:
+    /// @brief Size of a compressed DXT block of BLOCK_DIM x BLOCK_DIM pixels in bytes
+    template <unsigned BLOCK_DIM>
+    static constexpr std::size_t BlockSize = 2 * 2 + BLOCK_DIM * BLOCK_DIM * 2 / 8;
+
     /// @brief Get DXT colors from source, calculate intermediate colors and write to colors array
     /// @param data Pointer to start of DXT block data
     /// @param colors Pointer to an array of the 4 DXT block BGR555 colors. Must be word-aligned!
@@ -48,6 +53,10 @@ public:
     template <unsigned BLOCK_DIM>
     static auto encodeBlock(const std::vector<Color::XRGB8888> &block, const bool asRGB565, const bool swapToBGR) -> std::vector<uint8_t>;
 
+    /// @brief Compress 4x4, 8x8 or 16x16 block of image data to format similar to DXT1. Does not allocate heap memory
+    template <unsigned BLOCK_DIM>
+    static auto encodeBlock(const std::array<Color::XRGB8888, BLOCK_DIM * BLOCK_DIM> &block, const bool asRGB565, const bool swapToBGR) -> std::array<uint8_t, BlockSize<BLOCK_DIM>>;
+
     /// @brief Compress image data to format similar to DXT1. See: https://www.khronos.org/opengl/wiki/S3_Texture_Compression#DXT1_Format
     /// DXT1 compresses one 4x4 block to 2 bytes color0, 2 bytes color1 and 16*2 bit = 4 bytes index information
     /// Colors can be stored as XRGB1555, XBGR1555, RGB565 or BGR565
@@ -57,6 +66,17 @@ public:
     template <unsigned BLOCK_DIM>
     static auto decodeBlock(const std::vector<uint8_t> &data, const bool asRGB565, const bool swapToBGR) -> std::vector<Color::XRGB8888>;
 
+    /// @brief Decompress 4x4, 8x8 or 16x16 block of DXT data. Does not allocate heap memory
+    template <unsigned BLOCK_DIM>
+    static auto decodeBlock(const std::array<uint8_t, BlockSize<BLOCK_DIM>> &data, const bool asRGB565, const bool swapToBGR) -> std::array<Color::XRGB8888, BLOCK_DIM * BLOCK_DIM>;
+
+    /// @brief Decompress 4x4, 8x8 or 16x16 block of DXT data directly into an image. Does not allocate heap memory
+    /// @param data Pointer to start of DXT block data (2 colors followed by indices)
+    /// @param dst Pointer to the upper-left pixel of the block in the destination image
+    /// @param pixelsPerScanline Width of the destination image in pixels
+    template <unsigned BLOCK_DIM>
+    static auto decodeBlock(const uint16_t *data, Color::XRGB8888 *dst, uint32_t pixelsPerScanline, const bool asRGB565, const bool swapToBGR) -> void;
+
     /// @brief Decompress image from DXT data
     static auto decode(const std::vector<uint8_t> &data, uint32_t width, uint32_t height, bool asRGB565 = false, const bool swapToBGR = false) -> std::vector<Color::XRGB8888>;
 };
@@ -66,9 +66,12 @@ bool readArguments(int argc, const char *argv[])
         opts.add_option("", options.interleavePixels.cxxOption);
         opts.add_option("", options.dxt.cxxOption);
         // opts.add_option("", options.rle.cxxOption);
+        opts.add_option("", options.huffman.cxxOption);
         opts.add_option("", options.lz4.cxxOption);
         opts.add_option("", options.lz10.cxxOption);
+        opts.add_option("", options.chunks.cxxOption);
         opts.add_option("", options.vram.cxxOption);
+        opts.add_option("", options.lzOptimal.cxxOption);
         opts.add_option("", options.binary.cxxOption);
         opts.add_option("", options.dumpImage.cxxOption);
         opts.add_option("", options.dryRun.cxxOption);
@@ -147,11 +150,18 @@ bool readArguments(int argc, const char *argv[])
         options.sprites.parse(result);
         options.tilemap.parse(result);
         options.commonTilemap.parse(result);
+        options.huffman.parse(result);
+        options.chunks.parse(result);
         if ((options.tilemap + options.commonTilemap) > 1)
         {
             std::cerr << "Only a single tilemap option is allowed." << std::endl;
             return false;
         }
+        if (options.chunks && !options.lz4 && !options.lz10)
+        {
+            std::cerr << "Chunked compression needs LZ4 and / or LZ10 compression." << std::endl;
+            return false;
+        }
         // if tilemap is set, also set tiles
         if (options.tilemap || options.commonTilemap)
         {
@@ -199,10 +209,13 @@ void printUsage()
     std::cout << options.dxt.helpString() << std::endl;
     std::cout << "COMPRESS options (mutually exclusive):" << std::endl;
     // std::cout << options.rle.helpString() << std::endl;
+    std::cout << options.huffman.helpString() << std::endl;
     std::cout << options.lz4.helpString() << std::endl;
     std::cout << options.lz10.helpString() << std::endl;
+    std::cout << options.chunks.helpString() << std::endl;
     std::cout << "COMPRESS modifiers (optional):" << std::endl;
     std::cout << options.vram.helpString() << std::endl;
+    std::cout << options.lzOptimal.helpString() << std::endl;
     std::cout << "Valid combinations are e.g. \"--rle --lz10\"." << std::endl;
     std::cout << "INFILE: can be a file list and/or can have * as a wildcard. Multiple input " << std::endl;
     std::cout << "images MUST have the same type (palette / true color) and resolution!" << std::endl;
@@ -216,7 +229,7 @@ void printUsage()
     std::cout << options.dryRun.helpString() << std::endl;
     std::cout << "help: Show this help." << std::endl;
     std::cout << "ORDER: INPUT, reordercolors, addcolor0, movecolor0, shift, sprites, tiles," << std::endl;
-    std::cout << "tilemap / commontilemap, prune, dumpimage, delta8 / delta16, rle, lz10," << std::endl;
+    std::cout << "tilemap / commontilemap, prune, dumpimage, delta8 / delta16, rle, huffman, lz10 / chunks," << std::endl;
     std::cout << "interleavepixels, OUTPUT" << std::endl;
 }
 
@@ -419,13 +432,25 @@ int main(int argc, const char *argv[])
         {
             processing.addStep(Image::ProcessingType::CompressRLE);
         }*/
-        if (options.lz4)
+        if (options.huffman)
+        {
+            processing.addStep(Image::ProcessingType::CompressHuffman_20, {options.huffman.value});
+        }
+        if (options.chunks)
         {
-            processing.addStep(Image::ProcessingType::CompressLZ4_40, {options.vram.isSet});
+            // compress chunks with the compressors passed. the best one is picked per chunk
+            processing.addStep(Image::ProcessingType::CompressChunked, {options.vram.isSet, options.lzOptimal.isSet, options.lz4.isSet, options.lz10.isSet, options.chunks.value});
         }
-        if (options.lz10)
+        else
         {
-            processing.addStep(Image::ProcessingType::CompressLZSS_10, {options.vram.isSet});
+            if (options.lz4)
+            {
+                processing.addStep(Image::ProcessingType::CompressLZ4_40, {options.vram.isSet, options.lzOptimal.isSet});
+            }
+            if (options.lz10)
+            {
+                processing.addStep(Image::ProcessingType::CompressLZSS_10, {options.vram.isSet, options.lzOptimal.isSet});
+            }
         }
         processing.addStep(Image::ProcessingType::PadPixelData, {uint32_t(4)}, {});
         // apply image processing pipeline
@@ -321,19 +321,26 @@ namespace IO::Vid2h
     }
 
     auto readFrame(std::istream &is) -> std::pair<IO::FrameType, std::vector<uint8_t>>
+    {
+        std::vector<uint8_t> frameData;
+        const auto frameType = readFrame(is, frameData);
+        return {frameType, frameData};
+    }
+
+    auto readFrame(std::istream &is, std::vector<uint8_t> &frameData) -> IO::FrameType
     {
         // check if we're at the end of the file
         if (is.eof() || is.peek() == std::istream::traits_type::eof())
         {
-            return {IO::FrameType::Unknown, {}};
+            frameData.clear();
+            return IO::FrameType::Unknown;
         }
         // read frame header
         static_assert(sizeof(FrameHeader) % 4 == 0);
         FrameHeader frameHeader;
         is.read(reinterpret_cast<char *>(&frameHeader), sizeof(FrameHeader));
         REQUIRE(!is.fail(), std::runtime_error, "Failed to read frame header from stream");
-        // allocate memory
-        std::vector<uint8_t> frameData;
+        // allocate memory if needed
         frameData.resize(frameHeader.dataSize);
         // read data
         is.read(reinterpret_cast<char *>(frameData.data()), frameData.size());
@@ -353,7 +360,7 @@ namespace IO::Vid2h
                 THROW(std::runtime_error, "Got bad data type " << static_cast<uint32_t>(frameHeader.dataType) << " from stream");
             }
         }
-        return {IO::FrameType(frameHeader.dataType), frameData};
+        return IO::FrameType(frameHeader.dataType);
     }
 
     auto readMetaData(std::istream &is, const FileDataInfo &fileDataInfo) -> std::vector<uint8_t>
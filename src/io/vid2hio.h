@@ -90,6 +90,10 @@ namespace IO::Vid2h
     /// @brief Read frame data from input stream
     auto readFrame(std::istream &is) -> std::pair<IO::FrameType, std::vector<uint8_t>>;
 
+    /// @brief Read frame data from input stream into frameData. Reuses the memory of frameData, so it does not allocate if frameData is big enough
+    /// @return Frame type read or FrameType::Unknown and empty frameData if EOF
+    auto readFrame(std::istream &is, std::vector<uint8_t> &frameData) -> IO::FrameType;
+
     /// @brief Read meta data from end of stream
     auto readMetaData(std::istream &is, const FileDataInfo &fileHeaderInfo) -> std::vector<uint8_t>;
 }
@@ -7,7 +7,6 @@
 #include "compression/lzss.h"
 #include "if/audio_processingtype.h"
 #include "if/image_processingtype.h"
-#include "video_codec/dxtv.h"
 
 namespace Media
 {
@@ -87,6 +86,8 @@ namespace Media
             m_info.videoHeight = m_videoHeader.height;
             m_info.videoPixelFormat = Color::findFormat(m_videoHeader.bitsPerPixel, m_videoHeader.colorMapEntries != 0, m_videoHeader.swappedRedBlue);
             m_info.videoColorMapFormat = Color::findFormat(m_videoHeader.bitsPerColor, false, m_videoHeader.swappedRedBlue);
+            const std::vector<Image::ProcessingType> videoProcessing(std::begin(m_videoHeader.processing), std::end(m_videoHeader.processing));
+            m_videoDecoder = Video::FrameDecoder(videoProcessing, m_videoHeader.width, m_videoHeader.height, m_info.videoPixelFormat, m_videoHeader.swappedRedBlue != 0);
         }
         if (m_fileDataInfo.contentType & IO::FileType::Subtitles)
         {
@@ -116,60 +117,26 @@ namespace Media
     auto Vid2hReader::readFrame() -> FrameData
     {
         REQUIRE(m_is.is_open() && !m_is.fail(), std::runtime_error, "File stream not open");
-        auto frame = IO::Vid2h::readFrame(m_is);
-        if (frame.first == IO::FrameType::Pixels)
+        const auto frameType = IO::Vid2h::readFrame(m_is, m_frameData);
+        if (frameType == IO::FrameType::Pixels)
         {
-            auto inData = frame.second;
-            REQUIRE(!inData.empty(), std::runtime_error, "Frame pixel data empty");
-            std::vector<Color::XRGB8888> outData;
-            // do decoding steps
-            for (uint32_t pi = 0; pi < sizeof(m_videoHeader.processing); ++pi)
-            {
-                // this is the final operation either if we don't have any more steps, the current step is just a copy, or the next step is invalid
-                const auto processingType = m_videoHeader.processing[pi] == Image::ProcessingType::Invalid ? Image::ProcessingType::Uncompressed : m_videoHeader.processing[pi];
-                const auto isFinal = (pi >= 3) || (processingType == Image::ProcessingType::Uncompressed) || (m_videoHeader.processing[pi + 1] == Image::ProcessingType::Invalid);
-                // reverse processing operation used in this stage
-                switch (processingType)
-                {
-                case Image::ProcessingType::CompressLZ4_40:
-                    inData = Compression::decodeLZ4_40(inData);
-                    break;
-                case Image::ProcessingType::CompressLZSS_10:
-                    inData = Compression::decodeLZSS_10(inData);
-                    break;
-                case Image::ProcessingType::CompressDXTV:
-                    outData = Video::Dxtv::decode(inData, m_previousPixels, m_videoHeader.width, m_videoHeader.height, m_videoHeader.swappedRedBlue);
-                    break;
-                default:
-                    THROW(std::runtime_error, "Unsupported processing type " << static_cast<uint32_t>(processingType));
-                }
-                // break if this was the last processing operation
-                if (isFinal)
-                {
-                    break;
-                }
-            }
-            // return color data or convert pixel data to XRGB8888
-            if (outData.empty())
-            {
-                outData = ColorHelpers::toXRGB8888(inData, m_info.videoPixelFormat, m_previousColorMap);
-            }
-            m_previousPixels = outData;
-            return {IO::FrameType::Pixels, 0.0, outData};
+            REQUIRE(!m_frameData.empty(), std::runtime_error, "Frame pixel data empty");
+            // decode to internal buffers and return a copy of the pixels
+            return {IO::FrameType::Pixels, 0.0, m_videoDecoder.decode(m_frameData.data(), m_frameData.size(), m_previousColorMap)};
         }
-        else if (frame.first == IO::FrameType::Colormap)
+        else if (frameType == IO::FrameType::Colormap)
         {
             // convert color map to XRGB8888
-            REQUIRE(!frame.second.empty(), std::runtime_error, "Frame color map data empty");
+            REQUIRE(!m_frameData.empty(), std::runtime_error, "Frame color map data empty");
             REQUIRE(m_info.videoColorMapFormat != Color::Format::Unknown, std::runtime_error, "Bad color map format");
             std::vector<Color::XRGB8888> outColorMap;
-            outColorMap = ColorHelpers::toXRGB8888(frame.second, m_info.videoColorMapFormat);
+            outColorMap = ColorHelpers::toXRGB8888(m_frameData, m_info.videoColorMapFormat);
             m_previousColorMap = outColorMap;
             return {IO::FrameType::Colormap, 0.0, outColorMap};
         }
-        else if (frame.first == IO::FrameType::Audio)
+        else if (frameType == IO::FrameType::Audio)
         {
-            auto inData = frame.second;
+            auto inData = m_frameData;
             REQUIRE(!inData.empty(), std::runtime_error, "Frame audio data empty");
             std::vector<int16_t> outData;
             // do decoding steps
@@ -187,6 +154,10 @@ namespace Media
                 case Audio::ProcessingType::CompressLZ4_40:
                     inData = Compression::decodeLZ4_40(inData);
                     break;
+                case Audio::ProcessingType::CompressLZ4Dictionary_40:
+                    inData = Compression::decodeLZ4_40(inData, m_audioDictionary);
+                    m_audioDictionary = inData;
+                    break;
                 case Audio::ProcessingType::CompressLZSS_10:
                     inData = Compression::decodeLZSS_10(inData);
                     break;
@@ -204,9 +175,9 @@ namespace Media
             }
             return {IO::FrameType::Audio, 0.0, outData};
         }
-        else if (frame.first == IO::FrameType::Subtitles)
+        else if (frameType == IO::FrameType::Subtitles)
         {
-            auto inData = frame.second;
+            auto inData = m_frameData;
             REQUIRE(inData.size() > (4 + 4 + 1), std::runtime_error, "Subtitles frame data too small");
             Subtitles::RawData outData;
             outData.startTimeS = static_cast<double>(*reinterpret_cast<int32_t *>(inData.data() + 0)) / 65536.0;
@@ -2,6 +2,7 @@
 
 #include "vid2hio.h"
 #include "mediareader.h"
+#include "video_codec/framedecoder.h"
 
 #include <cstdint>
 #include <fstream>
@@ -46,8 +47,10 @@ namespace Media
         IO::Vid2h::SubtitlesHeader m_subtitlesHeader;
         std::vector<uint8_t> m_metaData;
         std::vector<uint8_t> m_previousAudio;
-        std::vector<Color::XRGB8888> m_previousPixels;
+        std::vector<uint8_t> m_frameData; // Raw frame data read from file. Reused between frames
         std::vector<Color::XRGB8888> m_previousColorMap;
+        Video::FrameDecoder m_videoDecoder; // Decodes video frames into buffers reused between frames
+        std::vector<uint8_t> m_audioDictionary;
         std::ifstream m_is;
     };
 
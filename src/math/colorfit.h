@@ -1,10 +1,13 @@
 #pragma once
 
 #include "boundingbox.h"
+#include "color/cielabf.h"
 #include "color/colorhelpers.h"
+#include "color/conversions.h"
 #include "color/gamma.h"
 #include "exception.h"
 #include "math/histogram.h"
+#include "math/kdtree.h"
 #include "math/kmeans.h"
 #include "statistics/csvio.h"
 
@@ -37,7 +40,7 @@ public:
     /// @brief Construct color fit object
     /// @param colorSpace All colors of targrt color space as sRGB colors
     ColorFit(const std::vector<PIXEL_TYPE> &colorSpace)
-        : m_colorSpace(colorSpace), m_colorSpaceLinear(Color::convertTo<COLOR_TYPE>(Color::srgbToLinear(colorSpace)))
+        : m_colorSpace(colorSpace), m_colorSpaceLinear(Color::convertTo<COLOR_TYPE>(Color::srgbToLinear(colorSpace))), m_colorSpaceTree(m_colorSpaceLinear)
     {
     }
 
@@ -58,7 +61,7 @@ public:
     {
         REQUIRE(nrOfColors > 1 && nrOfColors <= 256, std::runtime_error, "Bad number of colors. Must be in range [2,256]");
         // std::cout << "Building histogram..." << std::endl;
-        const std::map<PIXEL_TYPE, uint64_t> colorHistogram = Histogram::buildHistogram(pixels);
+        const std::vector<std::pair<PIXEL_TYPE, uint64_t>> colorHistogram = Histogram::buildFlatHistogram(pixels);
         // check if we already have enough colors
         if (colorHistogram.size() <= nrOfColors)
         {
@@ -78,40 +81,12 @@ public:
         {
             linearColors.push_back({color.first, Color::convertTo<COLOR_TYPE>(Color::srgbToLinear(color.first))});
         }
-        // ---------- Maximin initialization ----------
-        // calculate bounding box of data
-        BoundingBox<COLOR_TYPE> colorBounds(linearColors.front().second);
-        std::for_each(linearColors.cbegin(), linearColors.cend(), [&colorBounds](auto c)
-                      { colorBounds |= c.second; });
-        // start with cluster center in the middle
-        std::vector<Cluster> clusters;
-        clusters.push_back(Cluster{0.5F * (colorBounds.min() + colorBounds.max()), 0, {}});
-        // calculate additional cluster centers using Maximin initialization method
-        std::vector<float> objectClosestCenterDistance(linearColors.size(), std::numeric_limits<float>::max()); // this is the distance to the closest cluster center yet encountered for this object
-        for (std::size_t ci = 1; ci < nrOfColors; ++ci)
-        {
-            const auto prevClusterCenter = clusters.back().center;
-            auto maxDistanceColor = linearColors.front().second;
-            auto maxDistanceToCenter = std::numeric_limits<float>::lowest();
-            // #pragma omp parallel for
-            for (int oi = 0; oi < static_cast<int>(linearColors.size()); oi++)
-            {
-                const auto &color = linearColors.at(oi);
-                const auto distanceToPrevCenter = COLOR_TYPE::mse(color.second, prevClusterCenter);
-                if (distanceToPrevCenter < objectClosestCenterDistance.at(oi))
-                {
-                    objectClosestCenterDistance.at(oi) = distanceToPrevCenter;
-                }
-                // #pragma omp critical
-                if (maxDistanceToCenter < objectClosestCenterDistance.at(oi))
-                {
-                    maxDistanceToCenter = objectClosestCenterDistance.at(oi);
-                    maxDistanceColor = color.second;
-                }
-            }
-            clusters.push_back(Cluster{maxDistanceColor, 0, {}});
-        }
-        REQUIRE(clusters.size() == nrOfColors, std::runtime_error, "Failed build expected number of clusters");
+        // initialize cluster centers using Maximin initialization method
+        std::vector<COLOR_TYPE> linearColorPositions;
+        linearColorPositions.reserve(linearColors.size());
+        std::transform(linearColors.cbegin(), linearColors.cend(), std::back_inserter(linearColorPositions), [](const auto &color)
+                       { return color.second; });
+        auto clusters = Kmeans::initMaximin<Cluster>(linearColorPositions, nrOfColors);
         // run Online-k-means
         Kmeans::onlineKmeans(clusters, linearPixels, LearnRateExponent);
         // snap all cluster centers to color space
@@ -121,34 +96,27 @@ public:
             auto &cluster = clusters.at(ci);
             if (!m_colorSpaceLinear.empty())
             {
-                cluster.center = ColorHelpers::getClosestColor(cluster.center, m_colorSpaceLinear);
+                cluster.center = m_colorSpaceLinear[m_colorSpaceTree.closestIndex(cluster.center)];
             }
         }
         // run Online-k-means again to improve result
         Kmeans::onlineKmeans(clusters, linearPixels, LearnRateExponent);
         // add colors to closest cluster
+        std::vector<COLOR_TYPE> clusterCenters;
+        clusterCenters.reserve(clusters.size());
+        std::transform(clusters.cbegin(), clusters.cend(), std::back_inserter(clusterCenters), [](const auto &cluster)
+                       { return cluster.center; });
+        const KdTree<COLOR_TYPE> clusterTree(clusterCenters);
+        // find closest cluster centers in parallel, then add colors in input order, so the result does not depend on thread scheduling
+        std::vector<uint32_t> closestClusterIndices(linearColors.size());
 #pragma omp parallel for
         for (int ci = 0; ci < static_cast<int>(linearColors.size()); ci++)
         {
-            const auto &color = linearColors.at(ci);
-            // find closest cluster center
-            auto bestClusterIndex = std::numeric_limits<int>::max();
-            auto bestClusterDistance = std::numeric_limits<float>::max();
-            for (int clusterIndex = 0; clusterIndex < static_cast<int>(clusters.size()); clusterIndex++)
-            {
-                const auto distanceToCluster = COLOR_TYPE::mse(color.second, clusters.at(clusterIndex).center);
-                if (distanceToCluster < bestClusterDistance)
-                {
-                    bestClusterDistance = distanceToCluster;
-                    bestClusterIndex = clusterIndex;
-                }
-            }
-            // add object to cluster
-            auto &cluster = clusters.at(bestClusterIndex);
-#pragma omp critical
-            {
-                cluster.objects.push_back(color.first);
-            }
+            closestClusterIndices[ci] = static_cast<uint32_t>(clusterTree.closestIndex(linearColors[ci].second));
+        }
+        for (std::size_t ci = 0; ci < linearColors.size(); ci++)
+        {
+            clusters[closestClusterIndices[ci]].objects.push_back(linearColors[ci].first);
         }
 #ifdef DUMP_STATS
         dumpToCSV(clusters, colorHistogram);
@@ -157,22 +125,8 @@ public:
         std::map<PIXEL_TYPE, std::vector<PIXEL_TYPE>> colorMapping;
         for (const auto &cluster : clusters)
         {
-            // find color in linearized color space map
-            auto closestColorIt = m_colorSpaceLinear.cend();
-            double closestDistance = std::numeric_limits<float>::max();
-            auto cIt = std::next(m_colorSpaceLinear.cbegin());
-            while (cIt != m_colorSpaceLinear.cend())
-            {
-                auto colorDistance = COLOR_TYPE::mse(*cIt, cluster.center);
-                if (closestDistance > colorDistance)
-                {
-                    closestDistance = colorDistance;
-                    closestColorIt = cIt;
-                }
-                ++cIt;
-            }
-            // get index in linear color space map
-            const auto colorSpaceIndex = std::distance(m_colorSpaceLinear.cbegin(), closestColorIt);
+            // find index of closest color in linearized color space
+            const auto colorSpaceIndex = m_colorSpaceTree.closestIndex(cluster.center);
             // use index to get original sRGB color space color
             const auto colorSpaceColor = m_colorSpace.at(colorSpaceIndex);
             // check which mapping to add colors to
@@ -196,7 +150,7 @@ public:
     }
 
 private:
-    static auto dumpToCSV(const std::vector<Cluster> &clusters, const std::map<PIXEL_TYPE, uint64_t> &colorHistogram) -> void
+    static auto dumpToCSV(const std::vector<Cluster> &clusters, const std::vector<std::pair<PIXEL_TYPE, uint64_t>> &colorHistogram) -> void
     {
         std::ofstream csvObjects("colorfit_objects.csv");
         IO::CSV::writeCSV(csvObjects, {"r", "g", "b", "csscolor", "clusterindex", "clustercolor"}, colorHistogram, [&clusters](decltype(*colorHistogram.cbegin()) o, std::size_t index)
@@ -256,4 +210,5 @@ private:
 
     const std::vector<PIXEL_TYPE> m_colorSpace;       // The sRGB color space passed in constructor
     const std::vector<COLOR_TYPE> m_colorSpaceLinear; // The color space color linearized to linearized sRGB
+    const KdTree<COLOR_TYPE> m_colorSpaceTree;        // Tree for closest color queries in linearized color space
 };
@@ -2,21 +2,190 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <numeric>
+#include <utility>
 #include <vector>
 #include <limits>
 
 namespace Histogram
 {
 
+    /// @brief Histogram stored in flat arrays instead of tree nodes.
+    /// Values with a size of up to 16 bits (e.g. uint8_t, uint16_t, XRGB1555, RGB565) are counted in a direct table indexed by their raw value.
+    /// All other values are counted in an open-addressing hash table with linear probing using std::hash<T>
+    template <typename T, typename F = uint64_t>
+    class FlatHistogram
+    {
+        static constexpr bool IsDirect = sizeof(T) <= 2;
+        static constexpr std::size_t InitialCapacity = 1 << 10;
+
+    public:
+        FlatHistogram()
+        {
+            if constexpr (IsDirect)
+            {
+                m_counts.resize(1 << 16, 0);
+            }
+            else
+            {
+                m_values.resize(InitialCapacity);
+                m_counts.resize(InitialCapacity, 0);
+            }
+        }
+
+        /// @brief Add count to value
+        auto add(const T &value, F count = 1) -> void
+        {
+            if constexpr (IsDirect)
+            {
+                auto &entry = m_counts[static_cast<uint16_t>(value)];
+                m_size += entry == 0 ? 1 : 0;
+                entry += count;
+            }
+            else
+            {
+                const auto index = find(m_values, m_counts, value);
+                if (m_counts[index] == 0)
+                {
+                    m_values[index] = value;
+                    m_counts[index] = count;
+                    // keep the load factor <= 0.5 so probe sequences stay short
+                    if (++m_size * 2 > m_counts.size())
+                    {
+                        grow();
+                    }
+                }
+                else
+                {
+                    m_counts[index] += count;
+                }
+            }
+        }
+
+        /// @brief Add all counts of other histogram to this histogram
+        auto merge(const FlatHistogram &other) -> void
+        {
+            for (std::size_t i = 0; i < other.m_counts.size(); ++i)
+            {
+                if (other.m_counts[i] != 0)
+                {
+                    add(other.value(i), other.m_counts[i]);
+                }
+            }
+        }
+
+        /// @brief Number of distinct values in histogram
+        auto size() const -> std::size_t
+        {
+            return m_size;
+        }
+
+        /// @brief Get values and their counts sorted by value using std::less<T>, like iterating a std::map<T, F>
+        auto entries() const -> std::vector<std::pair<T, F>>
+        {
+            std::vector<std::pair<T, F>> result;
+            result.reserve(m_size);
+            for (std::size_t i = 0; i < m_counts.size(); ++i)
+            {
+                if (m_counts[i] != 0)
+                {
+                    result.push_back({value(i), m_counts[i]});
+                }
+            }
+            std::sort(result.begin(), result.end(), [](const auto &a, const auto &b)
+                      { return std::less<T>()(a.first, b.first); });
+            return result;
+        }
+
+    private:
+        /// @brief Find index of value in hash table or of the empty entry it should be stored in
+        static auto find(const std::vector<T> &values, const std::vector<F> &counts, const T &value) -> std::size_t
+        {
+            // scramble hash, because std::hash is often the identity. The table size is a power of two
+            const uint64_t hash = static_cast<uint64_t>(std::hash<T>()(value)) * 0x9E3779B97F4A7C15ULL;
+            const std::size_t mask = counts.size() - 1;
+            auto index = static_cast<std::size_t>(hash >> 32) & mask;
+            while (counts[index] != 0 && !(values[index] == value))
+            {
+                index = (index + 1) & mask;
+            }
+            return index;
+        }
+
+        /// @brief Get value stored at index
+        auto value(std::size_t index) const -> T
+        {
+            if constexpr (IsDirect)
+            {
+                return T(static_cast<uint16_t>(index));
+            }
+            else
+            {
+                return m_values[index];
+            }
+        }
+
+        /// @brief Double hash table capacity and re-insert all values
+        auto grow() -> void
+        {
+            std::vector<T> values(m_values.size() * 2);
+            std::vector<F> counts(m_counts.size() * 2, 0);
+            for (std::size_t i = 0; i < m_counts.size(); ++i)
+            {
+                if (m_counts[i] != 0)
+                {
+                    const auto index = find(values, counts, m_values[i]);
+                    values[index] = m_values[i];
+                    counts[index] = m_counts[i];
+                }
+            }
+            std::swap(values, m_values);
+            std::swap(counts, m_counts);
+        }
+
+        std::vector<T> m_values; // Values in hash table. Empty for direct tables
+        std::vector<F> m_counts; // Counts of values. 0 if entry is empty
+        std::size_t m_size = 0;  // Number of distinct values
+    };
+
+    /// @brief Build histogram in parallel. Every thread counts its part of the data in its own FlatHistogram and these are merged at the end
+    /// @return Values and their counts sorted by value, like iterating the std::map buildHistogram returns
+    template <typename T, typename F = uint64_t>
+    auto buildFlatHistogram(const std::vector<T> &data) -> std::vector<std::pair<T, F>>
+    {
+        static constexpr std::size_t MinParallelSize = 1 << 16;
+        FlatHistogram<T, F> histogram;
+#pragma omp parallel if (data.size() >= MinParallelSize)
+        {
+            FlatHistogram<T, F> threadHistogram;
+#pragma omp for schedule(static) nowait
+            for (int64_t i = 0; i < static_cast<int64_t>(data.size()); ++i)
+            {
+                threadHistogram.add(data[i]);
+            }
+#pragma omp critical
+            {
+                if (histogram.size() == 0)
+                {
+                    histogram = std::move(threadHistogram);
+                }
+                else
+                {
+                    histogram.merge(threadHistogram);
+                }
+            }
+        }
+        return histogram.entries();
+    }
+
     template <typename T, typename F = uint64_t>
     auto buildHistogram(const std::vector<T> &data) -> std::map<T, F>
     {
-        std::map<T, F> histogram;
-        std::for_each(data.cbegin(), data.cend(), [&histogram](auto value)
-                      { histogram[value]++; });
-        return histogram;
+        // entries are sorted, so constructing the map is linear
+        const auto entries = buildFlatHistogram<T, F>(data);
+        return std::map<T, F>(entries.cbegin(), entries.cend());
     }
 
     template <typename T, typename F = uint64_t>
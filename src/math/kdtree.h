@@ -0,0 +1,146 @@
+#pragma once
+
+#include "boundingbox.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+/// @brief Static kd-tree for exact closest position queries, e.g. finding the closest color of a color space in CIELab.
+/// Distances are calculated using POSITION_TYPE::mse(), which must not decrease if the difference in any single axis increases.
+/// This holds for the Euclidean distance, the HyAB distance CIELabf uses and their squares. Because of this, the distance of the
+/// query position to its projection onto a splitting plane is a lower bound for the distance to all positions on the other side.
+/// Queries return the same result as a linear search with the same distance function, including ties, where the smallest index wins
+template <typename POSITION_TYPE>
+class KdTree
+{
+public:
+    KdTree() = default;
+
+    /// @brief Build kd-tree from positions. Positions are copied
+    explicit KdTree(const std::vector<POSITION_TYPE> &positions)
+    {
+        REQUIRE(positions.size() < std::numeric_limits<uint32_t>::max(), std::runtime_error, "Too many positions");
+        m_nodes.reserve(positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            m_nodes.push_back({positions[i], static_cast<uint32_t>(i), 0});
+        }
+        build(0, m_nodes.size());
+    }
+
+    /// @brief Number of positions in tree
+    auto size() const -> std::size_t
+    {
+        return m_nodes.size();
+    }
+
+    /// @brief Check if tree has no positions
+    auto empty() const -> bool
+    {
+        return m_nodes.empty();
+    }
+
+    /// @brief Find index of the position closest to position
+    /// @return Index of closest position in the positions passed to the constructor. If multiple positions have the same distance, the smallest index is returned
+    auto closestIndex(const POSITION_TYPE &position) const -> std::size_t
+    {
+        REQUIRE(!m_nodes.empty(), std::runtime_error, "Tree can not be empty");
+        float closestDistance = std::numeric_limits<float>::max();
+        uint32_t closestIndex = std::numeric_limits<uint32_t>::max();
+        search(0, m_nodes.size(), position, closestDistance, closestIndex);
+        return closestIndex;
+    }
+
+private:
+    /// @brief Position with its index in the input and the axis its subtree is split along
+    struct Node
+    {
+        POSITION_TYPE position;
+        uint32_t index = 0;
+        uint32_t axis = 0;
+    };
+
+    /// @brief Build balanced subtree in place. The range [begin, end) has its node in the middle, smaller positions on the axis before and bigger positions after it
+    auto build(std::size_t begin, std::size_t end) -> void
+    {
+        if (end - begin <= 1)
+        {
+            return;
+        }
+        // split along the axis with the largest extent
+        BoundingBox<POSITION_TYPE> bounds(m_nodes[begin].position);
+        std::for_each(std::next(m_nodes.cbegin(), begin + 1), std::next(m_nodes.cbegin(), end), [&bounds](const auto &node)
+                      { bounds |= node.position; });
+        uint32_t axis = 0;
+        float maxExtent = -1.0F;
+        for (uint32_t a = 0; a < POSITION_TYPE::Channels; ++a)
+        {
+            auto projected = bounds.min();
+            projected[a] = bounds.max()[a];
+            const auto extent = POSITION_TYPE::mse(bounds.min(), projected);
+            if (extent > maxExtent)
+            {
+                maxExtent = extent;
+                axis = a;
+            }
+        }
+        const auto middle = begin + (end - begin) / 2;
+        std::nth_element(std::next(m_nodes.begin(), begin), std::next(m_nodes.begin(), middle), std::next(m_nodes.begin(), end), [axis](const auto &a, const auto &b)
+                         { return a.position[axis] < b.position[axis]; });
+        m_nodes[middle].axis = axis;
+        build(begin, middle);
+        build(middle + 1, end);
+    }
+
+    /// @brief Search subtree [begin, end) for positions closer than closestDistance
+    auto search(std::size_t begin, std::size_t end, const POSITION_TYPE &position, float &closestDistance, uint32_t &closestIndex) const -> void
+    {
+        if (begin >= end)
+        {
+            return;
+        }
+        const auto middle = begin + (end - begin) / 2;
+        const auto &node = m_nodes[middle];
+        const auto distance = POSITION_TYPE::mse(node.position, position);
+        if (distance < closestDistance || (distance == closestDistance && node.index < closestIndex))
+        {
+            closestDistance = distance;
+            closestIndex = node.index;
+        }
+        if (end - begin == 1)
+        {
+            return;
+        }
+        // search the side of the splitting plane the position is on first
+        const auto axis = node.axis;
+        const bool isBefore = position[axis] < node.position[axis];
+        if (isBefore)
+        {
+            search(begin, middle, position, closestDistance, closestIndex);
+        }
+        else
+        {
+            search(middle + 1, end, position, closestDistance, closestIndex);
+        }
+        // search the other side if it can contain positions at least as close. Positions with equal distance must be visited for ties
+        auto projected = position;
+        projected[axis] = node.position[axis];
+        if (POSITION_TYPE::mse(projected, position) <= closestDistance)
+        {
+            if (isBefore)
+            {
+                search(middle + 1, end, position, closestDistance, closestIndex);
+            }
+            else
+            {
+                search(begin, middle, position, closestDistance, closestIndex);
+            }
+        }
+    }
+
+    std::vector<Node> m_nodes; // Nodes of implicit balanced tree
+};
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "boundingbox.h"
 #include "exception.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <numeric>
 #include <random>
 #include <vector>
 
@@ -12,11 +17,16 @@ namespace Kmeans
     /// See: Amber Abernathy, M. Emre Celebi 2022, The incremental online k-means clustering algorithm and its application to color quantization
     /// https://uca.edu/cse/files/2022/06/The_Incremental_Online_K_Means_Clustering_Algorithm_and_Its_Application_to_Color_Quantization.pdf
     /// https://github.com/AmberAbernathy/Color_Quantization
+    /// The distance of every position to its closest cluster center is kept, so every new cluster needs one parallel pass over all positions.
+    /// If multiple positions have the maximum distance, the one with the smallest index is used, so the result does not depend on the number of threads
     template <class CLUSTER_TYPE, class POSITION_TYPE>
     auto initMaximin(const std::vector<POSITION_TYPE> &positions, const std::size_t nrOfClusters) -> std::vector<CLUSTER_TYPE>
     {
+        static constexpr std::size_t MinParallelSize = 1 << 12;
         REQUIRE(nrOfClusters > 0, std::runtime_error, "Number of clusters must be > 0");
+        REQUIRE(!positions.empty(), std::runtime_error, "Positions can not be empty");
         std::vector<CLUSTER_TYPE> clusters;
+        clusters.reserve(nrOfClusters);
         // calculate bounding box of data
         BoundingBox<POSITION_TYPE> positionBounds(positions.front());
         std::for_each(positions.cbegin(), positions.cend(), [&positionBounds](auto p)
@@ -26,38 +36,59 @@ namespace Kmeans
         clusters.back().center = 0.5F * (positionBounds.min() + positionBounds.max());
         // calculate additional cluster centers using Maximin initialization method
         std::vector<float> objectClosestCenterDistance(positions.size(), std::numeric_limits<float>::max()); // this is the distance to the closest cluster center yet encountered for this position
+        const auto nrOfPositions = static_cast<int64_t>(positions.size());
         for (std::size_t ci = 1; ci < nrOfClusters; ++ci)
         {
-            const auto prevClusterCenter = clusters.back().center;
-            auto maxDistancePosition = positions.front();
+            const POSITION_TYPE prevClusterCenter = clusters.back().center;
             auto maxDistanceToCenter = std::numeric_limits<float>::lowest();
-            for (int pi = 0; pi < static_cast<int>(positions.size()); pi++)
+            int64_t maxDistanceIndex = 0;
+#pragma omp parallel if (positions.size() >= MinParallelSize)
             {
-                const auto &position = positions.at(pi);
-                const auto distanceToPrevCenter = POSITION_TYPE::mse(position, prevClusterCenter);
-                if (distanceToPrevCenter < objectClosestCenterDistance.at(pi))
+                // update distances and find maximum distance of this threads' positions
+                auto threadMaxDistance = std::numeric_limits<float>::lowest();
+                int64_t threadMaxIndex = 0;
+                const auto positionData = positions.data();
+                const auto distanceData = objectClosestCenterDistance.data();
+#pragma omp for schedule(static) nowait
+                for (int64_t pi = 0; pi < nrOfPositions; pi++)
                 {
-                    objectClosestCenterDistance.at(pi) = distanceToPrevCenter;
+                    const auto closestDistance = std::min(distanceData[pi], POSITION_TYPE::mse(positionData[pi], prevClusterCenter));
+                    distanceData[pi] = closestDistance;
+                    if (threadMaxDistance < closestDistance)
+                    {
+                        threadMaxDistance = closestDistance;
+                        threadMaxIndex = pi;
+                    }
                 }
-                if (maxDistanceToCenter < objectClosestCenterDistance.at(pi))
+#pragma omp critical
+                if (maxDistanceToCenter < threadMaxDistance || (maxDistanceToCenter == threadMaxDistance && threadMaxIndex < maxDistanceIndex))
                 {
-                    maxDistanceToCenter = objectClosestCenterDistance.at(pi);
-                    maxDistancePosition = position;
+                    maxDistanceToCenter = threadMaxDistance;
+                    maxDistanceIndex = threadMaxIndex;
                 }
             }
             clusters.push_back(CLUSTER_TYPE());
-            clusters.back().center = maxDistancePosition;
+            clusters.back().center = positions[maxDistanceIndex];
         }
         REQUIRE(clusters.size() == nrOfClusters, std::runtime_error, "Failed build expected number of clusters");
+        return clusters;
     }
 
     /// @brief Run online k-mean algorithm on clusters
     /// See: Amber Abernathy, M. Emre Celebi 2022, The incremental online k-means clustering algorithm and its application to color quantization
     /// https://uca.edu/cse/files/2022/06/The_Incremental_Online_K_Means_Clustering_Algorithm_and_Its_Application_to_Color_Quantization.pdf
     /// https://github.com/AmberAbernathy/Color_Quantization
+    /// Distance calculations to cluster centers are skipped using the triangle inequality like in Elkan's k-means, with sqrt(mse()) as metric:
+    /// If the distance of two centers is more than twice the distance of the position to one of them, the other center can not be closer.
+    /// Center distances are not updated every time a center moves. Instead the distances between anchor positions of the centers are stored and the
+    /// distances of the centers to their anchors are subtracted to get lower bounds. A center is re-anchored after it has moved far enough from its anchor.
+    /// The result is the same as when comparing against all centers.
+    /// See: Charles Elkan 2003, Using the Triangle Inequality to Accelerate k-Means, https://cdn.aaai.org/ICML/2003/ICML03-022.pdf
     template <class CLUSTER_TYPE, class POSITION_TYPE>
     auto onlineKmeans(std::vector<CLUSTER_TYPE> &clusters, const std::vector<POSITION_TYPE> &positions, const float learnRateExponent) -> void
     {
+        static constexpr double RefreshFraction = 0.25; // Re-anchor center after it moved this fraction of the distance to the closest anchor away from its anchor
+        static constexpr double BoundMargin = 1e-5;     // Safety margin for float rounding errors when comparing bounds
         // clear all cluster weights
         for (auto &cluster : clusters)
         {
@@ -72,28 +103,79 @@ namespace Kmeans
         } while (std::gcd(lcpA, positions.size()) != 1);
         // generate a random value from 0 to positions.size() - 1
         const std::size_t lcpB = std::rand() % positions.size();
+        // lower bound of the distance of centers i and j is anchorDistances[i * nrOfClusters + j] - anchorOffsets[i] - anchorOffsets[j]
+        const std::size_t nrOfClusters = clusters.size();
+        std::vector<POSITION_TYPE> anchors(nrOfClusters);
+        std::vector<double> anchorDistances(nrOfClusters * nrOfClusters, 0.0); // Distances between anchors
+        std::vector<double> anchorOffsets(nrOfClusters, 0.0);                  // Distance of center to its anchor
+        std::vector<double> reanchorDistances(nrOfClusters, 0.0);              // Re-anchor center when it is further away from its anchor than this
+        auto reanchor = [&](std::size_t i)
+        {
+            anchors[i] = clusters[i].center;
+            anchorOffsets[i] = 0.0;
+            double closestDistance = std::numeric_limits<double>::max();
+            for (std::size_t j = 0; j < nrOfClusters; ++j)
+            {
+                if (i != j)
+                {
+                    const double distance = std::sqrt(static_cast<double>(POSITION_TYPE::mse(anchors[i], anchors[j])));
+                    anchorDistances[i * nrOfClusters + j] = distance;
+                    anchorDistances[j * nrOfClusters + i] = distance;
+                    closestDistance = std::min(closestDistance, distance);
+                }
+            }
+            reanchorDistances[i] = RefreshFraction * closestDistance;
+        };
+        for (std::size_t i = 0; i < nrOfClusters; ++i)
+        {
+            anchors[i] = clusters[i].center;
+        }
+        for (std::size_t i = 0; i < nrOfClusters; ++i)
+        {
+            reanchor(i);
+        }
         // add positions to clusters
+        std::size_t guessClusterIndex = 0;
         for (int i = 0; i < static_cast<int>(positions.size()); i++)
         {
             // get pseudo-random position
             const auto position = positions.at((static_cast<std::size_t>(i) * lcpA + lcpB) % positions.size());
-            // find closest cluster center
-            auto bestClusterIndex = std::numeric_limits<int>::max();
-            auto bestClusterDistance = std::numeric_limits<float>::max();
-            for (int clusterIndex = 0; clusterIndex < static_cast<int>(clusters.size()); clusterIndex++)
+            // find closest cluster center, starting with the closest center of the previous position.
+            // of centers with the same distance the one with the smallest index is used
+            auto bestClusterIndex = guessClusterIndex;
+            auto bestClusterDistance = POSITION_TYPE::mse(position, clusters[bestClusterIndex].center);
+            double bestClusterMetric = std::sqrt(static_cast<double>(bestClusterDistance));
+            for (std::size_t clusterIndex = 0; clusterIndex < nrOfClusters; clusterIndex++)
             {
-                const auto distanceToCluster = POSITION_TYPE::mse(position, clusters.at(clusterIndex).center);
-                if (distanceToCluster < bestClusterDistance)
+                if (clusterIndex == guessClusterIndex)
+                {
+                    continue;
+                }
+                const double centerBound = anchorDistances[bestClusterIndex * nrOfClusters + clusterIndex] - anchorOffsets[bestClusterIndex] - anchorOffsets[clusterIndex];
+                if (centerBound > 2.0 * bestClusterMetric * (1.0 + BoundMargin) + BoundMargin)
+                {
+                    continue;
+                }
+                const auto distanceToCluster = POSITION_TYPE::mse(position, clusters[clusterIndex].center);
+                if (distanceToCluster < bestClusterDistance || (distanceToCluster == bestClusterDistance && clusterIndex < bestClusterIndex))
                 {
                     bestClusterDistance = distanceToCluster;
+                    bestClusterMetric = std::sqrt(static_cast<double>(distanceToCluster));
                     bestClusterIndex = clusterIndex;
                 }
             }
+            guessClusterIndex = bestClusterIndex;
             // update cluster center
             auto &cluster = clusters.at(bestClusterIndex);
             cluster.weight++;
             const float learnRate = std::powf(cluster.weight, -learnRateExponent);
             cluster.center += learnRate * (position - cluster.center);
+            // update center distance bounds
+            anchorOffsets[bestClusterIndex] = std::sqrt(static_cast<double>(POSITION_TYPE::mse(anchors[bestClusterIndex], cluster.center)));
+            if (anchorOffsets[bestClusterIndex] > reanchorDistances[bestClusterIndex])
+            {
+                reanchor(bestClusterIndex);
+            }
         }
     }
 }
@@ -48,18 +48,20 @@ auto lineFit(const std::vector<T> &points) -> std::pair<T, T>
 template <typename T, std::size_t N>
 auto lineFit(const std::array<T, N> &points) -> std::pair<T, T>
 {
-    // copy coordinates to matrix in Eigen format
-    constexpr std::size_t NrOfAtoms = N;
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> eigenPoints(3, NrOfAtoms);
-    for (std::size_t i = 0; i < NrOfAtoms; ++i)
+    // copy coordinates to matrix in Eigen format. Use fixed-size matrices for small N, so no heap memory is allocated.
+    // The SVD stores a N x N matrix internally, so large N would exceed Eigens stack allocation limit
+    constexpr int Cols = N <= 64 ? static_cast<int>(N) : Eigen::Dynamic;
+    using MatrixType = Eigen::Matrix<double, 3, Cols>;
+    MatrixType eigenPoints(3, N);
+    for (std::size_t i = 0; i < N; ++i)
     {
         eigenPoints.col(i) = Eigen::Vector3d(points[i].x(), points[i].y(), points[i].z());
     }
     // calculate centroid and center points
     Eigen::Vector3d centroid = eigenPoints.rowwise().mean();
-    auto centered = eigenPoints.colwise() - centroid;
+    MatrixType centered = eigenPoints.colwise() - centroid;
     // calculate SVD and first eigenvector
-    Eigen::JacobiSVD<Eigen::Matrix3Xd, Eigen::QRPreconditioners::FullPivHouseholderQRPreconditioner> svd;
+    Eigen::JacobiSVD<MatrixType, Eigen::QRPreconditioners::FullPivHouseholderQRPreconditioner> svd;
     auto fullU = svd.compute(centered, Eigen::ComputeFullU);
     Eigen::Vector3d axis = fullU.matrixU().col(0).transpose().normalized();
     return {T(centroid.x(), centroid.y(), centroid.z()), T(axis.x(), axis.y(), axis.z())};
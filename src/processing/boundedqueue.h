@@ -0,0 +1,88 @@
+#pragma once
+
+#include "exception.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/// @brief Thread-safe FIFO queue with a maximum number of entries.
+/// push() blocks while the queue is full, pop() blocks while the queue is empty.
+/// This provides back-pressure between pipeline stages running in different threads
+template <typename T>
+class BoundedQueue
+{
+public:
+    /// @brief Construct queue
+    /// @param maxSize Maximum number of entries in queue. Must be > 0
+    explicit BoundedQueue(std::size_t maxSize)
+        : m_maxSize(maxSize)
+    {
+        REQUIRE(m_maxSize > 0, std::runtime_error, "Queue size must be > 0");
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /// @brief Add an entry to the end of the queue. Blocks while queue is full
+    /// @return Returns false if the queue was closed and the entry was not added
+    auto push(T value) -> bool
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]()
+                       { return m_closed || m_queue.size() < m_maxSize; });
+        if (m_closed)
+        {
+            return false;
+        }
+        m_queue.push_back(std::move(value));
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /// @brief Remove an entry from the front of the queue. Blocks while queue is empty
+    /// @return Returns the entry or an empty optional if the queue was closed and no entries are left
+    auto pop() -> std::optional<T>
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]()
+                        { return m_closed || !m_queue.empty(); });
+        if (m_queue.empty())
+        {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(m_queue.front()));
+        m_queue.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return value;
+    }
+
+    /// @brief Close queue. Subsequent push() calls will fail, pop() will return remaining entries, then fail
+    auto close() -> void
+    {
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    /// @brief Maximum number of entries in queue
+    auto maxSize() const -> std::size_t
+    {
+        return m_maxSize;
+    }
+
+private:
+    const std::size_t m_maxSize;
+    bool m_closed = false;
+    std::deque<T> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
@@ -0,0 +1,360 @@
+#pragma once
+
+#include "boundedqueue.h"
+#include "exception.h"
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/// @brief Multi-threaded frame pipeline connecting its stages with BoundedQueues.
+/// Input is read in its own thread, video and audio frames are processed in their own threads and
+/// output frames are written in their own thread in exactly the order frames were pushed.
+/// If a key frame interval is set, video frames are split into segments starting with a key frame.
+/// Segments do not depend on each other and are processed in parallel by segment workers, each using its own video stage.
+/// Every segment in flight buffers up to a whole segment of source frames, so about (segment workers + 2) * key frame interval
+/// source frames are buffered
+/// @tparam InputT Type read from input, e.g. frame data from a media reader
+/// @tparam VideoT Video frame type. Input and output type of the video stage
+/// @tparam AudioT Audio frame type. Input and output type of the audio stage
+/// @tparam OtherT Frame type passed to output without processing, e.g. subtitles
+template <typename InputT, typename VideoT, typename AudioT, typename OtherT>
+class FramePipeline
+{
+public:
+    /// @brief Video processing stage
+    struct VideoStage
+    {
+        std::function<VideoT(const VideoT &)> process; // Process a single frame
+        std::function<void()> reset;                    // Clear state at the start of a segment. Can be empty
+    };
+
+    /// @brief Read next input. Returns an empty optional at the end of input
+    using Reader = std::function<std::optional<InputT>()>;
+
+    /// @brief Create a video stage. Called in the thread using the stage. Passed true for segment workers
+    using VideoStageFactory = std::function<VideoStage(bool segmentWorker)>;
+
+    /// @brief Process audio frame. An empty input frame flushes buffers. Returns an empty optional if no frame is output
+    using AudioStage = std::function<std::optional<AudioT>(const std::optional<AudioT> &)>;
+
+    using OutputFrame = std::variant<OtherT, VideoT, AudioT>;
+
+    /// @brief Write output frame. Called in the writer thread in the order frames were pushed
+    using Writer = std::function<void(const OutputFrame &)>;
+
+    struct Options
+    {
+        uint32_t queueDepth = 8;         // Maximum number of frames buffered between stages. Must be > 0
+        uint32_t keyFrameInterval = 0;   // Start a new video segment every N video frames. If 0, video frames are processed in order in one thread
+        uint32_t nrOfSegmentWorkers = 0; // Number of threads processing segments. Must be > 0 if keyFrameInterval > 0
+    };
+
+    /// @brief Construct pipeline and start all threads
+    FramePipeline(const Options &options, Reader reader, VideoStageFactory videoStageFactory, AudioStage audioStage, Writer writer)
+        : m_options(options), m_reader(std::move(reader)), m_videoStageFactory(std::move(videoStageFactory)), m_audioStage(std::move(audioStage)), m_writer(std::move(writer)), m_inQueue(options.queueDepth), m_videoQueue(options.queueDepth), m_audioQueue(options.queueDepth), m_outQueue(outQueueDepth(options)), m_segmentQueue(1)
+    {
+        REQUIRE(m_options.keyFrameInterval == 0 || m_options.nrOfSegmentWorkers > 0, std::runtime_error, "Number of segment workers must be > 0 when using key frames");
+        m_readerThread = std::thread(&FramePipeline::readInput, this);
+        m_audioThread = std::thread(&FramePipeline::processAudio, this);
+        if (m_options.keyFrameInterval == 0)
+        {
+            m_videoThread = std::thread(&FramePipeline::processVideo, this);
+        }
+        for (uint32_t wi = 0; wi < (m_options.keyFrameInterval > 0 ? m_options.nrOfSegmentWorkers : 0); ++wi)
+        {
+            m_segmentWorkers.emplace_back(&FramePipeline::processSegments, this);
+        }
+        m_writerThread = std::thread(&FramePipeline::writeOutput, this);
+    }
+
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    /// @brief Stop pipeline if finish() was not called. Frames not written yet are dropped
+    ~FramePipeline()
+    {
+        stop();
+    }
+
+    /// @brief Get next input read
+    /// @return Input or an empty optional at the end of input, if reading failed or the pipeline was stopped
+    auto pop() -> std::optional<InputT>
+    {
+        return m_inQueue.pop();
+    }
+
+    /// @brief Pass video frame to video processing and queue it for writing
+    /// @return Returns false if the pipeline was stopped, e.g. because writing failed
+    auto pushVideo(VideoT frame) -> bool
+    {
+        std::promise<VideoT> outFrame;
+        auto outFuture = outFrame.get_future();
+        if (m_options.keyFrameInterval > 0)
+        {
+            // start a new segment every N frames and pass frame to segment workers for processing
+            if (m_nrOfVideoFrames % m_options.keyFrameInterval == 0)
+            {
+                if (m_currentSegment)
+                {
+                    m_currentSegment->close();
+                }
+                // a segment must hold all of its frames, so the input can move on to the next segment while workers are busy
+                m_currentSegment = std::make_shared<BoundedQueue<VideoJob>>(m_options.keyFrameInterval);
+                if (!m_segmentQueue.push(m_currentSegment))
+                {
+                    return false;
+                }
+            }
+            if (!m_currentSegment->push({std::move(frame), std::move(outFrame)}))
+            {
+                return false;
+            }
+        }
+        else if (!m_videoQueue.push({std::move(frame), std::move(outFrame)}))
+        {
+            return false;
+        }
+        ++m_nrOfVideoFrames;
+        return m_outQueue.push(std::move(outFuture));
+    }
+
+    /// @brief Pass audio frame to audio processing and queue it for writing
+    /// @param frame Audio frame or an empty optional to flush audio buffers
+    /// @return Returns false if the pipeline was stopped, e.g. because writing failed
+    auto pushAudio(std::optional<AudioT> frame) -> bool
+    {
+        std::promise<std::optional<AudioT>> outFrame;
+        auto outFuture = outFrame.get_future();
+        if (!m_audioQueue.push({std::move(frame), std::move(outFrame)}))
+        {
+            return false;
+        }
+        return m_outQueue.push(std::move(outFuture));
+    }
+
+    /// @brief Queue frame for writing without processing
+    /// @return Returns false if the pipeline was stopped, e.g. because writing failed
+    auto pushOther(OtherT frame) -> bool
+    {
+        return m_outQueue.push(std::move(frame));
+    }
+
+    /// @brief Let processing and writer drain their queues, stop all threads and re-throw errors that happened while reading or writing
+    auto finish() -> void
+    {
+        m_videoQueue.close();
+        m_audioQueue.close();
+        if (m_currentSegment)
+        {
+            m_currentSegment->close();
+        }
+        m_segmentQueue.close();
+        m_outQueue.close();
+        stop();
+        if (m_readerException)
+        {
+            std::rethrow_exception(m_readerException);
+        }
+        if (m_writerException)
+        {
+            std::rethrow_exception(m_writerException);
+        }
+    }
+
+private:
+    using VideoJob = std::pair<VideoT, std::promise<VideoT>>;
+    using AudioJob = std::pair<std::optional<AudioT>, std::promise<std::optional<AudioT>>>;
+    using VideoSegment = std::shared_ptr<BoundedQueue<VideoJob>>;
+    using VideoFuture = std::future<VideoT>;
+    using AudioFuture = std::future<std::optional<AudioT>>;
+    using QueuedFrame = std::variant<OtherT, VideoFuture, AudioFuture>;
+
+    /// @brief The output queue must be able to hold all video and audio frames of the segments in flight, so all workers keep busy.
+    /// These are the segments being processed by workers, one segment waiting for a worker and the segment being filled
+    static auto outQueueDepth(const Options &options) -> std::size_t
+    {
+        return options.queueDepth + (options.keyFrameInterval > 0 ? 2 * (options.nrOfSegmentWorkers + 2) * options.keyFrameInterval : 0);
+    }
+
+    /// @brief Close all queues and join all threads
+    auto stop() -> void
+    {
+        m_inQueue.close();
+        m_outQueue.close();
+        m_videoQueue.close();
+        m_audioQueue.close();
+        if (m_currentSegment)
+        {
+            m_currentSegment->close();
+        }
+        m_segmentQueue.close();
+        for (auto thread : {&m_readerThread, &m_videoThread, &m_audioThread, &m_writerThread})
+        {
+            if (thread->joinable())
+            {
+                thread->join();
+            }
+        }
+        for (auto &worker : m_segmentWorkers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    /// @brief Read input until the end of input or until the input queue is closed
+    auto readInput() -> void
+    {
+        try
+        {
+            while (auto input = m_reader())
+            {
+                if (!m_inQueue.push(std::move(input.value())))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            m_readerException = std::current_exception();
+        }
+        m_inQueue.close();
+    }
+
+    /// @brief Process video frames in order if no segments are used
+    auto processVideo() -> void
+    {
+        std::optional<VideoStage> stage;
+        while (auto job = m_videoQueue.pop())
+        {
+            try
+            {
+                if (!stage)
+                {
+                    stage = m_videoStageFactory(false);
+                }
+                job->second.set_value(stage->process(job->first));
+            }
+            catch (...)
+            {
+                job->second.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    /// @brief Process video segments. Every worker uses its own video stage
+    auto processSegments() -> void
+    {
+        std::optional<VideoStage> stage;
+        while (auto segment = m_segmentQueue.pop())
+        {
+            bool segmentStart = true;
+            while (auto job = segment.value()->pop())
+            {
+                try
+                {
+                    if (!stage)
+                    {
+                        stage = m_videoStageFactory(true);
+                    }
+                    // clear state of previous segment, so the first frame becomes a key frame
+                    if (segmentStart && stage->reset)
+                    {
+                        stage->reset();
+                    }
+                    segmentStart = false;
+                    job->second.set_value(stage->process(job->first));
+                }
+                catch (...)
+                {
+                    job->second.set_exception(std::current_exception());
+                }
+            }
+        }
+    }
+
+    /// @brief Process audio frames in order
+    auto processAudio() -> void
+    {
+        while (auto job = m_audioQueue.pop())
+        {
+            try
+            {
+                job->second.set_value(m_audioStage(job->first));
+            }
+            catch (...)
+            {
+                job->second.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    /// @brief Write output frames in order. Waits for video and audio frames to be processed
+    auto writeOutput() -> void
+    {
+        try
+        {
+            while (auto queuedFrame = m_outQueue.pop())
+            {
+                auto outFrame = std::visit([](auto &frame) -> std::optional<OutputFrame>
+                                           {
+                    using T = std::decay_t<decltype(frame)>;
+                    if constexpr (std::is_same_v<T, VideoFuture>)
+                    {
+                        return OutputFrame(std::in_place_index<1>, frame.get());
+                    }
+                    else if constexpr (std::is_same_v<T, AudioFuture>)
+                    {
+                        auto audioFrame = frame.get();
+                        return audioFrame.has_value() ? std::optional<OutputFrame>(std::in_place, std::in_place_index<2>, std::move(audioFrame.value())) : std::nullopt;
+                    }
+                    else
+                    {
+                        return OutputFrame(std::in_place_index<0>, std::move(frame));
+                    } }, queuedFrame.value());
+                // audio processing might buffer samples and not return a frame for every input frame
+                if (outFrame.has_value())
+                {
+                    m_writer(outFrame.value());
+                }
+            }
+        }
+        catch (...)
+        {
+            m_writerException = std::current_exception();
+        }
+        m_outQueue.close();
+    }
+
+    const Options m_options;
+    Reader m_reader;
+    VideoStageFactory m_videoStageFactory;
+    AudioStage m_audioStage;
+    Writer m_writer;
+    uint32_t m_nrOfVideoFrames = 0;
+    BoundedQueue<InputT> m_inQueue;
+    BoundedQueue<VideoJob> m_videoQueue;
+    BoundedQueue<AudioJob> m_audioQueue;
+    BoundedQueue<QueuedFrame> m_outQueue;
+    BoundedQueue<VideoSegment> m_segmentQueue;
+    VideoSegment m_currentSegment;
+    std::exception_ptr m_readerException;
+    std::exception_ptr m_writerException;
+    std::thread m_readerThread;
+    std::thread m_videoThread;
+    std::thread m_audioThread;
+    std::vector<std::thread> m_segmentWorkers;
+    std::thread m_writerThread;
+};
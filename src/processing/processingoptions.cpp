@@ -138,7 +138,7 @@ ProcessingOptions::OptionT<Color::Format> ProcessingOptions::outformat{
 
 ProcessingOptions::OptionT<Image::Quantization::Method> ProcessingOptions::quantizationmethod{
     true,
-    {"quantize", "Set quantization method for color(-space) reduction. Options are closestcolor (default) or atkinsondither", cxxopts::value(quantizationmethod.valueString)},
+    {"quantize", "Set quantization method for color(-space) reduction. Options are closestcolor (default), atkinsondither or ordereddither", cxxopts::value(quantizationmethod.valueString)},
     {Image::Quantization::Method::ClosestColor},
     {},
     [](const cxxopts::ParseResult &r)
@@ -153,9 +153,13 @@ ProcessingOptions::OptionT<Image::Quantization::Method> ProcessingOptions::quant
             {
                 quantizationmethod.value = Image::Quantization::Method::AtkinsonDither;
             }
+            else if (quantizationmethod.valueString == "ordereddither")
+            {
+                quantizationmethod.value = Image::Quantization::Method::OrderedDither;
+            }
             else
             {
-                THROW(std::runtime_error, "Quantization method must be closestcolor (default) or atkinsondither if specified");
+                THROW(std::runtime_error, "Quantization method must be closestcolor (default), atkinsondither or ordereddither if specified");
             }
             quantizationmethod.isSet = true;
         }
@@ -299,6 +303,24 @@ ProcessingOptions::Option ProcessingOptions::rans{
     false,
     {"rans", "Use rANS compression 50h.", cxxopts::value(rans.isSet)}};
 
+ProcessingOptions::Option ProcessingOptions::ransAdaptive{
+    false,
+    {"ransadaptive", "Let rANS compression 50h use an adaptive model that can start with the model of the previous frame if that is smaller. Needs --rans.", cxxopts::value(ransAdaptive.isSet)}};
+
+ProcessingOptions::OptionT<uint32_t> ProcessingOptions::huffman{
+    false,
+    {"huffman", "Use Huffman compression 20h with N bits per symbol. N must be 4 or 8, e.g. \"--huffman=8\"", cxxopts::value(huffman.value)},
+    8,
+    {},
+    [](const cxxopts::ParseResult &r)
+    {
+        if (r.count(huffman.cxxOption.opts_))
+        {
+            REQUIRE(huffman.value == 4 || huffman.value == 8, std::runtime_error, "Bits per symbol must be 4 or 8");
+            huffman.isSet = true;
+        }
+    }};
+
 ProcessingOptions::Option ProcessingOptions::lz4{
     false,
     {"lz4", "Use LZ4 compression variant 40h.", cxxopts::value(lz4.isSet)}};
@@ -315,6 +337,42 @@ ProcessingOptions::Option ProcessingOptions::vram{
     false,
     {"vram", "Make compression VRAM-safe.", cxxopts::value(vram.isSet)}};
 
+ProcessingOptions::Option ProcessingOptions::lzOptimal{
+    false,
+    {"lzoptimal", "Use optimal parsing for LZ compression. Slower, but compresses better.", cxxopts::value(lzOptimal.isSet)}};
+
+ProcessingOptions::Option ProcessingOptions::lzDictionary{
+    false,
+    {"lzdict", "Use the previous frame as dictionary for LZ4 compression. Compresses better, but host-only: only vid2hplay can play these files, the GBA player refuses them. Needs --lz4. Can not be used with --autocompress.", cxxopts::value(lzDictionary.isSet)}};
+
+ProcessingOptions::OptionT<double> ProcessingOptions::autoCompress{
+    false,
+    {"autocompress", "Pick the best of no compression, LZ4 and LZ10 (or the ones passed) per frame. Minimizes size + W * estimated GBA decode cycles. W must be >= 0, e.g. \"--autocompress=0.1\"", cxxopts::value(autoCompress.value)},
+    {},
+    {},
+    [](const cxxopts::ParseResult &r)
+    {
+        if (r.count(autoCompress.cxxOption.opts_))
+        {
+            REQUIRE(autoCompress.value >= 0, std::runtime_error, "Cycle weight must be >= 0");
+            autoCompress.isSet = true;
+        }
+    }};
+
+ProcessingOptions::OptionT<uint32_t> ProcessingOptions::chunks{
+    false,
+    {"chunks", "Split data into independently compressed chunks of N bytes that are compressed in parallel. Use with LZ4 and / or LZ10. N must be a multiple of 4, e.g. \"--chunks=16384\"", cxxopts::value(chunks.value)},
+    16384,
+    {},
+    [](const cxxopts::ParseResult &r)
+    {
+        if (r.count(chunks.cxxOption.opts_))
+        {
+            REQUIRE(chunks.value > 0 && chunks.value % 4 == 0, std::runtime_error, "Chunk size must be > 0 and a multiple of 4");
+            chunks.isSet = true;
+        }
+    }};
+
 ProcessingOptions::Option ProcessingOptions::dxt{
     false,
     {"dxt", "Use DXT1-ish RGB555 compression.", cxxopts::value(dxt.isSet)}};
@@ -334,6 +392,10 @@ ProcessingOptions::OptionT<double> ProcessingOptions::dxtv{
         }
     }};
 
+ProcessingOptions::Option ProcessingOptions::dxtvFast{
+    false,
+    {"dxtvfast", "Use fast diamond motion search for DXTV reference blocks instead of exhaustive search. Faster, but might find fewer / worse references.", cxxopts::value(dxtvFast.isSet)}};
+
 /*ProcessingOptions::Option ProcessingOptions::gvid{
     false,
     {"gvid", "Use GVID video compression.", cxxopts::value(gvid.isSet)}};*/
@@ -464,3 +526,31 @@ ProcessingOptions::Option ProcessingOptions::outputStats{
 ProcessingOptions::Option ProcessingOptions::binary{
     false,
     {"binary", "Output data as binary blob file instead of .h / .c files.", cxxopts::value(binary.isSet)}};
+
+ProcessingOptions::OptionT<uint32_t> ProcessingOptions::queueDepth{
+    false,
+    {"queuedepth", "Max. number of frames buffered between reading, video processing, audio processing and writing stages (default=8). N must be in [1, 256].", cxxopts::value(queueDepth.value)},
+    8,
+    {},
+    [](const cxxopts::ParseResult &r)
+    {
+        if (r.count(queueDepth.cxxOption.opts_))
+        {
+            REQUIRE(queueDepth.value >= 1 && queueDepth.value <= 256, std::runtime_error, "Queue depth must be in [1, 256]");
+            queueDepth.isSet = true;
+        }
+    }};
+
+ProcessingOptions::OptionT<uint32_t> ProcessingOptions::keyFrames{
+    false,
+    {"keyframes", "Insert a key frame every N frames and encode up to --queuedepth video segments between key frames in parallel (default=off). Buffers up to about 2 * (segments + 1) * N encoded frames before writing. N must be in [1, 65535].", cxxopts::value(keyFrames.value)},
+    0,
+    {},
+    [](const cxxopts::ParseResult &r)
+    {
+        if (r.count(keyFrames.cxxOption.opts_))
+        {
+            REQUIRE(keyFrames.value >= 1 && keyFrames.value <= 65535, std::runtime_error, "Key frame interval must be in [1, 65535]");
+            keyFrames.isSet = true;
+        }
+    }};
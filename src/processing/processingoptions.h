@@ -53,12 +53,19 @@ public:
     static Option delta8;
     static Option delta16;
     static Option rans;
+    static Option ransAdaptive;
+    static OptionT<uint32_t> huffman;
     static Option lz4;
     static Option lz10;
     // static Option rle;
     static Option vram;
+    static Option lzOptimal;
+    static Option lzDictionary;
+    static OptionT<double> autoCompress;
+    static OptionT<uint32_t> chunks;
     static Option dxt;
     static OptionT<double> dxtv;
+    static Option dxtvFast;
     // static Option gvid;
     static Option interleavePixels;
 
@@ -84,4 +91,6 @@ public:
     static Option dumpMeta;
     static Option outputStats;
     static Option binary;
+    static OptionT<uint32_t> queueDepth;
+    static OptionT<uint32_t> keyFrames;
 };
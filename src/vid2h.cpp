@@ -14,17 +14,21 @@
 #include "io/vid2hio.h"
 #include "subtitles/srtio.h"
 #include "processing/datahelpers.h"
+#include "processing/framepipeline.h"
 #include "processing/processingoptions.h"
 #include "statistics/statisticswindow.h"
 #include "statistics/statisticswriter.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <variant>
 
 #include "cxxopts/include/cxxopts.hpp"
 
@@ -69,11 +73,18 @@ bool readArguments(int argc, const char *argv[])
         opts.add_option("", options.delta16.cxxOption);
         opts.add_option("", options.dxt.cxxOption);
         opts.add_option("", options.dxtv.cxxOption);
+        opts.add_option("", options.dxtvFast.cxxOption);
         // opts.add_option("", options.gvid.cxxOption);
         // opts.add_option("", options.rle.cxxOption);
+        opts.add_option("", options.huffman.cxxOption);
+        opts.add_option("", options.rans.cxxOption);
+        opts.add_option("", options.ransAdaptive.cxxOption);
         opts.add_option("", options.lz4.cxxOption);
         opts.add_option("", options.lz10.cxxOption);
         opts.add_option("", options.vram.cxxOption);
+        opts.add_option("", options.lzOptimal.cxxOption);
+        opts.add_option("", options.lzDictionary.cxxOption);
+        opts.add_option("", options.autoCompress.cxxOption);
         opts.add_option("", options.channelFormat.cxxOption);
         opts.add_option("", options.sampleFormat.cxxOption);
         opts.add_option("", options.sampleRateHz.cxxOption);
@@ -84,6 +95,8 @@ bool readArguments(int argc, const char *argv[])
         opts.add_option("", options.printStats.cxxOption);
         opts.add_option("", options.dryRun.cxxOption);
         opts.add_option("", options.outputStats.cxxOption);
+        opts.add_option("", options.queueDepth.cxxOption);
+        opts.add_option("", options.keyFrames.cxxOption);
         opts.add_option("", {"infile", "Input video file to convert, e.g. \"foo.avi\"", cxxopts::value<std::string>()});
         opts.add_option("", {"outname", "Output file and variable name, e.g \"foo\". This will name the output files \"foo.h\" and \"foo.c\" and variable names will start with \"FOO_\"", cxxopts::value<std::string>()});
         opts.parse_positional({"infile", "outname"});
@@ -165,9 +178,37 @@ bool readArguments(int argc, const char *argv[])
         options.pruneIndices.parse(result);
         options.sprites.parse(result);
         options.dxtv.parse(result);
+        options.autoCompress.parse(result);
+        if (options.autoCompress && options.lzDictionary)
+        {
+            std::cerr << "--lzdict can not be used with --autocompress." << std::endl;
+            return false;
+        }
+        if (options.lzDictionary && !options.lz4)
+        {
+            std::cerr << "--lzdict needs --lz4." << std::endl;
+            return false;
+        }
+        if (options.lzDictionary)
+        {
+            std::cout << "Warning: --lzdict output can only be played with vid2hplay. The GBA player refuses to play it." << std::endl;
+        }
+        options.huffman.parse(result);
+        if (options.ransAdaptive && !options.rans)
+        {
+            std::cerr << "--ransadaptive needs --rans." << std::endl;
+            return false;
+        }
         options.channelFormat.parse(result);
         options.sampleFormat.parse(result);
         options.sampleRateHz.parse(result);
+        options.queueDepth.parse(result);
+        options.keyFrames.parse(result);
+        if (options.keyFrames && options.deltaImage)
+        {
+            std::cerr << "Key frames can not be used with --deltaimage." << std::endl;
+            return false;
+        }
     }
     catch (const cxxopts::exceptions::parsing &e)
     {
@@ -205,13 +246,20 @@ void printUsage()
     std::cout << "Image compression options (mutually exclusive):" << std::endl;
     std::cout << options.dxt.helpString() << std::endl;
     std::cout << options.dxtv.helpString() << std::endl;
+    std::cout << options.dxtvFast.helpString() << std::endl;
     // std::cout << options.gvid.helpString() << std::endl;
     std::cout << "Compression options (mutually exclusive):" << std::endl;
     // std::cout << options.rle.helpString() << std::endl;
+    std::cout << options.huffman.helpString() << std::endl;
+    std::cout << options.rans.helpString() << std::endl;
     std::cout << options.lz4.helpString() << std::endl;
     std::cout << options.lz10.helpString() << std::endl;
     std::cout << "Compression modifiers (optional):" << std::endl;
     std::cout << options.vram.helpString() << std::endl;
+    std::cout << options.lzOptimal.helpString() << std::endl;
+    std::cout << options.lzDictionary.helpString() << std::endl;
+    std::cout << options.ransAdaptive.helpString() << std::endl;
+    std::cout << options.autoCompress.helpString() << std::endl;
     std::cout << "Output audio format (all optional):" << std::endl;
     std::cout << options.channelFormat.helpString() << std::endl;
     std::cout << options.sampleFormat.helpString() << std::endl;
@@ -232,9 +280,11 @@ void printUsage()
     std::cout << options.printStats.helpString() << std::endl;
     std::cout << options.dryRun.helpString() << std::endl;
     std::cout << options.outputStats.helpString() << std::endl;
+    std::cout << options.queueDepth.helpString() << std::endl;
+    std::cout << options.keyFrames.helpString() << std::endl;
     std::cout << "h / help: Show this help." << std::endl;
     std::cout << "Image order: input, color conversion, addcolor0, movecolor0, shift, sprites, " << std::endl;
-    std::cout << "tiles, deltaimage, dxtg / dtxv, delta8 / delta16, lz4 / lz10, output" << std::endl;
+    std::cout << "tiles, deltaimage, dxtg / dtxv, delta8 / delta16, huffman, lz4 / lz10, output" << std::endl;
     std::cout << "Note: Multi-channel audio will be converted to stereo and sample bit depth will " << std::endl;
     std::cout << "be converted to 16 bit" << std::endl;
 }
@@ -332,7 +382,7 @@ auto buildImageProcessing(const ProcessingOptions &opts) -> Image::Processing
     }
     if (opts.dxtv)
     {
-        videoProcessing.addStep(Image::ProcessingType::CompressDXTV, {opts.outformat.value, opts.dxtv.value}, true, opts.printStats);
+        videoProcessing.addStep(Image::ProcessingType::CompressDXTV, {opts.outformat.value, opts.dxtv.value, opts.dxtvFast.isSet}, true, opts.printStats);
     }
     /*if (options.gvid)
     {
@@ -353,17 +403,31 @@ auto buildImageProcessing(const ProcessingOptions &opts) -> Image::Processing
     {
         processing.addStep(Image::ProcessingType::CompressRLE, {options.vram.isSet}, true);
     }*/
-    if (opts.lz4)
+    if (opts.huffman)
+    {
+        videoProcessing.addStep(Image::ProcessingType::CompressHuffman_20, {opts.huffman.value}, true, opts.printStats);
+    }
+    if (opts.autoCompress)
     {
-        videoProcessing.addStep(Image::ProcessingType::CompressLZ4_40, {opts.vram.isSet}, true, opts.printStats);
+        // try the compressors passed or all of them if none were passed
+        const bool useAll = !opts.lz4.isSet && !opts.lz10.isSet;
+        videoProcessing.addStep(Image::ProcessingType::CompressAuto, {opts.vram.isSet, opts.lzOptimal.isSet, useAll || opts.lz4.isSet, useAll || opts.lz10.isSet, opts.autoCompress.value}, true, opts.printStats);
     }
-    if (opts.lz10)
+    else
     {
-        videoProcessing.addStep(Image::ProcessingType::CompressLZSS_10, {opts.vram.isSet}, true, opts.printStats);
+        if (opts.lz4)
+        {
+            videoProcessing.addStep(opts.lzDictionary ? Image::ProcessingType::CompressLZ4Dictionary_40 : Image::ProcessingType::CompressLZ4_40, {opts.vram.isSet, opts.lzOptimal.isSet}, true, opts.printStats);
+        }
+        if (opts.lz10)
+        {
+            videoProcessing.addStep(Image::ProcessingType::CompressLZSS_10, {opts.vram.isSet, opts.lzOptimal.isSet}, true, opts.printStats);
+        }
     }
     if (opts.rans)
     {
-        videoProcessing.addStep(Image::ProcessingType::CompressRANS_50, {}, true, opts.printStats);
+        // the host player decodes interleaved rANS data faster
+        videoProcessing.addStep(Image::ProcessingType::CompressRANS_50, {true, opts.ransAdaptive.isSet}, true, opts.printStats);
     }
     videoProcessing.addStep(Image::ProcessingType::PadPixelData, {uint32_t(4)});
     return videoProcessing;
@@ -394,7 +458,7 @@ auto buildAudioProcessing(const ProcessingOptions &opts, const Media::Reader::Me
     }
     if (opts.lz4)
     {
-        audioProcessing.addStep(Audio::ProcessingType::CompressLZ4_40, {opts.vram.isSet}, true, opts.printStats);
+        audioProcessing.addStep(opts.lzDictionary ? Audio::ProcessingType::CompressLZ4Dictionary_40 : Audio::ProcessingType::CompressLZ4_40, {opts.vram.isSet, opts.lzOptimal.isSet}, true, opts.printStats);
     }
     return audioProcessing;
 }
@@ -604,18 +668,98 @@ int main(int argc, const char *argv[])
         uint32_t videoOutMaxMemoryNeeded = 0; // Maximum memory needed for decoding video frames
         Image::FrameInfo videoOutInfo;        // Information about video from media decoder
         // Audio info
+        uint32_t audioFrameIndex = 0;        // Index of last audio frame read
         uint64_t audioOutCompressedSize = 0; // Combined size of compressed audio data
         int32_t audioFirstFrameOffset = 0;   // Offset of first audio frame in samples
         // Subtitles info
         uint32_t subtitleFrameIndex = 0; // Index of last processed subtitle
-        while (videoFrameIndex < mediaInfo.videoNrOfFrames && audioProcessing.nrOfInputFrames() < mediaInfo.audioNrOfFrames)
-        {
-            const auto inFrame = mediaReader.readFrame();
+        // Reading, video processing, audio processing and writing run in separate threads connected by bounded queues.
+        // Frames are written in exactly the order they were read. When key frames are inserted, the video is split
+        // into segments starting with a key frame and segments are encoded in parallel by segment workers.
+        // Every segment in flight buffers a whole segment of source frames, so limit the number of workers by the queue depth
+        using Pipeline = FramePipeline<Media::Reader::FrameData, Image::Frame, Audio::Frame, Subtitles::Frame>;
+        Pipeline::Options pipelineOptions;
+        pipelineOptions.queueDepth = options.queueDepth.value;
+        pipelineOptions.keyFrameInterval = options.keyFrames ? options.keyFrames.value : 0;
+        pipelineOptions.nrOfSegmentWorkers = options.keyFrames ? std::min(static_cast<uint32_t>(nrOfProcessors), options.queueDepth.value) : 0;
+        // read frames from media file. The EOF frame is passed on, so the frame counts can be checked
+        auto readFrame = [&mediaReader, isEof = false]() mutable -> std::optional<Media::Reader::FrameData>
+        {
+            if (isEof)
+            {
+                return std::nullopt;
+            }
+            auto inFrame = mediaReader.readFrame();
+            isEof = inFrame.frameType == IO::FrameType::Unknown;
+            return inFrame;
+        };
+        // segment workers use their own copy of the processing pipeline
+        auto createVideoStage = [&videoProcessing, &statistics](bool segmentWorker) -> Pipeline::VideoStage
+        {
+            if (!segmentWorker)
+            {
+                return {[&videoProcessing, &statistics](const Image::Frame &frame)
+                        { return videoProcessing.processStream(frame, statistics); },
+                        {}};
+            }
+            // segments are already encoded in parallel, so encode frames single-threaded
+            omp_set_num_threads(1);
+            auto processing = std::make_shared<Image::Processing>(videoProcessing);
+            return {[processing, &statistics](const Image::Frame &frame)
+                    { return processing->processStream(frame, statistics); },
+                    [processing]()
+                    { processing->reset(); }};
+        };
+        auto processAudio = [&audioProcessing, &statistics](const std::optional<Audio::Frame> &frame)
+        {
+            const bool flushBuffers = !frame.has_value();
+            return audioProcessing.processStream(flushBuffers ? Audio::Frame() : frame.value(), flushBuffers, statistics);
+        };
+        // write processed frames to output file and statistics
+        auto writeFrame = [&binFile, &statisticsWriter, &videoOutCompressedSize, &videoOutMaxMemoryNeeded, &videoOutInfo, &audioOutCompressedSize](const Pipeline::OutputFrame &outFrame)
+        {
+            std::visit([&](const auto &frame)
+                       {
+                using T = std::decay_t<decltype(frame)>;
+                if (!options.dryRun && binFile.is_open())
+                {
+                    IO::Vid2h::writeFrame(binFile, frame);
+                }
+                // update size info and write output statistics
+                if constexpr (std::is_same_v<T, Image::Frame>)
+                {
+                    videoOutCompressedSize += frame.data.pixels().rawSize() + (options.paletted ? frame.data.colorMap().rawSize() : 0);
+                    videoOutMaxMemoryNeeded = videoOutMaxMemoryNeeded < frame.info.maxMemoryNeeded ? frame.info.maxMemoryNeeded : videoOutMaxMemoryNeeded;
+                    videoOutInfo = frame.info;
+                    if (options.outputStats)
+                    {
+                        statisticsWriter.writeFrame("video", frame.data.pixels().convertDataToRaw());
+                    }
+                }
+                else if constexpr (std::is_same_v<T, Audio::Frame>)
+                {
+                    audioOutCompressedSize += AudioHelpers::rawDataSize(frame.data);
+                    if (options.outputStats)
+                    {
+                        statisticsWriter.writeFrame("audio", AudioHelpers::toRawData(frame.data, frame.info.channelFormat));
+                    }
+                } }, outFrame);
+        };
+        Pipeline pipeline(pipelineOptions, readFrame, createVideoStage, processAudio, writeFrame);
+        while (videoFrameIndex < mediaInfo.videoNrOfFrames && audioFrameIndex < mediaInfo.audioNrOfFrames)
+        {
+            auto inFrameOpt = pipeline.pop();
+            // check if reader failed
+            if (!inFrameOpt.has_value())
+            {
+                break;
+            }
+            const auto &inFrame = inFrameOpt.value();
             // check if EOF
             if (inFrame.frameType == IO::FrameType::Unknown)
             {
                 REQUIRE(!outputHasVideo || videoFrameIndex == (mediaInfo.videoNrOfFrames - 1), std::runtime_error, "Expected " << mediaInfo.videoNrOfFrames << " video frames, but got " << videoFrameIndex);
-                REQUIRE(!outputHasAudio || audioProcessing.nrOfInputFrames() == (mediaInfo.audioNrOfFrames - 1), std::runtime_error, "Expected " << mediaInfo.audioNrOfFrames << " audio frames, but got " << audioProcessing.nrOfInputFrames());
+                REQUIRE(!outputHasAudio || audioFrameIndex == (mediaInfo.audioNrOfFrames - 1), std::runtime_error, "Expected " << mediaInfo.audioNrOfFrames << " audio frames, but got " << audioFrameIndex);
                 break;
             }
             // check if we need to store a subtitle frame
@@ -625,10 +769,10 @@ int main(int argc, const char *argv[])
                 const auto &subtitle = subtitles[subtitleFrameIndex];
                 if (inFrame.presentTimeInS >= subtitle.startTimeS)
                 {
-                    // write subtitle to file
-                    if (!options.dryRun && binFile.is_open())
+                    // queue subtitle for writing
+                    if (!pipeline.pushOther(subtitle))
                     {
-                        IO::Vid2h::writeFrame(binFile, subtitle);
+                        break;
                     }
                     ++subtitleFrameIndex;
                 }
@@ -638,48 +782,26 @@ int main(int argc, const char *argv[])
             {
                 const auto &inImage = std::get<std::vector<Color::XRGB8888>>(inFrame.data);
                 REQUIRE(inImage.size() == mediaInfo.videoWidth * mediaInfo.videoHeight, std::runtime_error, "Unexpected image size");
-                // build internal image from pixels and apply processing
+                // build internal image from pixels and pass it to video processing
                 const Image::FrameInfo imageInfo = {{mediaInfo.videoWidth, mediaInfo.videoHeight}, Color::Format::Unknown, Color::Format::Unknown, 0, 0};
                 const Image::MapInfo mapInfo = {{0, 0}, {}};
-                const auto outFrame = videoProcessing.processStream(Image::Frame{videoFrameIndex, "", Image::DataType(Image::DataType::Flags::Bitmap), imageInfo, inImage, mapInfo}, statistics);
-                videoOutCompressedSize += outFrame.data.pixels().rawSize() + (options.paletted ? outFrame.data.colorMap().rawSize() : 0);
-                videoOutMaxMemoryNeeded = videoOutMaxMemoryNeeded < outFrame.info.maxMemoryNeeded ? outFrame.info.maxMemoryNeeded : videoOutMaxMemoryNeeded;
-                videoOutInfo = outFrame.info;
-                // write image to file
-                if (!options.dryRun && binFile.is_open())
+                Image::Frame image{videoFrameIndex, "", Image::DataType(Image::DataType::Flags::Bitmap), imageInfo, inImage, mapInfo};
+                if (!pipeline.pushVideo(std::move(image)))
                 {
-                    IO::Vid2h::writeFrame(binFile, outFrame);
+                    break;
                 }
                 ++videoFrameIndex;
-                // write output statistics
-                if (options.outputStats)
-                {
-                    auto compressed = outFrame.data.pixels().convertDataToRaw();
-                    statisticsWriter.writeFrame("video", compressed);
-                }
             }
             // check if audio frame
             else if (inFrame.frameType == IO::FrameType::Audio && outputHasAudio)
             {
-                // build audio frame from sample data
-                const Audio::Frame audioFrame = {audioProcessing.nrOfInputFrames(), "", {mediaInfo.audioSampleRateHz, mediaInfo.audioChannelFormat, mediaInfo.audioSampleFormat, false, 0}, std::get<std::vector<int16_t>>(inFrame.data), 0};
-                const auto outFrameOpt = audioProcessing.processStream(audioFrame, false, statistics);
-                if (outFrameOpt.has_value())
+                // build audio frame from sample data and pass it to audio processing
+                Audio::Frame audioFrame = {audioFrameIndex, "", {mediaInfo.audioSampleRateHz, mediaInfo.audioChannelFormat, mediaInfo.audioSampleFormat, false, 0}, std::get<std::vector<int16_t>>(inFrame.data), 0};
+                if (!pipeline.pushAudio(std::move(audioFrame)))
                 {
-                    const auto &outFrame = outFrameOpt.value();
-                    audioOutCompressedSize += AudioHelpers::rawDataSize(outFrame.data);
-                    // write samples to file
-                    if (!options.dryRun && binFile.is_open())
-                    {
-                        IO::Vid2h::writeFrame(binFile, outFrame);
-                    }
-                    // write output statistics
-                    if (options.outputStats)
-                    {
-                        auto compressed = AudioHelpers::toRawData(outFrame.data, outFrame.info.channelFormat);
-                        statisticsWriter.writeFrame("audio", compressed);
-                    }
+                    break;
                 }
+                ++audioFrameIndex;
             }
             // calculate progress
             const uint32_t newProgress = ((100 * videoFrameIndex) / mediaInfo.videoNrOfFrames);
@@ -695,18 +817,9 @@ int main(int argc, const char *argv[])
             // update statistics
             window.update();
         }
-        // flush remaining buffers
-        auto outFrameOpt = audioProcessing.processStream(Audio::Frame(), true, statistics);
-        if (outFrameOpt.has_value())
-        {
-            const auto &outFrame = outFrameOpt.value();
-            audioOutCompressedSize += AudioHelpers::rawDataSize(outFrame.data);
-            // write samples to file
-            if (!options.dryRun && binFile.is_open())
-            {
-                IO::Vid2h::writeFrame(binFile, outFrame);
-            }
-        }
+        // flush remaining audio buffers, wait for all frames to be written and re-throw errors that happened while reading or writing
+        pipeline.pushAudio(std::nullopt);
+        pipeline.finish();
         // write final file header to start of stream
         if (!options.dryRun && binFile.is_open())
         {
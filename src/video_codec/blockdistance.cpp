@@ -0,0 +1,233 @@
+#include "blockdistance.h"
+
+#include "exception.h"
+
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#define BLOCKDISTANCE_SSE2
+#endif
+#if defined(BLOCKDISTANCE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+// AVX2 code is only compiled for the functions using it and selected at runtime
+#define BLOCKDISTANCE_AVX2
+#define BLOCKDISTANCE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Video::BlockDistance
+{
+
+    // Mask removing the X channel of XRGB8888 pixels (stored as BGRX in memory)
+    static constexpr uint32_t RGBMask = 0x00FFFFFF;
+
+    template <std::size_t BLOCK_DIM>
+    auto sadScalar(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        uint32_t sum = 0;
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v, a += strideA, b += strideB)
+        {
+            for (std::size_t u = 0; u < BLOCK_DIM; ++u)
+            {
+                sum += std::abs(static_cast<int32_t>(a[u].R()) - static_cast<int32_t>(b[u].R()));
+                sum += std::abs(static_cast<int32_t>(a[u].G()) - static_cast<int32_t>(b[u].G()));
+                sum += std::abs(static_cast<int32_t>(a[u].B()) - static_cast<int32_t>(b[u].B()));
+            }
+        }
+        return sum;
+    }
+
+    template <std::size_t BLOCK_DIM>
+    auto ssdScalar(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        uint32_t sum = 0;
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v, a += strideA, b += strideB)
+        {
+            for (std::size_t u = 0; u < BLOCK_DIM; ++u)
+            {
+                const int32_t dR = static_cast<int32_t>(a[u].R()) - static_cast<int32_t>(b[u].R());
+                const int32_t dG = static_cast<int32_t>(a[u].G()) - static_cast<int32_t>(b[u].G());
+                const int32_t dB = static_cast<int32_t>(a[u].B()) - static_cast<int32_t>(b[u].B());
+                sum += static_cast<uint32_t>(dR * dR + dG * dG + dB * dB);
+            }
+        }
+        return sum;
+    }
+
+#ifdef BLOCKDISTANCE_SSE2
+    /// @brief Load 4 pixels and clear the X channel
+    static inline auto loadRGB4(const Color::XRGB8888 *p) -> __m128i
+    {
+        return _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), _mm_set1_epi32(RGBMask));
+    }
+
+    /// @brief Sum of squared differences of 16 bytes as 4 x 32-bit sums
+    static inline auto ssd16SSE2(__m128i a, __m128i b) -> __m128i
+    {
+        const auto zero = _mm_setzero_si128();
+        const auto dLo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        const auto dHi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        return _mm_add_epi32(_mm_madd_epi16(dLo, dLo), _mm_madd_epi16(dHi, dHi));
+    }
+
+    /// @brief Sum all 4 32-bit values
+    static inline auto horizontalSum32(__m128i v) -> uint32_t
+    {
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+    }
+
+    template <std::size_t BLOCK_DIM>
+    auto sadSSE2(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        auto sum = _mm_setzero_si128();
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v, a += strideA, b += strideB)
+        {
+            for (std::size_t u = 0; u < BLOCK_DIM; u += 4)
+            {
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(loadRGB4(a + u), loadRGB4(b + u)));
+            }
+        }
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+    }
+
+    template <std::size_t BLOCK_DIM>
+    auto ssdSSE2(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        auto sum = _mm_setzero_si128();
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v, a += strideA, b += strideB)
+        {
+            for (std::size_t u = 0; u < BLOCK_DIM; u += 4)
+            {
+                sum = _mm_add_epi32(sum, ssd16SSE2(loadRGB4(a + u), loadRGB4(b + u)));
+            }
+        }
+        return horizontalSum32(sum);
+    }
+#endif
+
+#ifdef BLOCKDISTANCE_AVX2
+    /// @brief Load 8 pixels, either from one row of 8 pixels or from two rows of 4 pixels, and clear the X channel
+    template <std::size_t BLOCK_DIM>
+    BLOCKDISTANCE_TARGET_AVX2 static inline auto loadRGB8(const Color::XRGB8888 *p, std::size_t stride) -> __m256i
+    {
+        __m256i result;
+        if constexpr (BLOCK_DIM == 8)
+        {
+            result = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        }
+        else
+        {
+            const auto row0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const auto row1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + stride));
+            result = _mm256_inserti128_si256(_mm256_castsi128_si256(row0), row1, 1);
+        }
+        return _mm256_and_si256(result, _mm256_set1_epi32(RGBMask));
+    }
+
+    template <std::size_t BLOCK_DIM>
+    BLOCKDISTANCE_TARGET_AVX2 auto sadAVX2(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        // every iteration handles 8 pixels = one row of 8 or two rows of 4 pixels
+        static constexpr std::size_t RowsPerStep = 8 / BLOCK_DIM;
+        auto sum = _mm256_setzero_si256();
+        for (std::size_t v = 0; v < BLOCK_DIM; v += RowsPerStep, a += RowsPerStep * strideA, b += RowsPerStep * strideB)
+        {
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(loadRGB8<BLOCK_DIM>(a, strideA), loadRGB8<BLOCK_DIM>(b, strideB)));
+        }
+        const auto sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(sum128) + _mm_cvtsi128_si32(_mm_srli_si128(sum128, 8)));
+    }
+
+    template <std::size_t BLOCK_DIM>
+    BLOCKDISTANCE_TARGET_AVX2 auto ssdAVX2(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> uint32_t
+    {
+        static constexpr std::size_t RowsPerStep = 8 / BLOCK_DIM;
+        const auto zero = _mm256_setzero_si256();
+        auto sum = _mm256_setzero_si256();
+        for (std::size_t v = 0; v < BLOCK_DIM; v += RowsPerStep, a += RowsPerStep * strideA, b += RowsPerStep * strideB)
+        {
+            const auto pa = loadRGB8<BLOCK_DIM>(a, strideA);
+            const auto pb = loadRGB8<BLOCK_DIM>(b, strideB);
+            const auto dLo = _mm256_sub_epi16(_mm256_unpacklo_epi8(pa, zero), _mm256_unpacklo_epi8(pb, zero));
+            const auto dHi = _mm256_sub_epi16(_mm256_unpackhi_epi8(pa, zero), _mm256_unpackhi_epi8(pb, zero));
+            sum = _mm256_add_epi32(sum, _mm256_add_epi32(_mm256_madd_epi16(dLo, dLo), _mm256_madd_epi16(dHi, dHi)));
+        }
+        return horizontalSum32(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+    }
+#endif
+
+    auto isSupported(Kernel kernel) -> bool
+    {
+        switch (kernel)
+        {
+        case Kernel::Scalar:
+            return true;
+#ifdef BLOCKDISTANCE_SSE2
+        case Kernel::SSE2:
+            return true;
+#endif
+#ifdef BLOCKDISTANCE_AVX2
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    auto bestKernel() -> Kernel
+    {
+        static const Kernel kernel = isSupported(Kernel::AVX2) ? Kernel::AVX2 : (isSupported(Kernel::SSE2) ? Kernel::SSE2 : Kernel::Scalar);
+        return kernel;
+    }
+
+    template <std::size_t BLOCK_DIM>
+    auto sad(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t
+    {
+        static_assert(BLOCK_DIM == 4 || BLOCK_DIM == 8, "Block dimension must be 4 or 8");
+        switch (kernel)
+        {
+#ifdef BLOCKDISTANCE_AVX2
+        case Kernel::AVX2:
+            return sadAVX2<BLOCK_DIM>(a, strideA, b, strideB);
+#endif
+#ifdef BLOCKDISTANCE_SSE2
+        case Kernel::SSE2:
+            return sadSSE2<BLOCK_DIM>(a, strideA, b, strideB);
+#endif
+        case Kernel::Scalar:
+            return sadScalar<BLOCK_DIM>(a, strideA, b, strideB);
+        default:
+            THROW(std::runtime_error, "Block distance kernel not supported");
+        }
+    }
+
+    template <std::size_t BLOCK_DIM>
+    auto ssd(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t
+    {
+        static_assert(BLOCK_DIM == 4 || BLOCK_DIM == 8, "Block dimension must be 4 or 8");
+        switch (kernel)
+        {
+#ifdef BLOCKDISTANCE_AVX2
+        case Kernel::AVX2:
+            return ssdAVX2<BLOCK_DIM>(a, strideA, b, strideB);
+#endif
+#ifdef BLOCKDISTANCE_SSE2
+        case Kernel::SSE2:
+            return ssdSSE2<BLOCK_DIM>(a, strideA, b, strideB);
+#endif
+        case Kernel::Scalar:
+            return ssdScalar<BLOCK_DIM>(a, strideA, b, strideB);
+        default:
+            THROW(std::runtime_error, "Block distance kernel not supported");
+        }
+    }
+
+    template auto sad<4>(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t;
+    template auto sad<8>(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t;
+    template auto ssd<4>(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t;
+    template auto ssd<8>(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel) -> uint32_t;
+}
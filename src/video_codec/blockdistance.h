@@ -0,0 +1,53 @@
+#pragma once
+
+#include "color/xrgb8888.h"
+
+#include <cstdint>
+
+namespace Video::BlockDistance
+{
+    /// @brief Implementation used for calculating block distances
+    enum class Kernel
+    {
+        Scalar, // Portable C++ code
+        SSE2,   // x86 SSE2 intrinsics
+        AVX2    // x86 AVX2 intrinsics
+    };
+
+    /// @brief Check if a kernel can be used on this machine
+    auto isSupported(Kernel kernel) -> bool;
+
+    /// @brief Fastest kernel supported on this machine. Detected once at runtime
+    auto bestKernel() -> Kernel;
+
+    /// @brief Calculate sum of absolute differences of the R, G and B channels of two blocks of BLOCK_DIM x BLOCK_DIM pixels.
+    /// The X channel is ignored. BLOCK_DIM must be 4 or 8
+    /// @param a Pointer to first pixel of block a
+    /// @param strideA Distance between rows of block a in pixels
+    /// @param b Pointer to first pixel of block b
+    /// @param strideB Distance between rows of block b in pixels
+    /// @param kernel Implementation to use. Must be supported on this machine
+    template <std::size_t BLOCK_DIM>
+    auto sad(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel = bestKernel()) -> uint32_t;
+
+    /// @brief Calculate sum of squared differences of the R, G and B channels of two blocks of BLOCK_DIM x BLOCK_DIM pixels.
+    /// The X channel is ignored. BLOCK_DIM must be 4 or 8
+    /// @param a Pointer to first pixel of block a
+    /// @param strideA Distance between rows of block a in pixels
+    /// @param b Pointer to first pixel of block b
+    /// @param strideB Distance between rows of block b in pixels
+    /// @param kernel Implementation to use. Must be supported on this machine
+    template <std::size_t BLOCK_DIM>
+    auto ssd(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB, Kernel kernel = bestKernel()) -> uint32_t;
+
+    /// @brief Convert a sum of squared differences to a lower bound of the perceptual block error XRGB8888::mse() averaged over a BLOCK_DIM x BLOCK_DIM block.
+    /// XRGB8888::mse() weighs the squared red and blue differences by at least 2/9 and the green differences by 4/9, so
+    /// the perceptual error of a block is never smaller than this value. Candidates with a bound >= the best error can be skipped
+    template <std::size_t BLOCK_DIM>
+    constexpr auto mseLowerBound(uint32_t ssd) -> float
+    {
+        // slightly reduce bound to account for float rounding in the perceptual error
+        constexpr float Scale = 0.999F * 2.0F / (9.0F * 255.0F * 255.0F * static_cast<float>(BLOCK_DIM * BLOCK_DIM));
+        return Scale * static_cast<float>(ssd);
+    }
+}
@@ -181,6 +181,17 @@ public:
         return result;
     }
 
+    /// @brief Return block pixels as deep-copy compact array. Does not allocate heap memory
+    auto pixelArray() const -> std::array<value_type, Dim * Dim>
+    {
+        std::array<value_type, Dim * Dim> result;
+        for (std::size_t i = 0; i < Dim * Dim; ++i)
+        {
+            result[i] = m_pixels[m_indices[i]];
+        }
+        return result;
+    }
+
     /// @brief Deep copy pixels from other block into this one
     auto copyPixelsFrom(const BlockView &other) -> void
     {
@@ -358,6 +369,17 @@ public:
         return result;
     }
 
+    /// @brief Return block pixels as deep-copy compact array. Does not allocate heap memory
+    auto pixelArray() const -> std::array<value_type, Dim * Dim>
+    {
+        std::array<value_type, Dim * Dim> result;
+        for (std::size_t i = 0; i < Dim * Dim; ++i)
+        {
+            result[i] = m_pixels[m_indices[i]];
+        }
+        return result;
+    }
+
     /// @brief Deep copy pixels from other block into this one
     auto copyPixelsFrom(const BlockView &other) -> void
     {
@@ -1,12 +1,15 @@
 #pragma once
 
+#include "blockdistance.h"
 #include "blockview.h"
 #include "color/conversions.h"
 #include "color/psnr.h"
 
 #include <array>
+#include <cassert>
 #include <memory>
 #include <optional>
+#include <span>
 #include <type_traits>
 #include <variant>
 #include <vector>
@@ -144,16 +147,16 @@ public:
 
     /// @brief Get pixel data for an arbitrary block at full resolution
     template <std::size_t BLOCK_DIM = BlockMaxDim>
-    auto blockPixels(uint32_t blockX, uint32_t blockY) const -> std::vector<COLOR_TYPE>
+    auto blockPixels(uint32_t blockX, uint32_t blockY) const -> std::array<COLOR_TYPE, BLOCK_DIM * BLOCK_DIM>
     {
         REQUIRE(blockX + BLOCK_DIM <= m_width, std::runtime_error, "Block x out of range");
         REQUIRE(blockY + BLOCK_DIM <= m_height, std::runtime_error, "Block y out of range");
-        std::vector<COLOR_TYPE> result;
-        result.reserve(BLOCK_DIM * BLOCK_DIM);
+        std::array<COLOR_TYPE, BLOCK_DIM * BLOCK_DIM> result;
+        auto rIt = result.begin();
         auto pIt = std::next(m_pixels.cbegin(), blockY * m_width + blockX);
         for (uint32_t v = 0; v < BLOCK_DIM; ++v)
         {
-            std::copy(pIt, std::next(pIt, BLOCK_DIM), std::back_inserter(result));
+            rIt = std::copy(pIt, std::next(pIt, BLOCK_DIM), rIt);
             pIt = std::next(pIt, m_width);
         }
         return result;
@@ -168,13 +171,13 @@ public:
     /// @brief Calculate mean squared error between pixels and block in image (scalar product)
     /// @return Returns average color distance in [0,1]
     template <std::size_t BLOCK_DIM = BlockMaxDim>
-    auto mse(const std::vector<COLOR_TYPE> &block, const uint32_t x, const uint32_t y) const -> float
+    auto mse(std::span<const COLOR_TYPE> block, const uint32_t x, const uint32_t y) const -> float
     {
-        REQUIRE(block.size() == BLOCK_DIM * BLOCK_DIM, std::runtime_error, "Block size does not match");
-        REQUIRE(x + BLOCK_DIM <= m_width, std::runtime_error, "Block x out of range");
-        REQUIRE(y + BLOCK_DIM <= m_height, std::runtime_error, "Block y out of range");
+        // called for every motion search candidate that passes the ssd() bound, so only check in debug builds
+        assert(block.size() == BLOCK_DIM * BLOCK_DIM);
+        assert(x + BLOCK_DIM <= m_width && y + BLOCK_DIM <= m_height);
         float dist = 0.0F;
-        auto bIt = block.cbegin();
+        auto bIt = block.begin();
         auto pIt = std::next(m_pixels.cbegin(), y * m_width + x);
         for (uint32_t v = 0; v < BLOCK_DIM; ++v)
         {
@@ -187,6 +190,18 @@ public:
         return static_cast<float>(dist / (BLOCK_DIM * BLOCK_DIM));
     }
 
+    /// @brief Calculate integer sum of squared R, G, B differences between pixels and block in image using SIMD code if available
+    /// @note Only available for XRGB8888 codebooks and block dimensions 4 and 8
+    template <std::size_t BLOCK_DIM = BlockMaxDim>
+    auto ssd(std::span<const COLOR_TYPE> block, const uint32_t x, const uint32_t y) const -> uint32_t
+    {
+        static_assert(std::is_same<COLOR_TYPE, Color::XRGB8888>(), "Integer block distance only supported for XRGB8888");
+        // called for every motion search candidate, so only check in debug builds
+        assert(block.size() == BLOCK_DIM * BLOCK_DIM);
+        assert(x + BLOCK_DIM <= m_width && y + BLOCK_DIM <= m_height);
+        return Video::BlockDistance::ssd<BLOCK_DIM>(m_pixels.data() + y * m_width + x, m_width, block.data(), BLOCK_DIM);
+    }
+
 private:
     uint32_t m_width = 0;
     uint32_t m_height = 0;
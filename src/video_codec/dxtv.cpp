@@ -1,7 +1,9 @@
 #include "dxtv.h"
 
+#include "blockdistance.h"
 #include "blockview.h"
 #include "codebook.h"
+#include "scenecut.h"
 #include "color/conversions.h"
 #include "color/psnr.h"
 #include "color/rgbf.h"
@@ -17,10 +19,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cassert>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -29,177 +35,459 @@ using namespace Color;
 namespace Video
 {
 
-    /// @brief Search for entry in codebook with minimum error
-    /// @return Returns (error, x offset, y offset) if usable entry found or empty optional, if not
+    /// @brief Region a block reference can be searched in. Clamped to the frame and, for the current frame, to already encoded blocks
+    struct MotionSearchWindow
+    {
+        int32_t xStart = 0;      // Minimum x position of referenced block
+        int32_t xEnd = 0;        // Maximum x position of referenced block
+        int32_t yStart = 0;      // Minimum y position of referenced block
+        int32_t yEnd = 0;        // Maximum y position of referenced block
+        int32_t xEndCurrent = 0; // Maximum x position of referenced block if it overlaps the current macro-block line
+        int32_t yMacroBlock = 0; // Start of current macro-block line
+        int32_t blockDim = 0;    // Size of block
+        bool fromCurr = false;   // If true the window is in the current frame
+
+        /// @brief Check if a block can be referenced at position x, y
+        auto contains(int32_t x, int32_t y) const -> bool
+        {
+            if (x < xStart || x > xEnd || y < yStart || y > yEnd)
+            {
+                return false;
+            }
+            return !fromCurr || (y + blockDim) <= yMacroBlock || x <= xEndCurrent;
+        }
+    };
+
+    /// @brief Block encoder statistics. Accumulated per block line and added to the frame statistics when the line is done,
+    /// so encoding a block neither allocates memory nor locks the statistics
+    struct EncoderCounters
+    {
+        std::array<uint32_t, Dxtv::CodeBook8x8::BlockLevels> motionBlocksPrev = {}; // Number of blocks referencing the previous frame per block level
+        std::array<uint32_t, Dxtv::CodeBook8x8::BlockLevels> motionBlocksCurr = {}; // Number of blocks referencing the current frame per block level
+        std::array<uint32_t, Dxtv::CodeBook8x8::BlockLevels> dxtBlocks = {};        // Number of DXT-encoded blocks per block level
+        uint64_t motionCandidates = 0;                                               // Number of motion search positions evaluated
+        uint64_t motionVerified = 0;                                                 // Number of motion search positions verified using the perceptual error
+        uint64_t splitsAbandoned = 0;                                                // Number of block splits evaluated, but not used
+    };
+
+    /// @brief Add non-zero encoder counters to statistics
+    auto addToStatistics(Statistics::Frame::SPtr statistics, const EncoderCounters &counters) -> void
+    {
+        if (statistics == nullptr)
+        {
+            return;
+        }
+        for (std::size_t level = 0; level < Dxtv::CodeBook8x8::BlockLevels; ++level)
+        {
+            if (counters.motionBlocksPrev[level] > 0)
+            {
+                statistics->incValue("motionBlocksPrev", counters.motionBlocksPrev[level], level);
+            }
+            if (counters.motionBlocksCurr[level] > 0)
+            {
+                statistics->incValue("motionBlocksCurr", counters.motionBlocksCurr[level], level);
+            }
+            if (counters.dxtBlocks[level] > 0)
+            {
+                statistics->incValue("dxtBlocks", counters.dxtBlocks[level], level);
+            }
+        }
+        statistics->incValue("motionCandidates", counters.motionCandidates);
+        statistics->incValue("motionVerified", counters.motionVerified);
+        statistics->incValue("splitsAbandoned", counters.splitsAbandoned);
+    }
+
+    /// @brief Result of a motion search
+    struct MotionSearchResult
+    {
+        float error = std::numeric_limits<float>::max(); // Perceptual error of best block found
+        int32_t offsetX = 0;                             // Horizontal offset of best block found
+        int32_t offsetY = 0;                             // Vertical offset of best block found
+        uint32_t nrOfCandidates = 0;                     // Number of positions evaluated using the integer block distance
+        uint32_t nrOfVerified = 0;                       // Number of positions verified using the perceptual error
+    };
+
+    /// @brief Check if block at position x, y could be better than the current best result using the integer block distance.
+    /// If so, calculate its perceptual error and return true if it is better than the current best result.
+    /// The integer block distance is returned in ssd
     template <std::size_t BLOCK_DIM>
-    auto findBestMatchingBlockMotion(const Dxtv::CodeBook8x8 &codeBook, const BlockView<XRGB8888, bool, BLOCK_DIM> &block, float allowedError, bool fromCurrCodeBook) -> std::optional<std::tuple<float, int32_t, int32_t>>
+    auto evaluateMotionCandidate(const Dxtv::CodeBook8x8 &codeBook, const std::array<XRGB8888, BLOCK_DIM * BLOCK_DIM> &blockPixels, int32_t x, int32_t y, float maxError, uint32_t &ssd, float &error, MotionSearchResult &result) -> bool
     {
-        using return_type = std::tuple<float, int32_t, int32_t>;
-        if (codeBook.empty())
+        ++result.nrOfCandidates;
+        ssd = codeBook.ssd<BLOCK_DIM>(blockPixels, x, y);
+        if (BlockDistance::mseLowerBound<BLOCK_DIM>(ssd) >= maxError)
         {
-            return std::optional<return_type>();
+            return false;
         }
+        ++result.nrOfVerified;
+        error = codeBook.mse<BLOCK_DIM>(blockPixels, x, y);
+        return error < maxError;
+    }
+
+    /// @brief Calculate search window for motion search in previous or current frame
+    template <std::size_t BLOCK_DIM>
+    auto getMotionSearchWindow(const Dxtv::CodeBook8x8 &codeBook, int32_t blockX, int32_t blockY, bool fromCurrCodeBook) -> MotionSearchWindow
+    {
         const auto offsetH = fromCurrCodeBook ? Dxtv::CurrMotionHOffset : Dxtv::PrevMotionHOffset;
         const auto offsetV = fromCurrCodeBook ? Dxtv::CurrMotionVOffset : Dxtv::PrevMotionVOffset;
-        // calculate start and end of motion search
-        const int32_t blockX = block.x();
-        const int32_t blockY = block.y();
         const int32_t xMax = codeBook.width() - static_cast<int32_t>(BLOCK_DIM);
         const int32_t yMax = codeBook.height() - static_cast<int32_t>(BLOCK_DIM);
+        MotionSearchWindow window;
+        window.blockDim = static_cast<int32_t>(BLOCK_DIM);
+        window.fromCurr = fromCurrCodeBook;
         // clamp search range to frame
-        const int32_t xStart = (blockX + offsetH.first) < 0 ? 0 : (blockX + offsetH.first);
-        const int32_t xEnd = (blockX + offsetH.second) > xMax ? xMax : (blockX + offsetH.second);
-        const int32_t yStart = (blockY + offsetV.first) < 0 ? 0 : (blockY + offsetV.first);
+        window.xStart = (blockX + offsetH.first) < 0 ? 0 : (blockX + offsetH.first);
+        window.xEnd = (blockX + offsetH.second) > xMax ? xMax : (blockX + offsetH.second);
+        window.yStart = (blockY + offsetV.first) < 0 ? 0 : (blockY + offsetV.first);
         const int32_t yEnd = (blockY + offsetV.second) > yMax ? yMax : (blockY + offsetV.second);
         // if we're searching in the current codebook, do not allow searching past the already decoded macro-block
-        const int32_t yMacroBlock = blockY - (blockY % DxtvConstants::BLOCK_MAX_DIM);
-        const int32_t vEnd = fromCurrCodeBook && yEnd > (yMacroBlock + DxtvConstants::BLOCK_MAX_DIM - BLOCK_DIM) ? (yMacroBlock + DxtvConstants::BLOCK_MAX_DIM - BLOCK_DIM) : yEnd;
-        // search similar blocks
-        const auto blockPixels = block.pixels();
-        return_type bestMotion = {std::numeric_limits<float>::max(), 0, 0};
-        for (int32_t y = yStart; y <= vEnd; ++y)
+        const int32_t macroBlockDim = static_cast<int32_t>(DxtvConstants::BLOCK_MAX_DIM);
+        window.yMacroBlock = blockY - (blockY % macroBlockDim);
+        const int32_t yEndMacroBlock = window.yMacroBlock + macroBlockDim - static_cast<int32_t>(BLOCK_DIM);
+        window.yEnd = fromCurrCodeBook && yEnd > yEndMacroBlock ? yEndMacroBlock : yEnd;
+        // make sure we're not searching in blocks not encoded yet
+        window.xEndCurrent = fromCurrCodeBook ? blockX - static_cast<int32_t>(BLOCK_DIM) : window.xEnd;
+        return window;
+    }
+
+    /// @brief Exhaustively search all positions in window for block with minimum error
+    template <std::size_t BLOCK_DIM>
+    auto searchExhaustive(const Dxtv::CodeBook8x8 &codeBook, const std::array<XRGB8888, BLOCK_DIM * BLOCK_DIM> &blockPixels, int32_t blockX, int32_t blockY, const MotionSearchWindow &window, float allowedError) -> MotionSearchResult
+    {
+        MotionSearchResult bestMotion;
+        uint32_t ssd = 0;
+        float error = 0.0F;
+        for (int32_t y = window.yStart; y <= window.yEnd; ++y)
         {
             // if we're searching in the current codebook, do not search past the last decoded macro-block
-            auto hEnd = xEnd;
-            if (fromCurrCodeBook && (y + static_cast<int32_t>(BLOCK_DIM)) > yMacroBlock)
+            const auto hEnd = (window.fromCurr && (y + window.blockDim) > window.yMacroBlock) ? window.xEndCurrent : window.xEnd;
+            for (int32_t x = window.xStart; x <= hEnd; ++x)
             {
-                // make sure we're not searching in blocks not encoded yet
-                hEnd = blockX - static_cast<int32_t>(BLOCK_DIM);
-            }
-            for (int32_t x = xStart; x <= hEnd; ++x)
-            {
-                auto error = codeBook.mse<BLOCK_DIM>(blockPixels, x, y);
-                if (error < allowedError && error < std::get<0>(bestMotion))
+                if (evaluateMotionCandidate<BLOCK_DIM>(codeBook, blockPixels, x, y, std::min(allowedError, bestMotion.error), ssd, error, bestMotion))
                 {
-                    bestMotion = {error, x - blockX, y - blockY};
+                    bestMotion.error = error;
+                    bestMotion.offsetX = x - blockX;
+                    bestMotion.offsetY = y - blockY;
                 }
             }
         }
-        return std::get<0>(bestMotion) < allowedError ? bestMotion : std::optional<return_type>();
+        return bestMotion;
+    }
+
+    /// @brief Search for block with minimum error using a predictor-seeded diamond search.
+    /// Starts from zero motion, the neighboring blocks and two coarse rings of positions, then
+    /// walks a large diamond pattern until the center is the best position and refines using a small diamond.
+    /// The walk follows the integer block distance, which is calculated for every position anyway, so it can
+    /// descend through positions above the allowed error, while the perceptual error is only calculated for
+    /// positions that could beat both the allowed error and the best block found so far.
+    /// Evaluates only a fraction of the positions of searchExhaustive(), but might only find a local minimum
+    template <std::size_t BLOCK_DIM>
+    auto searchDiamond(const Dxtv::CodeBook8x8 &codeBook, const std::array<XRGB8888, BLOCK_DIM * BLOCK_DIM> &blockPixels, int32_t blockX, int32_t blockY, const MotionSearchWindow &window, float allowedError) -> MotionSearchResult
+    {
+        static constexpr int32_t D = static_cast<int32_t>(BLOCK_DIM);
+        static constexpr int32_t R = static_cast<int32_t>(DxtvConstants::BLOCK_MAX_DIM);
+        static constexpr int32_t H = R / 2;
+        static constexpr std::array<std::pair<int32_t, int32_t>, 21> SeedOffsets = {{{0, 0}, {-D, 0}, {0, -D}, {-D, -D}, {D, -D}, {-H, -H}, {0, -H}, {H, -H}, {-H, 0}, {H, 0}, {-H, H}, {0, H}, {H, H}, {-R, -R}, {0, -R}, {R, -R}, {-R, 0}, {R, 0}, {-R, R}, {0, R}, {R, R}}};
+        static constexpr std::array<std::pair<int32_t, int32_t>, 8> LargeDiamond = {{{0, -2}, {1, -1}, {2, 0}, {1, 1}, {0, 2}, {-1, 1}, {-2, 0}, {-1, -1}}};
+        static constexpr std::array<std::pair<int32_t, int32_t>, 4> SmallDiamond = {{{0, -1}, {1, 0}, {0, 1}, {-1, 0}}};
+        // offsets are in [-15,16], so a bit field of 32x32 bits is enough to store which positions have been evaluated
+        static constexpr int32_t OffsetBias = DxtvConstants::BLOCK_HALF_RANGE;
+        std::array<uint32_t, 1 << DxtvConstants::BLOCK_MOTION_BITS> visited = {};
+        MotionSearchResult bestMotion;
+        uint32_t centerSsd = std::numeric_limits<uint32_t>::max();
+        int32_t centerX = 0;
+        int32_t centerY = 0;
+        uint32_t ssd = 0;
+        float error = 0.0F;
+        // evaluate a position and return true if it is the new center of the search pattern
+        auto evaluate = [&](int32_t offsetX, int32_t offsetY) -> bool
+        {
+            const int32_t x = blockX + offsetX;
+            const int32_t y = blockY + offsetY;
+            if (offsetX < -OffsetBias || offsetX > OffsetBias + 1 || offsetY < -OffsetBias || offsetY > OffsetBias + 1 || !window.contains(x, y))
+            {
+                return false;
+            }
+            auto &visitedLine = visited[offsetY + OffsetBias];
+            const uint32_t visitedBit = uint32_t(1) << (offsetX + OffsetBias);
+            if (visitedLine & visitedBit)
+            {
+                return false;
+            }
+            visitedLine |= visitedBit;
+            if (evaluateMotionCandidate<BLOCK_DIM>(codeBook, blockPixels, x, y, std::min(allowedError, bestMotion.error), ssd, error, bestMotion))
+            {
+                bestMotion.error = error;
+                bestMotion.offsetX = offsetX;
+                bestMotion.offsetY = offsetY;
+            }
+            if (ssd < centerSsd)
+            {
+                centerSsd = ssd;
+                centerX = offsetX;
+                centerY = offsetY;
+                return true;
+            }
+            return false;
+        };
+        for (const auto &seed : SeedOffsets)
+        {
+            evaluate(seed.first, seed.second);
+        }
+        // check if we found any valid position
+        if (bestMotion.nrOfCandidates == 0)
+        {
+            return bestMotion;
+        }
+        // move large diamond until center is the best position. terminates, because the distance must decrease with every move
+        bool centerMoved = true;
+        while (centerMoved)
+        {
+            centerMoved = false;
+            const auto patternX = centerX;
+            const auto patternY = centerY;
+            for (const auto &offset : LargeDiamond)
+            {
+                centerMoved = evaluate(patternX + offset.first, patternY + offset.second) || centerMoved;
+            }
+        }
+        // refine using small diamond
+        const auto patternX = centerX;
+        const auto patternY = centerY;
+        for (const auto &offset : SmallDiamond)
+        {
+            evaluate(patternX + offset.first, patternY + offset.second);
+        }
+        return bestMotion;
+    }
+
+    /// @brief Search for entry in codebook with minimum error
+    /// @return Returns (error, x offset, y offset) if usable entry found or empty optional, if not
+    template <std::size_t BLOCK_DIM>
+    auto findBestMatchingBlockMotion(const Dxtv::CodeBook8x8 &codeBook, const BlockView<XRGB8888, bool, BLOCK_DIM> &block, float allowedError, bool fromCurrCodeBook, Dxtv::MotionSearch motionSearch, EncoderCounters &counters) -> std::optional<std::tuple<float, int32_t, int32_t>>
+    {
+        using return_type = std::tuple<float, int32_t, int32_t>;
+        if (codeBook.empty())
+        {
+            return std::optional<return_type>();
+        }
+        // calculate start and end of motion search
+        const int32_t blockX = block.x();
+        const int32_t blockY = block.y();
+        const auto window = getMotionSearchWindow<BLOCK_DIM>(codeBook, blockX, blockY, fromCurrCodeBook);
+        // search similar blocks
+        const auto blockPixels = block.pixelArray();
+        const auto result = motionSearch == Dxtv::MotionSearch::Fast ? searchDiamond<BLOCK_DIM>(codeBook, blockPixels, blockX, blockY, window, allowedError) : searchExhaustive<BLOCK_DIM>(codeBook, blockPixels, blockX, blockY, window, allowedError);
+        counters.motionCandidates += result.nrOfCandidates;
+        counters.motionVerified += result.nrOfVerified;
+        return result.error < allowedError ? return_type{result.error, result.offsetX, result.offsetY} : std::optional<return_type>();
     }
 
+    /// @brief Compressed data of a block. Large enough for an 8x8 block split into 4 4x4 DXT blocks
+    struct BlockData
+    {
+        std::array<uint8_t, 4 * DXT::BlockSize<DxtvConstants::BLOCK_MIN_DIM>> bytes;
+        std::size_t size = 0;
+
+        template <std::size_t N>
+        auto append(const std::array<uint8_t, N> &values) -> void
+        {
+            assert(size + N <= bytes.size());
+            std::copy(values.cbegin(), values.cend(), std::next(bytes.begin(), size));
+            size += N;
+        }
+
+        auto append(const BlockData &other) -> void
+        {
+            assert(size + other.size <= bytes.size());
+            std::copy(other.bytes.cbegin(), std::next(other.bytes.cbegin(), other.size), std::next(bytes.begin(), size));
+            size += other.size;
+        }
+    };
+
+    // Rate-distortion cost of a block mode is J = D + lambda * R, with D being the sum of the perceptual pixel errors of the block
+    // and R the number of bits needed to store it. lambda is allowedError * RDLambdaScale, so a mode needing one more byte must
+    // reduce the error of 8 pixels by allowedError to be chosen. Block split flags are sent for every 8x8 block, so they cost the same for all modes.
+    // References and 8x8 DXT blocks must still be within allowedError, so the cost only decides between the modes that meet the quality setting.
+    // 4x4 DXT blocks can not be split anymore and are the fallback for any error
+    static constexpr float RDLambdaScale = 0.5F;
+    static constexpr float RDRefBits = 16;                                                        // Size of a motion-compensated block
+    static constexpr float RDDxtBits4x4 = DXT::BlockSize<DxtvConstants::BLOCK_MIN_DIM> * 8;      // Size of a 4x4 DXT block
+    static constexpr float RDDxtBits8x8 = DXT::BlockSize<DxtvConstants::BLOCK_MAX_DIM> * 8;      // Size of an 8x8 DXT block
+    static constexpr float RDNoCost = std::numeric_limits<float>::max();                          // No candidate found or no cost limit
+
+    /// @brief Build motion-compensated block data
+    auto buildReference(int32_t offsetX, int32_t offsetY, bool fromPrev) -> std::array<uint8_t, 2>
+    {
+        // convert offsets to unsigned value
+        offsetX += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
+        offsetY += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
+        // store reference to previous or current frame
+        uint16_t refData = DxtvConstants::BLOCK_IS_REF;
+        refData |= fromPrev ? DxtvConstants::BLOCK_FROM_PREV : DxtvConstants::BLOCK_FROM_CURR;
+        refData |= (offsetY & DxtvConstants::BLOCK_MOTION_MASK) << DxtvConstants::BLOCK_MOTION_Y_SHIFT;
+        refData |= (offsetX & DxtvConstants::BLOCK_MOTION_MASK);
+        return {static_cast<uint8_t>(refData & 0xFF), static_cast<uint8_t>((refData >> 8) & 0xFF)};
+    }
+
+    /// @brief Compress image block to DXTV format choosing the block mode with the lowest rate-distortion cost.
+    /// Modes that can not beat the best cost found so far or maxCost are skipped, e.g. block splits that are already more expensive after some sub-blocks.
+    /// If a block mode is found, the block pixels in the current codebook are replaced by the decoded pixels and the compressed data is appended to data.
+    /// Uses only fixed-size buffers on the stack, so no heap memory is allocated
+    /// @param maxCost Rate-distortion cost the block must beat. Pass RDNoCost to always encode the block
+    /// @return Returns (true if the block was split, rate-distortion cost) or an empty optional if no block mode beats maxCost
     template <std::size_t BLOCK_DIM>
-    auto encodeBlockInternal(Dxtv::CodeBook8x8 &currentCodeBook, const Dxtv::CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, BLOCK_DIM> &block, float quality, const bool swapToBGR, Statistics::Frame::SPtr statistics) -> std::pair<bool, std::vector<uint8_t>>
+    auto encodeBlockInternal(Dxtv::CodeBook8x8 &currentCodeBook, const Dxtv::CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, BLOCK_DIM> &block, float quality, const bool swapToBGR, Dxtv::MotionSearch motionSearch, Dxtv::ModeDecision modeDecision, float maxCost, BlockData &data, EncoderCounters &counters) -> std::optional<std::pair<bool, float>>
     {
         static_assert(DxtvConstants::BLOCK_MAX_DIM >= BLOCK_DIM);
         static constexpr std::size_t BLOCK_LEVEL = std::log2(DxtvConstants::BLOCK_MAX_DIM) - std::log2(BLOCK_DIM);
-        bool blockWasSplit = DxtvConstants::BLOCK_NO_SPLIT;
-        std::vector<uint8_t> data;
+        static constexpr float NrOfPixels = BLOCK_DIM * BLOCK_DIM;
+        static constexpr float DxtBits = BLOCK_DIM == DxtvConstants::BLOCK_MAX_DIM ? RDDxtBits8x8 : RDDxtBits4x4;
         // calculate allowed MSE for blocks. Map from [0, 100] to [1, 0]
         const float allowedError = std::pow((100.0F - quality) / 100.0F, 2.0F);
-        // Try to find x/y motion block within error from previous frame
-        auto prevRef = findBestMatchingBlockMotion(previousCodeBook, block, allowedError, false);
-        // Try to find x/y motion block within error from current frame
-        auto currRef = findBestMatchingBlockMotion(currentCodeBook, block, allowedError, true);
-        // Choose the better one of both block references
-        const bool prevRefIsBetter = prevRef.has_value() && (!currRef.has_value() || std::get<0>(prevRef.value()) <= std::get<0>(currRef.value()));
-        const bool currRefIsBetter = currRef.has_value() && (!prevRef.has_value() || std::get<0>(currRef.value()) <= std::get<0>(prevRef.value()));
-        if (prevRefIsBetter)
+        const float lambda = RDLambdaScale * allowedError;
+        // with first-fit mode decision, a mode within the allowed error costs nothing, so no later mode can beat it
+        const bool rateDistortion = modeDecision == Dxtv::ModeDecision::RateDistortion;
+        // Try to find x/y motion block within error from previous and current frame and choose the better one.
+        // A reference must also beat maxCost and the reference from the current frame must beat the one from the previous frame
+        const float refMaxError = std::min(allowedError, (maxCost - lambda * RDRefBits) / NrOfPixels);
+        std::optional<std::tuple<float, int32_t, int32_t>> prevRef;
+        std::optional<std::tuple<float, int32_t, int32_t>> currRef;
+        if (refMaxError > 0.0F)
         {
-            // check offset range
-            auto offsetX = std::get<1>(prevRef.value());
-            auto offsetY = std::get<2>(prevRef.value());
-            REQUIRE(Dxtv::PrevMotionHOffset.first <= offsetX && offsetX <= Dxtv::PrevMotionHOffset.second, std::runtime_error, "Reference block x offset out of range for previous frame");
-            REQUIRE(Dxtv::PrevMotionVOffset.first <= offsetY && offsetY <= Dxtv::PrevMotionVOffset.second, std::runtime_error, "Reference block y offset out of range for previous frame");
-            REQUIRE(static_cast<int32_t>(block.x()) + offsetX >= 0 && static_cast<int32_t>(block.y()) + offsetY >= 0, std::runtime_error, "Reference block coordinates out of bounds");
-            REQUIRE(static_cast<int32_t>(block.x()) + offsetX + BLOCK_DIM <= previousCodeBook.width() && static_cast<int32_t>(block.y()) + offsetY + BLOCK_DIM <= previousCodeBook.height(), std::runtime_error, "Reference block coordinates out of bounds");
-            block.copyPixelsFrom(previousCodeBook.blockPixels<BLOCK_DIM>(static_cast<int32_t>(block.x()) + offsetX, static_cast<int32_t>(block.y()) + offsetY));
-            // convert offsets to unsigned value
-            offsetX += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
-            offsetY += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
-            // store reference to previous frame
-            uint16_t refData = DxtvConstants::BLOCK_IS_REF;
-            refData |= DxtvConstants::BLOCK_FROM_PREV;
-            refData |= (offsetY & DxtvConstants::BLOCK_MOTION_MASK) << DxtvConstants::BLOCK_MOTION_Y_SHIFT;
-            refData |= (offsetX & DxtvConstants::BLOCK_MOTION_MASK);
-            data.push_back(refData & 0xFF);
-            data.push_back((refData >> 8) & 0xFF);
-            Statistics::incValue(statistics, "motionBlocksPrev", 1, BLOCK_LEVEL);
+            prevRef = findBestMatchingBlockMotion(previousCodeBook, block, refMaxError, false, motionSearch, counters);
+            currRef = findBestMatchingBlockMotion(currentCodeBook, block, prevRef.has_value() ? std::get<0>(prevRef.value()) : refMaxError, true, motionSearch, counters);
         }
-        else if (currRefIsBetter)
+        const bool prevRefIsBetter = prevRef.has_value() && !currRef.has_value();
+        const auto &bestRef = prevRefIsBetter ? prevRef : currRef;
+        const float refCost = bestRef.has_value() ? (rateDistortion ? std::get<0>(bestRef.value()) * NrOfPixels + lambda * RDRefBits : 0.0F) : RDNoCost;
+        float bestCost = std::min(maxCost, refCost);
+        // DXT-encode full block if it can still beat the best cost
+        std::array<uint8_t, DXT::BlockSize<BLOCK_DIM>> encodedBlock;
+        std::array<XRGB8888, BLOCK_DIM * BLOCK_DIM> decodedBlock;
+        bool dxtIsBest = false;
+        if (bestCost > lambda * DxtBits)
         {
-            // check offset range
-            auto offsetX = std::get<1>(currRef.value());
-            auto offsetY = std::get<2>(currRef.value());
-            REQUIRE(Dxtv::CurrMotionHOffset.first <= offsetX && offsetX <= Dxtv::CurrMotionHOffset.second, std::runtime_error, "Reference block x offset out of range for current frame");
-            REQUIRE(Dxtv::CurrMotionVOffset.first <= offsetY && offsetY <= Dxtv::CurrMotionVOffset.second, std::runtime_error, "Reference block y offset out of range for current frame");
-            REQUIRE(static_cast<int32_t>(block.x()) + offsetX >= 0 && static_cast<int32_t>(block.y()) + offsetY >= 0, std::runtime_error, "Reference block coordinates out of bounds");
-            REQUIRE(static_cast<int32_t>(block.x()) + offsetX + BLOCK_DIM <= currentCodeBook.width() && static_cast<int32_t>(block.y()) + offsetY + BLOCK_DIM <= currentCodeBook.height(), std::runtime_error, "Reference block coordinates out of bounds");
-            block.copyPixelsFrom(currentCodeBook.blockPixels<BLOCK_DIM>(static_cast<int32_t>(block.x()) + offsetX, static_cast<int32_t>(block.y()) + offsetY));
-            // convert offsets to unsigned value
-            offsetX += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
-            offsetY += ((1 << DxtvConstants::BLOCK_MOTION_BITS) / 2 - 1);
-            // store reference to current frame
-            uint16_t refData = DxtvConstants::BLOCK_IS_REF;
-            refData |= DxtvConstants::BLOCK_FROM_CURR;
-            refData |= (offsetY & DxtvConstants::BLOCK_MOTION_MASK) << DxtvConstants::BLOCK_MOTION_Y_SHIFT;
-            refData |= (offsetX & DxtvConstants::BLOCK_MOTION_MASK);
-            data.push_back(refData & 0xFF);
-            data.push_back((refData >> 8) & 0xFF);
-            Statistics::incValue(statistics, "motionBlocksCurr", 1, BLOCK_LEVEL);
-        }
-        else
-        {
-            // No good references found. DXT-encode full block
-            auto rawBlock = block.pixels();
-            auto encodedBlock = DXT::encodeBlock<BLOCK_DIM>(rawBlock, false, swapToBGR);
-            auto decodedBlock = DXT::decodeBlock<BLOCK_DIM>(encodedBlock, false, swapToBGR);
-            if constexpr (BLOCK_DIM <= Dxtv::CodeBook8x8::BlockMinDim)
+            const auto rawBlock = block.pixelArray();
+            encodedBlock = DXT::encodeBlock<BLOCK_DIM>(rawBlock, false, swapToBGR);
+            decodedBlock = DXT::decodeBlock<BLOCK_DIM>(encodedBlock, false, swapToBGR);
+            const auto encodedBlockError = Color::mse(rawBlock, decodedBlock);
+            // We can't split 4x4 blocks anymore and can't get better error-wise, so we accept any error there.
+            // 8x8 blocks above the allowed error are not considered, even if their cost is lower than that of a split
+            const float dxtCost = rateDistortion ? encodedBlockError * NrOfPixels + lambda * DxtBits : 0.0F;
+            if ((BLOCK_DIM <= Dxtv::CodeBook8x8::BlockMinDim || encodedBlockError < allowedError) && dxtCost < bestCost)
             {
-                // We can't split anymore and can't get better error-wise. Store 4x4 DXT block
-                data = encodedBlock;
-                block.copyPixelsFrom(decodedBlock);
-                Statistics::incValue(statistics, "dxtBlocks", 1, BLOCK_LEVEL);
+                bestCost = dxtCost;
+                dxtIsBest = true;
             }
-            else if constexpr (BLOCK_DIM > Dxtv::CodeBook8x8::BlockMinDim)
+        }
+        // Split block if sub-blocks can still beat the best cost. They need at least a reference each
+        if constexpr (BLOCK_DIM > Dxtv::CodeBook8x8::BlockMinDim)
+        {
+            static constexpr float MinSubBlockBits = RDRefBits;
+            if (bestCost > 4 * lambda * MinSubBlockBits)
             {
-                // We can still split. Check if encoded block is below allowed error or we want to split the block
-                auto encodedBlockError = Color::mse(rawBlock, decodedBlock);
-                if (encodedBlockError < allowedError)
+                const auto originalPixels = block.pixelArray();
+                const auto originalMotionBlocksPrev = counters.motionBlocksPrev;
+                const auto originalMotionBlocksCurr = counters.motionBlocksCurr;
+                const auto originalDxtBlocks = counters.dxtBlocks;
+                BlockData splitData;
+                float splitCost = 0.0F;
+                bool splitIsBest = true;
+                for (uint32_t i = 0; i < 4 && splitIsBest; ++i)
                 {
-                    // Error ok. Store full DXT block
-                    data = encodedBlock;
-                    block.copyPixelsFrom(decodedBlock);
-                    Statistics::incValue(statistics, "dxtBlocks", 1, BLOCK_LEVEL);
+                    // the remaining sub-blocks need at least a reference each
+                    const float subBlockMaxCost = bestCost - splitCost - (3 - i) * lambda * MinSubBlockBits;
+                    const auto subBlockResult = encodeBlockInternal<BLOCK_DIM / 2>(currentCodeBook, previousCodeBook, block.block(i), quality, swapToBGR, motionSearch, modeDecision, subBlockMaxCost, splitData, counters);
+                    splitIsBest = subBlockResult.has_value();
+                    splitCost += splitIsBest ? subBlockResult.value().second : 0.0F;
                 }
-                else
+                if (splitIsBest)
                 {
-                    // Split block to improve error and recurse
-                    blockWasSplit = true;
-                    for (uint32_t i = 0; i < 4; ++i)
-                    {
-                        auto [dummyFlag, blockData] = encodeBlockInternal<BLOCK_DIM / 2>(currentCodeBook, previousCodeBook, block.block(i), quality, swapToBGR, statistics);
-                        std::copy(blockData.cbegin(), blockData.cend(), std::back_inserter(data));
-                    }
+                    data.append(splitData);
+                    block.data() = true; // mark block as encoded
+                    return std::make_pair(DxtvConstants::BLOCK_IS_SPLIT, splitCost);
                 }
+                // split can not beat other modes. restore original block and block counts, but keep counting the search work done
+                block = originalPixels;
+                counters.motionBlocksPrev = originalMotionBlocksPrev;
+                counters.motionBlocksCurr = originalMotionBlocksCurr;
+                counters.dxtBlocks = originalDxtBlocks;
+                ++counters.splitsAbandoned;
             }
         }
+        if (dxtIsBest)
+        {
+            data.append(encodedBlock);
+            block = decodedBlock;
+            ++counters.dxtBlocks[BLOCK_LEVEL];
+        }
+        else if (bestRef.has_value() && refCost < maxCost)
+        {
+            const auto &codeBook = prevRefIsBetter ? previousCodeBook : currentCodeBook;
+            const auto offsetH = prevRefIsBetter ? Dxtv::PrevMotionHOffset : Dxtv::CurrMotionHOffset;
+            const auto offsetV = prevRefIsBetter ? Dxtv::PrevMotionVOffset : Dxtv::CurrMotionVOffset;
+            // check offset range
+            const auto offsetX = std::get<1>(bestRef.value());
+            const auto offsetY = std::get<2>(bestRef.value());
+            REQUIRE(offsetH.first <= offsetX && offsetX <= offsetH.second, std::runtime_error, "Reference block x offset out of range");
+            REQUIRE(offsetV.first <= offsetY && offsetY <= offsetV.second, std::runtime_error, "Reference block y offset out of range");
+            REQUIRE(static_cast<int32_t>(block.x()) + offsetX >= 0 && static_cast<int32_t>(block.y()) + offsetY >= 0, std::runtime_error, "Reference block coordinates out of bounds");
+            REQUIRE(static_cast<int32_t>(block.x()) + offsetX + BLOCK_DIM <= codeBook.width() && static_cast<int32_t>(block.y()) + offsetY + BLOCK_DIM <= codeBook.height(), std::runtime_error, "Reference block coordinates out of bounds");
+            block = codeBook.blockPixels<BLOCK_DIM>(static_cast<int32_t>(block.x()) + offsetX, static_cast<int32_t>(block.y()) + offsetY);
+            data.append(buildReference(offsetX, offsetY, prevRefIsBetter));
+            if (prevRefIsBetter)
+            {
+                ++counters.motionBlocksPrev[BLOCK_LEVEL];
+            }
+            else
+            {
+                ++counters.motionBlocksCurr[BLOCK_LEVEL];
+            }
+        }
+        else
+        {
+            // no block mode beats maxCost
+            return std::nullopt;
+        }
         block.data() = true; // mark block as encoded
-        return {blockWasSplit, data};
+        return std::make_pair(DxtvConstants::BLOCK_NO_SPLIT, bestCost);
     }
 
     template <>
-    auto Dxtv::encodeBlock<4>(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, 4> &block, float quality, const bool swapToBGR, Statistics::Frame::SPtr statistics) -> std::pair<bool, std::vector<uint8_t>>
+    auto Dxtv::encodeBlock<4>(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, 4> &block, float quality, std::vector<uint8_t> &data, const bool swapToBGR, MotionSearch motionSearch, ModeDecision modeDecision, Statistics::Frame::SPtr statistics) -> bool
     {
         REQUIRE(block.size() == 16, std::runtime_error, "Number of pixels in block must be 16");
-        return encodeBlockInternal<4>(currentCodeBook, previousCodeBook, block, quality, swapToBGR, statistics);
+        EncoderCounters counters;
+        BlockData blockData;
+        const auto result = encodeBlockInternal<4>(currentCodeBook, previousCodeBook, block, quality, swapToBGR, motionSearch, modeDecision, RDNoCost, blockData, counters);
+        data.insert(data.end(), blockData.bytes.cbegin(), std::next(blockData.bytes.cbegin(), blockData.size));
+        addToStatistics(statistics, counters);
+        return result.value().first;
     }
 
     template <>
-    auto Dxtv::encodeBlock<8>(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, 8> &block, float quality, const bool swapToBGR, Statistics::Frame::SPtr statistics) -> std::pair<bool, std::vector<uint8_t>>
+    auto Dxtv::encodeBlock<8>(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<XRGB8888, bool, 8> &block, float quality, std::vector<uint8_t> &data, const bool swapToBGR, MotionSearch motionSearch, ModeDecision modeDecision, Statistics::Frame::SPtr statistics) -> bool
     {
         REQUIRE(block.size() == 64, std::runtime_error, "Number of pixels in block must be 64");
-        return encodeBlockInternal<8>(currentCodeBook, previousCodeBook, block, quality, swapToBGR, statistics);
+        EncoderCounters counters;
+        BlockData blockData;
+        const auto result = encodeBlockInternal<8>(currentCodeBook, previousCodeBook, block, quality, swapToBGR, motionSearch, modeDecision, RDNoCost, blockData, counters);
+        data.insert(data.end(), blockData.bytes.cbegin(), std::next(blockData.bytes.cbegin(), blockData.size));
+        addToStatistics(statistics, counters);
+        return result.value().first;
     }
 
-    auto Dxtv::encode(const std::vector<XRGB8888> &image, const std::vector<XRGB8888> &previousImage, uint32_t width, uint32_t height, float quality, const bool swapToBGR, Statistics::Frame::SPtr statistics) -> std::pair<std::vector<uint8_t>, std::vector<XRGB8888>>
+    auto Dxtv::encode(const std::vector<XRGB8888> &image, const std::vector<XRGB8888> &previousImage, uint32_t width, uint32_t height, float quality, const bool swapToBGR, MotionSearch motionSearch, ModeDecision modeDecision, Statistics::Frame::SPtr statistics) -> std::pair<std::vector<uint8_t>, std::vector<XRGB8888>>
     {
         REQUIRE(width % CodeBook8x8::BlockMaxDim == 0, std::runtime_error, "Image width must be a multiple of " << CodeBook8x8::BlockMaxDim << " for DXTV compression");
         REQUIRE(height % CodeBook8x8::BlockMaxDim == 0, std::runtime_error, "Image height must be a multiple of " << CodeBook8x8::BlockMaxDim << " for DXTV compression");
         REQUIRE(quality >= 0 && quality <= 100, std::runtime_error, "Max. block error must be in [0,100]");
         // convert frames to codebooks
         auto currentCodeBook = CodeBook8x8(image, width, height, false);
-        const auto previousCodeBook = previousImage.empty() ? CodeBook8x8() : CodeBook8x8(previousImage, width, height, true);
+        // blocks from the previous frame will not match after a scene cut, so encode a key frame without searching the previous frame
+        const bool isKeyFrame = SceneCut::isSceneCut(image, previousImage, width, height);
+        const auto previousCodeBook = isKeyFrame ? CodeBook8x8() : CodeBook8x8(previousImage, width, height, true);
         // calculate perceived frame distance
         const float frameError = previousCodeBook.empty() ? INT_MAX : currentCodeBook.mse(previousCodeBook);
         // check if the new frame can be considered a verbatim copy
@@ -218,18 +506,26 @@ namespace Video
         const auto blockFlagBytesPerLine = blockFlagBitsPerLine / 8;
         // add frame header to compressed frame data
         DxtvFrameHeader frameHeader;
+        frameHeader.frameFlags = isKeyFrame ? DxtvConstants::FRAME_IS_KEY : 0;
         frameHeader.uncompressedSize = width * height * 2;
         std::vector<uint8_t> compressedFrameData(sizeof(DxtvFrameHeader));
         DxtvFrameHeader::write(reinterpret_cast<uint32_t *>(compressedFrameData.data()), frameHeader);
         // build vector of one block result per line for parallel execution
         std::vector<std::vector<uint8_t>> compressedBlockData(currentCodeBook.blockHeight());
-        // #pragma omp parallel for
+        // Blocks can reference already encoded pixels of the current frame in the block lines above, up to
+        // CurrMotionHOffset.second pixels to the right. Lines are encoded in parallel as a wavefront: A block is
+        // encoded only when the line above has finished all blocks a reference could touch. The search never reads
+        // blocks that are not encoded yet, so the result is the same as for sequential encoding
+        constexpr int32_t WavefrontBlocksAhead = 1 + (CurrMotionHOffset.second + static_cast<int32_t>(DxtvConstants::BLOCK_MAX_DIM) - 1) / static_cast<int32_t>(DxtvConstants::BLOCK_MAX_DIM);
+        std::vector<std::atomic<int32_t>> lineProgress(currentCodeBook.blockHeight()); // number of blocks already encoded per line
+#pragma omp parallel for schedule(static, 1)
         //  loop through source images in lines
-        for (int by = 0; by < currentCodeBook.blockHeight(); ++by)
+        for (int by = 0; by < static_cast<int>(currentCodeBook.blockHeight()); ++by)
         {
-            // reserve maximum compressed data size
+            // reserve maximum compressed data size, so encoding blocks does not need to allocate memory
             std::vector<uint8_t> &compressedLineData = compressedBlockData.at(by);
             compressedLineData.reserve(blockFlagBytesPerLine + currentCodeBook.blockWidth() * 32);
+            EncoderCounters lineCounters;
             // process in runs of 16 to correctly store flags in intervals
             for (std::size_t chunkIndex = 0; chunkIndex < (currentCodeBook.blockWidth() + 15) / 16; ++chunkIndex)
             {
@@ -243,10 +539,24 @@ namespace Video
                 const auto restBlockCount = std::min(currentCodeBook.blockWidth() - chunkIndex * 16, std::size_t(16));
                 for (std::size_t bx = 0; bx < restBlockCount; ++bx)
                 {
+                    const auto lineBlockIndex = static_cast<int32_t>(chunkIndex * 16 + bx);
+                    // wait for line above to have encoded all blocks we might reference
+                    if (by > 0)
+                    {
+                        const auto blocksNeeded = std::min(lineBlockIndex + WavefrontBlocksAhead, static_cast<int32_t>(currentCodeBook.blockWidth()));
+                        while (lineProgress[by - 1].load(std::memory_order_acquire) < blocksNeeded)
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
                     auto &block = currentCodeBook.block(blockStart + bx);
-                    auto [blockSplitFlag, blockData] = encodeBlockInternal(currentCodeBook, previousCodeBook, block, quality, swapToBGR, statistics);
-                    std::copy(blockData.cbegin(), blockData.cend(), std::back_inserter(compressedLineData));
+                    BlockData blockData;
+                    const auto blockResult = encodeBlockInternal(currentCodeBook, previousCodeBook, block, quality, swapToBGR, motionSearch, modeDecision, RDNoCost, blockData, lineCounters);
+                    compressedLineData.insert(compressedLineData.end(), blockData.bytes.cbegin(), std::next(blockData.bytes.cbegin(), blockData.size));
+                    const auto blockSplitFlag = blockResult.value().first;
                     flags16 = (flags16 >> 1) | (blockSplitFlag ? 0x8000 : 0);
+                    // signal block done to line below
+                    lineProgress[by].store(lineBlockIndex + 1, std::memory_order_release);
                 }
                 // shift flags to correct position when we compressed less than 16 blocks
                 assert(restBlockCount <= 16);
@@ -259,6 +569,7 @@ namespace Video
             {
                 compressedLineData.push_back(0);
             }
+            addToStatistics(statistics, lineCounters);
         }
         // find out how much memory we need
         const auto compressedBlockDataSize = std::accumulate(compressedBlockData.cbegin(), compressedBlockData.cend(), std::size_t(0), [](const auto &sum, const auto &data)
@@ -278,21 +589,30 @@ namespace Video
             auto refPercentCurr = static_cast<float>((statistics->getValue("motionBlocksCurr", 0) * 4 + statistics->getValue("motionBlocksCurr", 1)) * 100) / nrOfMinBlocks;
             auto refPercentPrev = static_cast<float>((statistics->getValue("motionBlocksPrev", 0) * 4 + statistics->getValue("motionBlocksPrev", 1)) * 100) / nrOfMinBlocks;
             auto dxtPercent = static_cast<float>((statistics->getValue("dxtBlocks", 0) * 4 + statistics->getValue("dxtBlocks", 1)) * 100) / nrOfMinBlocks;
-            std::cout << "Curr: " << statistics->getValue("motionBlocksCurr", 0) << "/" << statistics->getValue("motionBlocksCurr", 1) << " " << std::fixed << std::setprecision(1) << refPercentCurr << "%";
+            std::cout << (isKeyFrame ? "Key frame, " : "") << "Curr: " << statistics->getValue("motionBlocksCurr", 0) << "/" << statistics->getValue("motionBlocksCurr", 1) << " " << std::fixed << std::setprecision(1) << refPercentCurr << "%";
             std::cout << ", Prev: " << statistics->getValue("motionBlocksPrev", 0) << "/" << statistics->getValue("motionBlocksPrev", 1) << " " << std::fixed << std::setprecision(1) << refPercentPrev << "%";
-            std::cout << ", DXT: " << statistics->getValue("dxtBlocks", 0) << "/" << statistics->getValue("dxtBlocks", 1) << " " << std::fixed << std::setprecision(1) << dxtPercent << "%" << std::endl;
+            std::cout << ", DXT: " << statistics->getValue("dxtBlocks", 0) << "/" << statistics->getValue("dxtBlocks", 1) << " " << std::fixed << std::setprecision(1) << dxtPercent << "%";
+            std::cout << ", Motion candidates: " << static_cast<uint64_t>(statistics->getValue("motionCandidates"));
+            std::cout << " (" << static_cast<uint64_t>(statistics->getValue("motionVerified")) << " verified)";
+            std::cout << ", Splits abandoned: " << static_cast<uint64_t>(statistics->getValue("splitsAbandoned")) << std::endl;
         }
         // convert current frame / codebook back to store as decompressed frame
         return std::make_pair(compressedFrameData, currentCodeBook.pixels());
     }
 
+    /// @brief Number of 16-bit units of a DXT block of size BLOCK_DIM. Motion-compensated blocks use 1 unit
+    template <std::size_t BLOCK_DIM>
+    static constexpr std::size_t DxtBlockUnits = 1 + 1 + (BLOCK_DIM * BLOCK_DIM / 8);
+
+    /// @brief Decode a block. Checks that the block data does not reach past dataEnd
     template <std::size_t BLOCK_DIM>
-    auto decodeBlockInternal(const uint16_t *data, XRGB8888 *currBlock, const XRGB8888 *prevBlock, uint32_t width, const bool swapToBGR) -> const uint16_t *
+    auto decodeBlockInternal(const uint16_t *data, const uint16_t *dataEnd, XRGB8888 *currBlock, const XRGB8888 *prevBlock, uint32_t width, const bool swapToBGR) -> const uint16_t *
     {
         static_assert(DxtvConstants::BLOCK_MAX_DIM >= BLOCK_DIM);
         REQUIRE(data != nullptr, std::runtime_error, "Data can not be nullptr");
         REQUIRE(currBlock != nullptr, std::runtime_error, "currBlock can not be nullptr");
         REQUIRE(width > 0, std::runtime_error, "width must be > 0");
+        REQUIRE(data < dataEnd, std::runtime_error, "Block data past end of data");
         auto dstPtr = currBlock;
         auto data0 = *data;
         if (data0 & DxtvConstants::BLOCK_IS_REF)
@@ -320,83 +640,92 @@ namespace Video
         }
         else
         {
-            // decode DXT block
-            std::vector<uint8_t> compressed(2 * 2 + BLOCK_DIM * BLOCK_DIM * 2 / 8);
-            std::memcpy(compressed.data(), data, compressed.size());
-            auto decompressed = DXT::decodeBlock<BLOCK_DIM>(compressed, false, swapToBGR);
-            // copy pixels to output block
-            auto srcIt = decompressed.cbegin();
-            for (uint32_t y = 0; y < BLOCK_DIM; ++y)
-            {
-                for (uint32_t x = 0; x < BLOCK_DIM; ++x)
-                {
-                    dstPtr[x] = *srcIt++;
-                }
-                dstPtr += width;
-            }
-            return data + 1 + 1 + (BLOCK_DIM * BLOCK_DIM / 8); // DXT blocks use 8 or 20 bytes
+            // decode DXT block directly to output block
+            REQUIRE(static_cast<std::size_t>(dataEnd - data) >= DxtBlockUnits<BLOCK_DIM>, std::runtime_error, "Block data past end of data");
+            DXT::decodeBlock<BLOCK_DIM>(data, dstPtr, width, false, swapToBGR);
+            return data + DxtBlockUnits<BLOCK_DIM>; // DXT blocks use 8 or 20 bytes
         }
     }
 
     template <>
     auto Dxtv::decodeBlock<4>(const uint16_t *data, XRGB8888 *currBlock, const XRGB8888 *prevBlock, uint32_t width, const bool swapToBGR) -> const uint16_t *
     {
-        return decodeBlockInternal<4>(data, currBlock, prevBlock, width, swapToBGR);
+        return decodeBlockInternal<4>(data, data + DxtBlockUnits<4>, currBlock, prevBlock, width, swapToBGR);
     }
 
     template <>
     auto Dxtv::decodeBlock<8>(const uint16_t *data, XRGB8888 *currBlock, const XRGB8888 *prevBlock, uint32_t width, const bool swapToBGR) -> const uint16_t *
     {
-        return decodeBlockInternal<8>(data, currBlock, prevBlock, width, swapToBGR);
+        return decodeBlockInternal<8>(data, data + DxtBlockUnits<8>, currBlock, prevBlock, width, swapToBGR);
     }
 
     auto Dxtv::decode(const std::vector<uint8_t> &data, const std::vector<XRGB8888> &previousImage, uint32_t width, uint32_t height, const bool swapToBGR) -> std::vector<XRGB8888>
     {
         REQUIRE(data.size() >= sizeof(DxtvFrameHeader), std::runtime_error, "Not enough data to decode");
-        REQUIRE(width > 0, std::runtime_error, "width must be > 0");
-        REQUIRE(height > 0, std::runtime_error, "height must be > 0");
         const DxtvFrameHeader frameHeader = DxtvFrameHeader::read(reinterpret_cast<const uint32_t *>(data.data()));
         if (frameHeader.frameFlags == DxtvConstants::FRAME_KEEP)
         {
             REQUIRE(previousImage.size() == width * height, std::runtime_error, "Frame should be repeated, but previous image is empty or has wrong size");
             return previousImage;
         }
-        auto frameData = data.data() + sizeof(DxtvFrameHeader);
-        auto dataPtr = reinterpret_cast<const uint16_t *>(frameData);
+        REQUIRE(previousImage.empty() || previousImage.size() == width * height, std::runtime_error, "Previous image has wrong size");
         std::vector<XRGB8888> image(width * height);
+        decode(data.data(), data.size(), image.data(), previousImage.empty() ? nullptr : previousImage.data(), width, height, swapToBGR);
+        return image;
+    }
+
+    auto Dxtv::decode(const uint8_t *data, std::size_t dataSize, XRGB8888 *image, const XRGB8888 *previousImage, uint32_t width, uint32_t height, const bool swapToBGR) -> void
+    {
+        REQUIRE(data != nullptr && dataSize >= sizeof(DxtvFrameHeader), std::runtime_error, "Not enough data to decode");
+        REQUIRE(image != nullptr, std::runtime_error, "Image can not be nullptr");
+        REQUIRE(image != previousImage, std::runtime_error, "Image and previous image must be different buffers");
+        REQUIRE(width > 0, std::runtime_error, "width must be > 0");
+        REQUIRE(height > 0, std::runtime_error, "height must be > 0");
+        const DxtvFrameHeader frameHeader = DxtvFrameHeader::read(reinterpret_cast<const uint32_t *>(data));
+        if (frameHeader.frameFlags == DxtvConstants::FRAME_KEEP)
+        {
+            REQUIRE(previousImage != nullptr, std::runtime_error, "Frame should be repeated, but previous image is empty");
+            std::copy(previousImage, previousImage + width * height, image);
+            return;
+        }
+        auto frameData = data + sizeof(DxtvFrameHeader);
+        auto dataPtr = reinterpret_cast<const uint16_t *>(frameData);
+        const auto dataEnd = reinterpret_cast<const uint16_t *>(data + (dataSize & ~std::size_t(1)));
+        // key frames must not reference the previous frame, so keep the previous image nullptr for the whole frame
+        const XRGB8888 *prevImage = (frameHeader.frameFlags & DxtvConstants::FRAME_IS_KEY) != 0 ? nullptr : previousImage;
         for (uint32_t by = 0; by < height / DxtvConstants::BLOCK_MAX_DIM; ++by)
         {
             uint16_t flags = 0;
             uint32_t flagsAvailable = 0;
-            auto currPtr = image.data() + by * width * DxtvConstants::BLOCK_MAX_DIM;
-            auto prevPtr = previousImage.empty() ? nullptr : previousImage.data() + by * width * DxtvConstants::BLOCK_MAX_DIM;
             for (uint32_t bx = 0; bx < width / DxtvConstants::BLOCK_MAX_DIM; ++bx)
             {
+                const auto blockOffset = by * width * DxtvConstants::BLOCK_MAX_DIM + bx * DxtvConstants::BLOCK_MAX_DIM;
+                auto currPtr = image + blockOffset;
+                auto prevPtr = prevImage == nullptr ? nullptr : prevImage + blockOffset;
                 // read flags if we need to
                 if (flagsAvailable < 1)
                 {
+                    REQUIRE(dataPtr < dataEnd, std::runtime_error, "Block flags past end of data");
                     flags = *dataPtr++;
                     flagsAvailable = 16;
                 }
                 // check if block is split
                 if (flags & 1)
                 {
-                    dataPtr = decodeBlockInternal<4>(dataPtr, currPtr, prevPtr, width, swapToBGR);                                 // A - upper-left
-                    dataPtr = decodeBlockInternal<4>(dataPtr, currPtr + 4, prevPtr + 4, width, swapToBGR);                         // B - upper-right
-                    dataPtr = decodeBlockInternal<4>(dataPtr, currPtr + 4 * width, prevPtr + 4 * width, width, swapToBGR);         // C - lower-left
-                    dataPtr = decodeBlockInternal<4>(dataPtr, currPtr + 4 * width + 4, prevPtr + 4 * width + 4, width, swapToBGR); // D - lower-right
+                    const std::array<uint32_t, 4> subBlockOffsets = {0, 4, 4 * width, 4 * width + 4}; // A - upper-left, B - upper-right, C - lower-left, D - lower-right
+                    for (const auto subBlockOffset : subBlockOffsets)
+                    {
+                        dataPtr = decodeBlockInternal<4>(dataPtr, dataEnd, currPtr + subBlockOffset, prevPtr == nullptr ? nullptr : prevPtr + subBlockOffset, width, swapToBGR);
+                    }
                 }
                 else
                 {
-                    dataPtr = decodeBlockInternal<8>(dataPtr, currPtr, prevPtr, width, swapToBGR);
+                    dataPtr = decodeBlockInternal<8>(dataPtr, dataEnd, currPtr, prevPtr, width, swapToBGR);
                 }
-                currPtr += 8;
-                prevPtr += 8;
                 flags >>= 1;
                 --flagsAvailable;
             }
         }
-        return image;
     }
 
 }
@@ -22,21 +22,40 @@ namespace Video
 
         using CodeBook8x8 = CodeBook<Color::XRGB8888, DxtvConstants::BLOCK_MAX_DIM>; // Code book for storing 8x8 RGB pixel blocks
 
-        /// @brief Compress image block to DXTV format
+        /// @brief Motion search method for finding reference blocks
+        enum class MotionSearch
+        {
+            Exhaustive, // Check all block positions in search window
+            Fast        // Predictor-seeded diamond search. Checks only a fraction of positions, but might miss the best match
+        };
+
+        /// @brief Method for choosing how a block is stored
+        enum class ModeDecision
+        {
+            FirstFit,      // Use the first mode within the allowed error in the order reference, DXT, split
+            RateDistortion // Use the mode with the lowest rate-distortion cost J = D + lambda * R
+        };
+
+        /// @brief Compress image block to DXTV format and append compressed data to data.
+        /// Does not allocate heap memory if data has enough capacity (max. 32 bytes per 8x8 block) and statistics is nullptr
+        /// @return Returns true if the block was split
         template <std::size_t BLOCK_DIM>
-        static auto encodeBlock(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<Color::XRGB8888, bool, BLOCK_DIM> &block, float quality, const bool swapToBGR = false, Statistics::Frame::SPtr statistics = nullptr) -> std::pair<bool, std::vector<uint8_t>>;
+        static auto encodeBlock(CodeBook8x8 &currentCodeBook, const CodeBook8x8 &previousCodeBook, BlockView<Color::XRGB8888, bool, BLOCK_DIM> &block, float quality, std::vector<uint8_t> &data, const bool swapToBGR = false, MotionSearch motionSearch = MotionSearch::Exhaustive, ModeDecision modeDecision = ModeDecision::RateDistortion, Statistics::Frame::SPtr statistics = nullptr) -> bool;
 
         /// @brief Compress image to format similar to DXT1 (https://www.khronos.org/opengl/wiki/S3_Texture_Compression#DXT1_Format) while also using motion-compensation.
-        /// The frame and block format can be found in src/if/dxtv_constants.h
+        /// The frame and block format can be found in src/if/dxtv_constants.h.
+        /// If a scene cut is detected between the previous and the current image, the previous image is not used and the frame is flagged as a key frame
         /// @param image Input image to compress
         /// @param previousImage Previous image to detect motion-compensated blocks
         /// @param width Image width. Must be a multiple of 8!
         /// @param height Image height. Must be a multiple of 8!
         /// @param quality Quality for block references and splitting of blocks. The higher, the better quality. Range [0,100]
         /// @param swapToBGR If true colors will have the blue and red color component swapped
+        /// @param motionSearch Motion search method to find reference blocks with
+        /// @param modeDecision Method for choosing how blocks are stored
         /// @param statistics Image processing statistics container
         /// @return Returns (compressed data, compressed/decompressed frame)
-        static auto encode(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height, float quality, const bool swapToBGR = false, Statistics::Frame::SPtr statistics = nullptr) -> std::pair<std::vector<uint8_t>, std::vector<Color::XRGB8888>>;
+        static auto encode(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height, float quality, const bool swapToBGR = false, MotionSearch motionSearch = MotionSearch::Exhaustive, ModeDecision modeDecision = ModeDecision::RateDistortion, Statistics::Frame::SPtr statistics = nullptr) -> std::pair<std::vector<uint8_t>, std::vector<Color::XRGB8888>>;
 
         /// @brief Decompress block from DXTV format
         template <std::size_t BLOCK_DIM>
@@ -49,6 +68,16 @@ namespace Video
         /// @param height Image height. Must be a multiple of 8!
         /// @param swapToBGR If true colors will have the blue and red color component swapped
         static auto decode(const std::vector<uint8_t> &data, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height, const bool swapToBGR = false) -> std::vector<Color::XRGB8888>;
+
+        /// @brief Decompress image from DXTV format directly into a caller-provided buffer. Does not allocate heap memory
+        /// @param data Compressed image data in DXTV format
+        /// @param dataSize Size of compressed data in bytes
+        /// @param image Output image of width * height pixels
+        /// @param previousImage Previous image of width * height pixels to copy motion-compensated blocks from or nullptr. Must not be the same buffer as image
+        /// @param width Image width. Must be a multiple of 8!
+        /// @param height Image height. Must be a multiple of 8!
+        /// @param swapToBGR If true colors will have the blue and red color component swapped
+        static auto decode(const uint8_t *data, std::size_t dataSize, Color::XRGB8888 *image, const Color::XRGB8888 *previousImage, uint32_t width, uint32_t height, const bool swapToBGR = false) -> void;
     };
 
 }
\ No newline at end of file
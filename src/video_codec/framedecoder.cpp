@@ -0,0 +1,131 @@
+#include "framedecoder.h"
+
+#include "color/colorhelpers.h"
+#include "compression/autocompress.h"
+#include "compression/huffman.h"
+#include "compression/lz4.h"
+#include "compression/lzss.h"
+#include "dxtv.h"
+#include "exception.h"
+#include "if/lz4_constants.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Video
+{
+
+    /// @brief Get uncompressed size from the header of compressed data
+    static auto getUncompressedSize(const uint8_t *data, std::size_t dataSize) -> std::size_t
+    {
+        REQUIRE(dataSize >= 4, std::runtime_error, "Data too small");
+        uint32_t header = 0;
+        std::memcpy(&header, data, sizeof(header));
+        return header >> 8;
+    }
+
+    FrameDecoder::FrameDecoder(const std::vector<Image::ProcessingType> &processing, uint32_t width, uint32_t height, Color::Format pixelFormat, bool swappedRedBlue)
+        : m_processing(processing), m_width(width), m_height(height), m_pixelFormat(pixelFormat), m_swappedRedBlue(swappedRedBlue)
+    {
+        REQUIRE(width > 0 && height > 0, std::runtime_error, "Width or height can not be 0");
+    }
+
+    auto FrameDecoder::getBuffer(const uint8_t *inData, std::size_t size) -> std::vector<uint8_t> &
+    {
+        auto &buffer = m_buffers[0].data() == inData ? m_buffers[1] : m_buffers[0];
+        if (buffer.size() < size)
+        {
+            buffer.resize(size);
+        }
+        return buffer;
+    }
+
+    auto FrameDecoder::decode(const uint8_t *data, std::size_t dataSize, const std::vector<Color::XRGB8888> &colorMap) -> const std::vector<Color::XRGB8888> &
+    {
+        REQUIRE(data != nullptr && dataSize > 0, std::runtime_error, "Frame pixel data empty");
+        REQUIRE(m_width > 0 && m_height > 0, std::runtime_error, "Decoder not set up");
+        const uint8_t *inData = data;
+        std::size_t inSize = dataSize;
+        bool isPixels = false;
+        // do decoding steps
+        for (uint32_t pi = 0; pi < m_processing.size(); ++pi)
+        {
+            // this is the final operation either if we don't have any more steps, the current step is just a copy, or the next step is invalid
+            const auto processingType = m_processing[pi] == Image::ProcessingType::Invalid ? Image::ProcessingType::Uncompressed : m_processing[pi];
+            const auto isFinal = (pi + 1 >= m_processing.size()) || (processingType == Image::ProcessingType::Uncompressed) || (m_processing[pi + 1] == Image::ProcessingType::Invalid);
+            // reverse processing operation used in this stage
+            switch (processingType)
+            {
+            case Image::ProcessingType::Uncompressed:
+                break;
+            case Image::ProcessingType::CompressLZ4_40:
+            {
+                auto &buffer = getBuffer(inData, getUncompressedSize(inData, inSize) + Compression::LZ4_WILDCOPY_PADDING);
+                inSize = Compression::decodeLZ4_40(inData, inSize, buffer.data(), buffer.size());
+                inData = buffer.data();
+                break;
+            }
+            case Image::ProcessingType::CompressLZ4Dictionary_40:
+            {
+                // move the tail of the previous output in front of the output area, so matches can reach into it
+                constexpr std::size_t OutputOffset = Compression::Lz4Constants::MAX_MATCH_DISTANCE;
+                const auto dictionarySize = std::min(m_dictionaryDataSize, OutputOffset);
+                const auto requiredSize = OutputOffset + getUncompressedSize(inData, inSize) + Compression::LZ4_WILDCOPY_PADDING;
+                if (m_dictionary.size() < requiredSize)
+                {
+                    m_dictionary.resize(requiredSize);
+                }
+                std::memmove(m_dictionary.data() + OutputOffset - dictionarySize, m_dictionary.data() + OutputOffset + m_dictionaryDataSize - dictionarySize, dictionarySize);
+                m_dictionaryDataSize = Compression::decodeLZ4_40(inData, inSize, m_dictionary.data() + OutputOffset, m_dictionary.size() - OutputOffset, dictionarySize);
+                inData = m_dictionary.data() + OutputOffset;
+                inSize = m_dictionaryDataSize;
+                break;
+            }
+            case Image::ProcessingType::CompressLZSS_10:
+            {
+                auto &buffer = getBuffer(inData, getUncompressedSize(inData, inSize));
+                inSize = Compression::decodeLZSS_10(inData, inSize, buffer.data(), buffer.size());
+                inData = buffer.data();
+                break;
+            }
+            case Image::ProcessingType::CompressHuffman_20:
+                m_fallbackData = Compression::decodeHuffman_20(std::vector<uint8_t>(inData, inData + inSize));
+                inData = m_fallbackData.data();
+                inSize = m_fallbackData.size();
+                break;
+            case Image::ProcessingType::CompressRANS_50:
+                m_fallbackData = Compression::decodeRANS_50(std::vector<uint8_t>(inData, inData + inSize), m_ransModel);
+                inData = m_fallbackData.data();
+                inSize = m_fallbackData.size();
+                break;
+            case Image::ProcessingType::CompressAuto:
+                m_fallbackData = Compression::decodeAuto(std::vector<uint8_t>(inData, inData + inSize));
+                inData = m_fallbackData.data();
+                inSize = m_fallbackData.size();
+                break;
+            case Image::ProcessingType::CompressDXTV:
+                m_pixels.resize(m_width * m_height);
+                Dxtv::decode(inData, inSize, m_pixels.data(), m_previousPixels.size() == m_pixels.size() ? m_previousPixels.data() : nullptr, m_width, m_height, m_swappedRedBlue);
+                isPixels = true;
+                break;
+            default:
+                THROW(std::runtime_error, "Unsupported processing type " << static_cast<uint32_t>(processingType));
+            }
+            // break if this was the last processing operation
+            if (isFinal)
+            {
+                break;
+            }
+        }
+        // convert pixel data to XRGB8888
+        if (!isPixels)
+        {
+            m_pixels = ColorHelpers::toXRGB8888(std::vector<uint8_t>(inData, inData + inSize), m_pixelFormat, colorMap);
+        }
+        // the current frame is the previous frame for the next call
+        std::swap(m_pixels, m_previousPixels);
+        return m_previousPixels;
+    }
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "color/colorformat.h"
+#include "color/xrgb8888.h"
+#include "compression/rans.h"
+#include "if/image_processingtype.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Video
+{
+
+    /// @brief Decodes video frames through a chain of processing steps, e.g. LZ4 -> DXTV.
+    /// LZ4, LZ4 with dictionary, LZSS and DXTV steps decode directly into buffers that are reused between frames,
+    /// so decoding a frame does not allocate heap memory once these buffers have grown to their final size.
+    /// All other steps fall back to the general-purpose vector decoders
+    class FrameDecoder
+    {
+    public:
+        /// @brief Default constructor. Construct with parameters before decoding frames
+        FrameDecoder() = default;
+
+        /// @brief Constructor
+        /// @param processing Processing steps the frames were encoded with. Steps end at the first ProcessingType::Invalid
+        /// @param width Frame width in pixels
+        /// @param height Frame height in pixels
+        /// @param pixelFormat Pixel format of the decoded data if the last step does not decode to XRGB8888 pixels
+        /// @param swappedRedBlue If true colors have the blue and red color component swapped
+        FrameDecoder(const std::vector<Image::ProcessingType> &processing, uint32_t width, uint32_t height, Color::Format pixelFormat, bool swappedRedBlue);
+
+        /// @brief Decode frame. Frames must be decoded in order, because steps may reference data from the previous frame
+        /// @param data Encoded frame data
+        /// @param dataSize Size of encoded frame data in bytes
+        /// @param colorMap Current color map for indexed pixel formats. Must be empty for true color formats
+        /// @return Decoded frame in XRGB8888 format. Stays valid until the next call to decode()
+        auto decode(const uint8_t *data, std::size_t dataSize, const std::vector<Color::XRGB8888> &colorMap = {}) -> const std::vector<Color::XRGB8888> &;
+
+    private:
+        /// @brief Get the ping-pong buffer not holding inData, resized to at least size bytes
+        auto getBuffer(const uint8_t *inData, std::size_t size) -> std::vector<uint8_t> &;
+
+        std::vector<Image::ProcessingType> m_processing;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        Color::Format m_pixelFormat = Color::Format::Unknown;
+        bool m_swappedRedBlue = false;
+        std::array<std::vector<uint8_t>, 2> m_buffers; // Ping-pong buffers for intermediate data of LZ4 and LZSS steps
+        std::vector<uint8_t> m_dictionary;             // Tail of previous LZ4 dictionary step output, followed by the current output
+        std::size_t m_dictionaryDataSize = 0;          // Size of LZ4 dictionary step output of the previous frame
+        std::vector<uint8_t> m_fallbackData;           // Output of steps without a buffer decoder
+        Compression::RansModel m_ransModel;            // Model of previous frame for rANS steps
+        std::vector<Color::XRGB8888> m_pixels;         // Current frame pixels
+        std::vector<Color::XRGB8888> m_previousPixels; // Previous frame pixels for DXTV steps
+    };
+
+}
@@ -0,0 +1,57 @@
+#include "scenecut.h"
+
+#include "exception.h"
+
+#include <array>
+#include <cstdlib>
+
+namespace Video::SceneCut
+{
+
+    static constexpr uint32_t BitsPerChannel = 3;
+    static constexpr uint32_t NrOfBins = 1 << (3 * BitsPerChannel);
+    using Histogram = std::array<int32_t, NrOfBins>;
+
+    /// @brief Add every second pixel of every second line to histogram
+    static auto addToHistogram(Histogram &histogram, const std::vector<Color::XRGB8888> &image, uint32_t width, uint32_t height, int32_t increment) -> void
+    {
+        for (uint32_t y = 0; y < height; y += 2)
+        {
+            auto pixel = image.data() + y * width;
+            for (uint32_t x = 0; x < width; x += 2, pixel += 2)
+            {
+                const uint32_t bin = ((pixel->R() >> (8 - BitsPerChannel)) << (2 * BitsPerChannel)) | ((pixel->G() >> (8 - BitsPerChannel)) << BitsPerChannel) | (pixel->B() >> (8 - BitsPerChannel));
+                histogram[bin] += increment;
+            }
+        }
+    }
+
+    auto histogramDistance(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height) -> float
+    {
+        REQUIRE(width > 0 && height > 0, std::runtime_error, "Image width and height must be > 0");
+        REQUIRE(image.size() == width * height, std::runtime_error, "Image size must be width * height");
+        REQUIRE(previousImage.size() == image.size(), std::runtime_error, "Images must have the same size");
+        // build difference of histograms directly
+        Histogram difference{};
+        addToHistogram(difference, image, width, height, 1);
+        addToHistogram(difference, previousImage, width, height, -1);
+        uint32_t sum = 0;
+        for (const auto d : difference)
+        {
+            sum += std::abs(d);
+        }
+        // every pixel that moved to a different bin is counted twice
+        const uint32_t nrOfSamples = ((width + 1) / 2) * ((height + 1) / 2);
+        return static_cast<float>(sum) / static_cast<float>(2 * nrOfSamples);
+    }
+
+    auto isSceneCut(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height, float threshold) -> bool
+    {
+        REQUIRE(threshold >= 0.0F && threshold <= 1.0F, std::runtime_error, "Threshold must be in [0,1]");
+        if (previousImage.empty())
+        {
+            return true;
+        }
+        return histogramDistance(image, previousImage, width, height) > threshold;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "color/xrgb8888.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Video::SceneCut
+{
+    /// @brief Default threshold for histogram distances to be considered a scene cut
+    static constexpr float DefaultThreshold = 0.5F;
+
+    /// @brief Calculate the distance of the color histograms of two images of the same size.
+    /// Histograms use 3 bits per color channel and are built from every second pixel in x and y, so this is cheap.
+    /// Color histograms do not change much when objects or the camera move, but they do on hard cuts
+    /// @param image Current image
+    /// @param previousImage Previous image
+    /// @param width Image width
+    /// @param height Image height
+    /// @return Distance in [0,1], where 0 means identical histograms and 1 means no colors in common
+    auto histogramDistance(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height) -> float;
+
+    /// @brief Check if there is a hard cut between the previous and the current image
+    /// @param image Current image
+    /// @param previousImage Previous image. If empty, there is always a scene cut
+    /// @param width Image width
+    /// @param height Image height
+    /// @param threshold Histogram distance above which images are considered a scene cut. Range [0,1]
+    /// @return Returns true if the current image starts a new scene
+    auto isSceneCut(const std::vector<Color::XRGB8888> &image, const std::vector<Color::XRGB8888> &previousImage, uint32_t width, uint32_t height, float threshold = DefaultThreshold) -> bool;
+}
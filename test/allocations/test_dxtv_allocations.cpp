@@ -0,0 +1,156 @@
+#include "testmacros.h"
+
+#include "color/xrgb8888.h"
+#include "compression/lz4.h"
+#include "image/imageio.h"
+#include "video_codec/codebook.h"
+#include "video_codec/dxtv.h"
+#include "video_codec/framedecoder.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> SequenceFiles = {
+    "BigBuckBunny_240x160_15fps-178.png",
+    "BigBuckBunny_240x160_15fps-179.png",
+    "BigBuckBunny_240x160_15fps-180.png",
+    "BigBuckBunny_240x160_15fps-181.png"};
+
+static const std::string DataPathGBAVideos = "../../data/videos/240x160/";
+
+static constexpr float ImageQualityDXT8x8 = 90;
+
+// Count heap allocations of the current thread while enabled to check that encoding and decoding do not allocate memory.
+// This replaces the global operator new, so these tests are built as their own executable and do not affect the unit tests
+static thread_local bool CountAllocations = false;
+static thread_local std::size_t NrOfAllocations = 0;
+
+auto operator new(std::size_t size) -> void *
+{
+    if (CountAllocations)
+    {
+        ++NrOfAllocations;
+    }
+    if (auto ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void *ptr) noexcept -> void
+{
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::size_t) noexcept -> void
+{
+    std::free(ptr);
+}
+
+TEST_SUITE("DXTVAllocations")
+
+TEST_CASE("EncodeBlockAllocations")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    const auto size = images.front().info.size;
+    std::vector<Color::XRGB8888> prevPixels;
+    for (const auto &data : images)
+    {
+        const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+        auto currentCodeBook = Video::Dxtv::CodeBook8x8(inPixels, size.width(), size.height(), false);
+        const auto previousCodeBook = prevPixels.empty() ? Video::Dxtv::CodeBook8x8() : Video::Dxtv::CodeBook8x8(prevPixels, size.width(), size.height(), true);
+        // reserve maximum compressed size, so appending data does not allocate
+        std::vector<uint8_t> compressedData;
+        compressedData.reserve(currentCodeBook.size() * 32);
+        // encode all blocks with exhaustive and fast search in steady state and count allocations
+        std::size_t nrOfSplitBlocks = 0;
+        NrOfAllocations = 0;
+        CountAllocations = true;
+        for (std::size_t i = 0; i < currentCodeBook.size(); ++i)
+        {
+            const auto motionSearch = (i % 2) == 0 ? Video::Dxtv::MotionSearch::Exhaustive : Video::Dxtv::MotionSearch::Fast;
+            nrOfSplitBlocks += Video::Dxtv::encodeBlock<Video::DxtvConstants::BLOCK_MAX_DIM>(currentCodeBook, previousCodeBook, currentCodeBook.block(i), ImageQualityDXT8x8, compressedData, swapToBGR, motionSearch) ? 1 : 0;
+        }
+        CountAllocations = false;
+        std::cout << "DXTV-encoded " << currentCodeBook.size() << " blocks (" << nrOfSplitBlocks << " split) to " << compressedData.size() << " bytes with " << NrOfAllocations << " allocations" << std::endl;
+        CATCH_REQUIRE(NrOfAllocations == 0);
+        prevPixels = currentCodeBook.pixels();
+    }
+}
+
+TEST_CASE("DecodeBufferAllocations")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    const auto size = images.front().info.size;
+    // decode to preallocated buffers
+    std::vector<Color::XRGB8888> prevPixels;
+    std::vector<Color::XRGB8888> currBuffer(size.width() * size.height());
+    std::vector<Color::XRGB8888> prevBuffer(size.width() * size.height());
+    for (const auto &data : images)
+    {
+        const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+        const auto [compressedData, frameBuffer] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR);
+        NrOfAllocations = 0;
+        CountAllocations = true;
+        Video::Dxtv::decode(compressedData.data(), compressedData.size(), currBuffer.data(), prevPixels.empty() ? nullptr : prevBuffer.data(), size.width(), size.height(), swapToBGR);
+        CountAllocations = false;
+        CATCH_REQUIRE(NrOfAllocations == 0);
+        CATCH_REQUIRE(currBuffer == frameBuffer);
+        std::swap(currBuffer, prevBuffer);
+        prevPixels = frameBuffer;
+    }
+}
+
+TEST_CASE("FrameDecoderAllocations")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    const auto size = images.front().info.size;
+    // encode sequence using DXTV -> LZ4
+    std::vector<std::vector<uint8_t>> compressedFrames;
+    std::vector<std::vector<Color::XRGB8888>> frameBuffers;
+    std::vector<Color::XRGB8888> prevPixels;
+    for (const auto &data : images)
+    {
+        const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+        const auto [compressedData, frameBuffer] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR);
+        compressedFrames.push_back(Compression::encodeLZ4_40(compressedData));
+        frameBuffers.push_back(frameBuffer);
+        prevPixels = frameBuffer;
+    }
+    // the first run grows the decoder buffers, the second run must not allocate memory
+    Video::FrameDecoder decoder({Image::ProcessingType::CompressLZ4_40, Image::ProcessingType::CompressDXTV}, size.width(), size.height(), Color::Format::XRGB8888, swapToBGR);
+    for (uint32_t run = 0; run < 2; ++run)
+    {
+        for (std::size_t i = 0; i < compressedFrames.size(); ++i)
+        {
+            NrOfAllocations = 0;
+            CountAllocations = true;
+            const auto &outPixels = decoder.decode(compressedFrames[i].data(), compressedFrames[i].size());
+            CountAllocations = false;
+            CATCH_REQUIRE(outPixels == frameBuffers[i]);
+            if (run > 0)
+            {
+                CATCH_REQUIRE(NrOfAllocations == 0);
+            }
+        }
+    }
+}
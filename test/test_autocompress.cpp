@@ -0,0 +1,66 @@
+#include "testmacros.h"
+
+#include "compression/autocompress.h"
+#include "if/auto_constants.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Compression;
+
+TEST_SUITE("Auto compression")
+
+static const char LoremIpsum[] = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt ut labore et dolore magna aliquyam erat, sed diam voluptua. At vero eos et accusam et justo duo dolores et ea rebum. Stet clita kasd gubergren, no sea takimata sanctus est Lorem ipsum dolor sit amet. Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt ut labore et dolore magna aliquyam erat, sed diam voluptua.";
+
+static auto randomData(std::size_t size) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> data(size);
+    uint32_t random = 12345;
+    for (auto &d : data)
+    {
+        random = random * 1664525 + 1013904223;
+        d = static_cast<uint8_t>(random >> 24);
+    }
+    return data;
+}
+
+static auto typeMarker(const std::vector<uint8_t> &data) -> uint8_t
+{
+    return data.front();
+}
+
+TEST_CASE("Auto roundtrip")
+{
+    const std::vector<uint8_t> text(LoremIpsum, LoremIpsum + sizeof(LoremIpsum));
+    for (const auto &data : {std::vector<uint8_t>(1, 0), std::vector<uint8_t>(4096, 0), text, randomData(1021)})
+    {
+        for (double cycleWeight : {0.0, 0.1, 1000.0})
+        {
+            const auto compressed = encodeAuto(data, true, true, false, false, cycleWeight);
+            CATCH_REQUIRE(compressed.size() % 4 == 0);
+            CATCH_REQUIRE(data == decodeAuto(compressed));
+        }
+    }
+    CATCH_REQUIRE_THROWS(encodeAuto({}, true, true));
+    CATCH_REQUIRE_THROWS(encodeAuto(text, true, true, false, false, -1.0));
+}
+
+TEST_CASE("Auto selection")
+{
+    const std::vector<uint8_t> text(LoremIpsum, LoremIpsum + sizeof(LoremIpsum));
+    // random data does not compress
+    CATCH_REQUIRE(typeMarker(encodeAuto(randomData(1024), true, true)) == AutoConstants::TYPE_MARKER_UNCOMPRESSED);
+    // with only one compressor enabled it is used for compressible data
+    CATCH_REQUIRE(typeMarker(encodeAuto(text, true, false)) == AutoConstants::TYPE_MARKER_LZ4_40);
+    CATCH_REQUIRE(typeMarker(encodeAuto(text, false, true)) == AutoConstants::TYPE_MARKER_LZSS_10);
+    CATCH_REQUIRE(typeMarker(encodeAuto(text, false, false)) == AutoConstants::TYPE_MARKER_UNCOMPRESSED);
+    // without cycle weight the smallest result is picked
+    const auto smallest = encodeAuto(text, true, true);
+    CATCH_REQUIRE(smallest.size() <= encodeAuto(text, true, false).size());
+    CATCH_REQUIRE(smallest.size() <= encodeAuto(text, false, true).size());
+    // with a high cycle weight the fastest result is picked
+    CATCH_REQUIRE(typeMarker(encodeAuto(text, true, true, false, false, 1000.0)) == AutoConstants::TYPE_MARKER_UNCOMPRESSED);
+    CATCH_REQUIRE(estimateDecodeCycles(AutoConstants::TYPE_MARKER_UNCOMPRESSED, 100, 100) < estimateDecodeCycles(AutoConstants::TYPE_MARKER_LZ4_40, 100, 100));
+    CATCH_REQUIRE(estimateDecodeCycles(AutoConstants::TYPE_MARKER_LZ4_40, 100, 100) < estimateDecodeCycles(AutoConstants::TYPE_MARKER_LZSS_10, 100, 100));
+    CATCH_REQUIRE_THROWS(estimateDecodeCycles(0x50, 100, 100));
+}
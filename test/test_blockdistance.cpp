@@ -0,0 +1,124 @@
+#include "testmacros.h"
+
+#include "color/xrgb8888.h"
+#include "video_codec/blockdistance.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Video;
+
+TEST_SUITE("BlockDistance")
+
+static constexpr std::size_t ImageWidth = 37;
+static constexpr std::size_t ImageHeight = 23;
+
+/// @brief Generate random image. X channel is random too, so it must be ignored by the kernels
+auto randomImage(std::mt19937 &rng) -> std::vector<Color::XRGB8888>
+{
+    std::vector<Color::XRGB8888> image(ImageWidth * ImageHeight);
+    for (auto &pixel : image)
+    {
+        // copy raw value, so the X channel is set too
+        const uint32_t raw = rng();
+        std::memcpy(&pixel, &raw, sizeof(raw));
+    }
+    return image;
+}
+
+/// @brief Scalar reference implementation of SAD and SSD
+template <std::size_t BLOCK_DIM>
+auto referenceDistance(const Color::XRGB8888 *a, std::size_t strideA, const Color::XRGB8888 *b, std::size_t strideB) -> std::pair<uint32_t, uint32_t>
+{
+    uint32_t sad = 0;
+    uint32_t ssd = 0;
+    for (std::size_t v = 0; v < BLOCK_DIM; ++v)
+    {
+        for (std::size_t u = 0; u < BLOCK_DIM; ++u)
+        {
+            const auto &ca = a[v * strideA + u];
+            const auto &cb = b[v * strideB + u];
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                const int32_t d = static_cast<int32_t>(ca[c]) - static_cast<int32_t>(cb[c]);
+                sad += std::abs(d);
+                ssd += d * d;
+            }
+        }
+    }
+    return {sad, ssd};
+}
+
+template <std::size_t BLOCK_DIM>
+auto testKernels() -> void
+{
+    std::mt19937 rng(1234);
+    const auto imageA = randomImage(rng);
+    const auto imageB = randomImage(rng);
+    const std::vector<BlockDistance::Kernel> kernels = {BlockDistance::Kernel::Scalar, BlockDistance::Kernel::SSE2, BlockDistance::Kernel::AVX2};
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        // use unaligned block positions and different strides
+        const std::size_t xA = rng() % (ImageWidth - BLOCK_DIM + 1);
+        const std::size_t yA = rng() % (ImageHeight - BLOCK_DIM + 1);
+        const std::size_t xB = rng() % (ImageWidth - BLOCK_DIM + 1);
+        const std::size_t yB = rng() % (ImageHeight - BLOCK_DIM + 1);
+        const auto a = imageA.data() + yA * ImageWidth + xA;
+        // compare image to a contiguous block
+        std::vector<Color::XRGB8888> b;
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v)
+        {
+            b.insert(b.end(), imageB.data() + (yB + v) * ImageWidth + xB, imageB.data() + (yB + v) * ImageWidth + xB + BLOCK_DIM);
+        }
+        const auto [refSad, refSsd] = referenceDistance<BLOCK_DIM>(a, ImageWidth, b.data(), BLOCK_DIM);
+        for (auto kernel : kernels)
+        {
+            if (BlockDistance::isSupported(kernel))
+            {
+                CATCH_REQUIRE(BlockDistance::sad<BLOCK_DIM>(a, ImageWidth, b.data(), BLOCK_DIM, kernel) == refSad);
+                CATCH_REQUIRE(BlockDistance::ssd<BLOCK_DIM>(a, ImageWidth, b.data(), BLOCK_DIM, kernel) == refSsd);
+            }
+        }
+        // check that the bound really is a lower bound of the perceptual error
+        float mse = 0.0F;
+        for (std::size_t v = 0; v < BLOCK_DIM; ++v)
+        {
+            for (std::size_t u = 0; u < BLOCK_DIM; ++u)
+            {
+                mse += Color::XRGB8888::mse(a[v * ImageWidth + u], b[v * BLOCK_DIM + u]);
+            }
+        }
+        mse /= BLOCK_DIM * BLOCK_DIM;
+        CATCH_REQUIRE(BlockDistance::mseLowerBound<BLOCK_DIM>(refSsd) <= mse);
+    }
+}
+
+TEST_CASE("Kernels4x4")
+{
+    CATCH_REQUIRE(BlockDistance::isSupported(BlockDistance::Kernel::Scalar));
+    CATCH_REQUIRE(BlockDistance::isSupported(BlockDistance::bestKernel()));
+    testKernels<4>();
+}
+
+TEST_CASE("Kernels8x8")
+{
+    testKernels<8>();
+}
+
+TEST_CASE("MaximumDistance")
+{
+    // all channels at maximum distance must not overflow
+    const std::vector<Color::XRGB8888> black(64, Color::XRGB8888(0, 0, 0));
+    const std::vector<Color::XRGB8888> white(64, Color::XRGB8888(255, 255, 255));
+    for (auto kernel : {BlockDistance::Kernel::Scalar, BlockDistance::Kernel::SSE2, BlockDistance::Kernel::AVX2})
+    {
+        if (BlockDistance::isSupported(kernel))
+        {
+            CATCH_REQUIRE(BlockDistance::sad<8>(black.data(), 8, white.data(), 8, kernel) == 64 * 3 * 255);
+            CATCH_REQUIRE(BlockDistance::ssd<8>(black.data(), 8, white.data(), 8, kernel) == 64 * 3 * 255 * 255);
+            CATCH_REQUIRE(BlockDistance::ssd<4>(white.data(), 8, black.data(), 4, kernel) == 16 * 3 * 255 * 255);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "testmacros.h"
+
+#include "compression/autocompress.h"
+#include "compression/chunked.h"
+#include "compression/lz4.h"
+#include "if/chunked_constants.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Compression;
+
+TEST_SUITE("Chunked compression")
+
+static auto testData(std::size_t size) -> std::vector<uint8_t>
+{
+    // repeating pattern with some random bytes mixed in
+    std::vector<uint8_t> data(size);
+    uint32_t random = 12345;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        random = random * 1664525 + 1013904223;
+        data[i] = (random >> 28) == 0 ? static_cast<uint8_t>(random >> 20) : static_cast<uint8_t>(i % 61);
+    }
+    return data;
+}
+
+static auto encodeLZ4Chunk(const std::vector<uint8_t> &chunk) -> std::vector<uint8_t>
+{
+    return encodeAuto(chunk, true, false);
+}
+
+TEST_CASE("Chunked roundtrip")
+{
+    for (auto size : {1, 4, 1000, 4096, 100003})
+    {
+        const auto data = testData(size);
+        for (uint32_t chunkSize : {4U, 1024U, 4096U, 65536U})
+        {
+            if (size / chunkSize > 1000)
+            {
+                continue;
+            }
+            const auto compressed = encodeChunked(data, chunkSize, encodeLZ4Chunk);
+            CATCH_REQUIRE(compressed.size() % 4 == 0);
+            CATCH_REQUIRE(compressed.front() == ChunkedConstants::TYPE_MARKER);
+            const uint32_t nrOfChunks = (size + chunkSize - 1) / chunkSize;
+            CATCH_REQUIRE(chunkCount(compressed) == nrOfChunks);
+            CATCH_REQUIRE(data == decodeChunked(compressed));
+        }
+    }
+    CATCH_REQUIRE_THROWS(encodeChunked({}, 1024, encodeLZ4Chunk));
+    CATCH_REQUIRE_THROWS(encodeChunked(testData(100), 0, encodeLZ4Chunk));
+    CATCH_REQUIRE_THROWS(encodeChunked(testData(100), 1022, encodeLZ4Chunk));
+    CATCH_REQUIRE_THROWS(decodeChunked(encodeLZ4_40(testData(100))));
+}
+
+TEST_CASE("Chunked single chunk access")
+{
+    const auto data = testData(10000);
+    const uint32_t chunkSize = 4096;
+    const auto compressed = encodeChunked(data, chunkSize, encodeLZ4Chunk);
+    CATCH_REQUIRE(chunkCount(compressed) == 3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const auto chunkEnd = std::min<std::size_t>((i + 1) * chunkSize, data.size());
+        CATCH_REQUIRE(decodeChunk(compressed, i) == std::vector<uint8_t>(std::next(data.cbegin(), i * chunkSize), std::next(data.cbegin(), chunkEnd)));
+    }
+    CATCH_REQUIRE_THROWS(decodeChunk(compressed, 3));
+    // truncated data must not decode
+    CATCH_REQUIRE_THROWS(decodeChunk(std::vector<uint8_t>(compressed.cbegin(), std::next(compressed.cbegin(), 12)), 1));
+    // chunks are compressed independently, so they must decode to the same result as compressing them alone
+    const std::vector<uint8_t> lastChunk(std::next(data.cbegin(), 2 * chunkSize), data.cend());
+    CATCH_REQUIRE(decodeAuto(encodeLZ4Chunk(lastChunk)) == decodeChunk(compressed, 2));
+}
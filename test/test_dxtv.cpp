@@ -2,11 +2,14 @@
 
 #include "color/psnr.h"
 #include "color/rgb888.h"
+#include "if/dxtv_structs.h"
 #include "image/imageio.h"
 #include "video_codec/blockview.h"
 #include "video_codec/codebook.h"
 #include "video_codec/dxtv.h"
 
+#include <omp.h>
+
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
@@ -44,21 +47,21 @@ auto testEncodeBlock(const Image::Frame &data, const float quality, const float
     // output image
     std::vector<Color::XRGB8888> outImage(data.data.pixels().size());
     // compress block
-    auto [blockSplitFlag, compressedData] = Video::Dxtv::encodeBlock<Video::DxtvConstants::BLOCK_MAX_DIM>(currentCodeBook, CodeBook<Color::XRGB8888, Video::DxtvConstants::BLOCK_MAX_DIM>(), inBlock, quality, swapToBGR);
+    std::vector<uint8_t> compressedData;
+    const auto blockSplitFlag = Video::Dxtv::encodeBlock<Video::DxtvConstants::BLOCK_MAX_DIM>(currentCodeBook, CodeBook<Color::XRGB8888, Video::DxtvConstants::BLOCK_MAX_DIM>(), inBlock, quality, compressedData, swapToBGR);
     // uncompress block
     auto dataPtr = reinterpret_cast<const uint16_t *>(compressedData.data());
     auto currPtr = outImage.data();
-    const Color::XRGB8888 *prevPtr = nullptr;
     if (blockSplitFlag)
     {
-        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr, prevPtr, size.width(), swapToBGR);                                               // A - upper-left
-        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4, prevPtr + 4, size.width(), swapToBGR);                                       // B - upper-right
-        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4 * size.width(), prevPtr + 4 * size.width(), size.width(), swapToBGR);         // C - lower-left
-        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4 * size.width() + 4, prevPtr + 4 * size.width() + 4, size.width(), swapToBGR); // D - lower-right
+        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr, nullptr, size.width(), swapToBGR);                          // A - upper-left
+        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4, nullptr, size.width(), swapToBGR);                      // B - upper-right
+        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4 * size.width(), nullptr, size.width(), swapToBGR);       // C - lower-left
+        dataPtr = Video::Dxtv::decodeBlock<4>(dataPtr, currPtr + 4 * size.width() + 4, nullptr, size.width(), swapToBGR);   // D - lower-right
     }
     else
     {
-        dataPtr = Video::Dxtv::decodeBlock<8>(dataPtr, currPtr, prevPtr, size.width(), swapToBGR);
+        dataPtr = Video::Dxtv::decodeBlock<8>(dataPtr, currPtr, nullptr, size.width(), swapToBGR);
     }
     // compare input and output
     auto outCodeBook = Video::Dxtv::CodeBook8x8(outImage, size.width(), size.height(), false);
@@ -128,3 +131,202 @@ TEST_CASE("EncodeDecodeVideo")
         prevPixels = frameBuffer;
     }
 }
+
+TEST_CASE("ThreadCountDeterministic")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    const auto maxThreads = omp_get_max_threads();
+    // the encoded stream must not depend on the number of threads the blocks are encoded with
+    for (const auto motionSearch : {Video::Dxtv::MotionSearch::Exhaustive, Video::Dxtv::MotionSearch::Fast})
+    {
+        std::vector<Color::XRGB8888> prevPixels;
+        for (const auto &data : images)
+        {
+            const auto size = data.info.size;
+            const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+            omp_set_num_threads(1);
+            const auto [compressedSerial, frameBufferSerial] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR, motionSearch);
+            for (int nrOfThreads : {2, 3, 8})
+            {
+                omp_set_num_threads(nrOfThreads);
+                const auto [compressedParallel, frameBufferParallel] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR, motionSearch);
+                CATCH_REQUIRE(compressedParallel == compressedSerial);
+                CATCH_REQUIRE(frameBufferParallel == frameBufferSerial);
+            }
+            prevPixels = frameBufferSerial;
+        }
+    }
+    omp_set_num_threads(maxThreads);
+}
+
+TEST_CASE("FastMotionSearch")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    constexpr float allowedPsnr = 16.36F;
+    // encode sequence with exhaustive and fast motion search and compare reference block hit rates
+    std::vector<Color::XRGB8888> prevPixelsExhaustive;
+    std::vector<Color::XRGB8888> prevPixelsFast;
+    for (const auto &data : images)
+    {
+        const auto size = data.info.size;
+        const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+        auto statisticsExhaustive = std::make_shared<Statistics::Frame>();
+        const auto [compressedExhaustive, frameBufferExhaustive] = Video::Dxtv::encode(inPixels, prevPixelsExhaustive, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR, Video::Dxtv::MotionSearch::Exhaustive, Video::Dxtv::ModeDecision::RateDistortion, statisticsExhaustive);
+        auto statisticsFast = std::make_shared<Statistics::Frame>();
+        const auto [compressedFast, frameBufferFast] = Video::Dxtv::encode(inPixels, prevPixelsFast, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR, Video::Dxtv::MotionSearch::Fast, Video::Dxtv::ModeDecision::RateDistortion, statisticsFast);
+        auto outPixels = Video::Dxtv::decode(compressedFast, prevPixelsFast, size.width(), size.height(), swapToBGR);
+        CATCH_REQUIRE(outPixels == frameBufferFast);
+        auto psnr = Color::psnr(inPixels, outPixels);
+        // calculate percentage of 4x4 blocks that are references
+        const auto nrOfMinBlocks = static_cast<double>(size.width() / 4 * size.height() / 4);
+        auto hitRate = [nrOfMinBlocks](const Statistics::Frame::SPtr &statistics)
+        {
+            const auto refBlocks = statistics->getValue("motionBlocksCurr", 0) * 4 + statistics->getValue("motionBlocksCurr", 1) + statistics->getValue("motionBlocksPrev", 0) * 4 + statistics->getValue("motionBlocksPrev", 1);
+            return 100.0 * refBlocks / nrOfMinBlocks;
+        };
+        const auto candidatesExhaustive = statisticsExhaustive->getValue("motionCandidates");
+        const auto candidatesFast = statisticsFast->getValue("motionCandidates");
+        std::cout << "DXTV motion search exhaustive / fast: references " << std::fixed << std::setprecision(1) << hitRate(statisticsExhaustive) << "% / " << hitRate(statisticsFast) << "%";
+        std::cout << ", size " << compressedExhaustive.size() << " / " << compressedFast.size() << " bytes, candidates " << static_cast<uint64_t>(candidatesExhaustive) << " / " << static_cast<uint64_t>(candidatesFast) << ", psnr: " << std::setprecision(4) << psnr << std::endl;
+        // fast search must evaluate fewer positions, but find at least 90% of the references of the exhaustive search
+        CATCH_REQUIRE(candidatesFast < candidatesExhaustive);
+        CATCH_REQUIRE(hitRate(statisticsFast) >= 0.9 * hitRate(statisticsExhaustive));
+        CATCH_REQUIRE(psnr >= allowedPsnr);
+        prevPixelsExhaustive = frameBufferExhaustive;
+        prevPixelsFast = frameBufferFast;
+    }
+}
+
+TEST_CASE("RateDistortionModeDecision")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    // encode sequence choosing block modes first-fit and by rate-distortion cost and compare size and quality
+    for (const auto quality : {ImageQualityDXT8x8, 95.0F})
+    {
+        std::size_t sizeFirstFit = 0;
+        std::size_t sizeRD = 0;
+        double psnrFirstFit = 0.0;
+        double psnrRD = 0.0;
+        std::vector<Color::XRGB8888> prevPixelsFirstFit;
+        std::vector<Color::XRGB8888> prevPixelsRD;
+        for (const auto &data : images)
+        {
+            const auto size = data.info.size;
+            const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+            const auto [compressedFirstFit, frameBufferFirstFit] = Video::Dxtv::encode(inPixels, prevPixelsFirstFit, size.width(), size.height(), quality, swapToBGR, Video::Dxtv::MotionSearch::Exhaustive, Video::Dxtv::ModeDecision::FirstFit);
+            const auto [compressedRD, frameBufferRD] = Video::Dxtv::encode(inPixels, prevPixelsRD, size.width(), size.height(), quality, swapToBGR, Video::Dxtv::MotionSearch::Exhaustive, Video::Dxtv::ModeDecision::RateDistortion);
+            CATCH_REQUIRE(Video::Dxtv::decode(compressedRD, prevPixelsRD, size.width(), size.height(), swapToBGR) == frameBufferRD);
+            sizeFirstFit += compressedFirstFit.size();
+            sizeRD += compressedRD.size();
+            psnrFirstFit += Color::psnr(inPixels, frameBufferFirstFit) / images.size();
+            psnrRD += Color::psnr(inPixels, frameBufferRD) / images.size();
+            prevPixelsFirstFit = frameBufferFirstFit;
+            prevPixelsRD = frameBufferRD;
+        }
+        std::cout << "DXTV quality " << static_cast<int>(quality) << " first-fit / rate-distortion: size " << sizeFirstFit << " / " << sizeRD << " bytes, psnr " << std::setprecision(4) << psnrFirstFit << " / " << psnrRD << std::endl;
+        // rate-distortion decision must not make the stream bigger and keep about the same quality
+        CATCH_REQUIRE(sizeRD <= sizeFirstFit);
+        CATCH_REQUIRE(psnrRD >= psnrFirstFit - 0.5);
+    }
+}
+
+TEST_CASE("SceneCutKeyFrame")
+{
+    // a sequence frame followed by an unrelated image
+    const std::vector<Image::Frame> images = {IO::File::readImage(DataPathGBAVideos + SequenceFiles.front()), IO::File::readImage(DataPathGBAVideos + SequenceFiles.back()), IO::File::readImage(DataPathGBAImages + "TearsOfSteel_676_240x160.png")};
+    const std::vector<bool> expectKeyFrame = {true, false, true};
+    constexpr bool swapToBGR = true;
+    std::vector<Color::XRGB8888> prevPixels;
+    for (std::size_t i = 0; i < images.size(); ++i)
+    {
+        const auto size = images[i].info.size;
+        const auto inPixels = images[i].data.pixels().convertData<Color::XRGB8888>();
+        const auto [compressedData, frameBuffer] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR);
+        const auto frameHeader = Video::DxtvFrameHeader::read(reinterpret_cast<const uint32_t *>(compressedData.data()));
+        CATCH_REQUIRE(((frameHeader.frameFlags & Video::DxtvConstants::FRAME_IS_KEY) != 0) == expectKeyFrame[i]);
+        // key frames must decode without the previous frame
+        auto outPixels = Video::Dxtv::decode(compressedData, expectKeyFrame[i] ? std::vector<Color::XRGB8888>() : prevPixels, size.width(), size.height(), swapToBGR);
+        CATCH_REQUIRE(outPixels == frameBuffer);
+        prevPixels = frameBuffer;
+    }
+}
+
+TEST_CASE("DecodeBuffer")
+{
+    std::vector<Image::Frame> images;
+    for (const auto &file : SequenceFiles)
+    {
+        images.push_back(IO::File::readImage(DataPathGBAVideos + file));
+    }
+    constexpr bool swapToBGR = true;
+    const auto size = images.front().info.size;
+    // decode to preallocated buffers and compare with the vector decoder
+    std::vector<Color::XRGB8888> prevPixels;
+    std::vector<Color::XRGB8888> currBuffer(size.width() * size.height());
+    std::vector<Color::XRGB8888> prevBuffer(size.width() * size.height());
+    for (const auto &data : images)
+    {
+        const auto inPixels = data.data.pixels().convertData<Color::XRGB8888>();
+        const auto [compressedData, frameBuffer] = Video::Dxtv::encode(inPixels, prevPixels, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR);
+        Video::Dxtv::decode(compressedData.data(), compressedData.size(), currBuffer.data(), prevPixels.empty() ? nullptr : prevBuffer.data(), size.width(), size.height(), swapToBGR);
+        CATCH_REQUIRE(currBuffer == Video::Dxtv::decode(compressedData, prevPixels, size.width(), size.height(), swapToBGR));
+        CATCH_REQUIRE(currBuffer == frameBuffer);
+        std::swap(currBuffer, prevBuffer);
+        prevPixels = frameBuffer;
+    }
+}
+
+TEST_CASE("DecodeKeyFrameWithPreviousReference")
+{
+    // build a 16x8 key frame by hand: one 8x8 DXT block and one block referencing the previous frame
+    constexpr uint32_t width = 16;
+    constexpr uint32_t height = 8;
+    std::vector<uint8_t> frameData(sizeof(Video::DxtvFrameHeader) + 2 + 20 + 2, 0);
+    Video::DxtvFrameHeader frameHeader;
+    frameHeader.frameFlags = Video::DxtvConstants::FRAME_IS_KEY;
+    frameHeader.uncompressedSize = width * height * 2;
+    Video::DxtvFrameHeader::write(reinterpret_cast<uint32_t *>(frameData.data()), frameHeader);
+    auto blockData = reinterpret_cast<uint16_t *>(frameData.data() + sizeof(Video::DxtvFrameHeader));
+    blockData[0] = 0; // no split blocks, block 0 is an 8x8 DXT block of 10 uint16_t
+    // block 1 references the previous frame with zero motion
+    blockData[11] = Video::DxtvConstants::BLOCK_IS_REF | Video::DxtvConstants::BLOCK_FROM_PREV | (Video::DxtvConstants::BLOCK_HALF_RANGE << Video::DxtvConstants::BLOCK_MOTION_Y_SHIFT) | Video::DxtvConstants::BLOCK_HALF_RANGE;
+    const std::vector<Color::XRGB8888> prevPixels(width * height);
+    std::vector<Color::XRGB8888> currPixels(width * height);
+    // key frames must not be decoded from the previous frame even if it is passed in
+    CATCH_REQUIRE_THROWS(Video::Dxtv::decode(frameData.data(), frameData.size(), currPixels.data(), prevPixels.data(), width, height, false));
+    // the same frame is fine when it is not a key frame
+    frameHeader.frameFlags = 0;
+    Video::DxtvFrameHeader::write(reinterpret_cast<uint32_t *>(frameData.data()), frameHeader);
+    CATCH_REQUIRE_NOTHROW(Video::Dxtv::decode(frameData.data(), frameData.size(), currPixels.data(), prevPixels.data(), width, height, false));
+}
+
+TEST_CASE("DecodeTruncatedFrame")
+{
+    auto image = IO::File::readImage(DataPathGBAImages + "BigBuckBunny_361_240x160.png");
+    constexpr bool swapToBGR = true;
+    const auto size = image.info.size;
+    const auto inPixels = image.data.pixels().convertData<Color::XRGB8888>();
+    const auto [compressedData, frameBuffer] = Video::Dxtv::encode(inPixels, {}, size.width(), size.height(), ImageQualityDXT8x8, swapToBGR);
+    std::vector<Color::XRGB8888> outPixels(size.width() * size.height());
+    CATCH_REQUIRE_NOTHROW(Video::Dxtv::decode(compressedData.data(), compressedData.size(), outPixels.data(), nullptr, size.width(), size.height(), swapToBGR));
+    // cutting off the last block or only some bytes of it must be detected
+    for (const std::size_t missing : {std::size_t(1), std::size_t(2), std::size_t(8), compressedData.size() / 2})
+    {
+        CATCH_REQUIRE_THROWS(Video::Dxtv::decode(compressedData.data(), compressedData.size() - missing, outPixels.data(), nullptr, size.width(), size.height(), swapToBGR));
+    }
+}
@@ -0,0 +1,309 @@
+#include "testmacros.h"
+
+#include "processing/framepipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("FramePipeline")
+
+struct TestInput
+{
+    char type = 0; // 'v' = video, 'a' = audio, 's' = subtitle
+    uint32_t index = 0;
+};
+
+struct TestVideo
+{
+    uint32_t index = 0;
+    uint32_t framesSinceReset = 0;
+};
+
+struct TestAudio
+{
+    uint32_t index = 0;
+    uint32_t nrOfSamples = 0;
+};
+
+struct TestSubtitle
+{
+    uint32_t index = 0;
+};
+
+using TestPipeline = FramePipeline<TestInput, TestVideo, TestAudio, TestSubtitle>;
+
+constexpr uint32_t NrOfFrames = 60;
+constexpr uint32_t SubtitleInterval = 10;
+constexpr uint32_t SamplesPerFrame = 100;
+constexpr uint32_t SamplesPerOutputFrame = 250;
+constexpr uint32_t NrOfSlowFrames = 64;
+
+/// @brief Source with a subtitle every N video frames and an audio frame after every video frame
+auto createReader(uint32_t nrOfFrames) -> TestPipeline::Reader
+{
+    return [nrOfFrames, frame = 0U, step = 0U]() mutable -> std::optional<TestInput>
+    {
+        if (frame >= nrOfFrames)
+        {
+            return std::nullopt;
+        }
+        if (step == 0)
+        {
+            step = 1;
+            if (frame % SubtitleInterval == 0)
+            {
+                return TestInput{'s', frame / SubtitleInterval};
+            }
+        }
+        if (step == 1)
+        {
+            step = 2;
+            return TestInput{'v', frame};
+        }
+        step = 0;
+        return TestInput{'a', frame++};
+    };
+}
+
+/// @brief Stateful video stage counting the frames processed since the last reset. Takes a bit of time per frame
+auto createVideoStage() -> TestPipeline::VideoStage
+{
+    auto framesSinceReset = std::make_shared<uint32_t>(0);
+    return {[framesSinceReset](const TestVideo &frame)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100 * (frame.index % 3)));
+                return TestVideo{frame.index, (*framesSinceReset)++};
+            },
+            [framesSinceReset]()
+            { *framesSinceReset = 0; }};
+}
+
+/// @brief Audio stage buffering samples and only returning full output frames
+auto createAudioStage() -> TestPipeline::AudioStage
+{
+    return [bufferedSamples = 0U, outIndex = 0U](const std::optional<TestAudio> &frame) mutable -> std::optional<TestAudio>
+    {
+        bufferedSamples += frame.has_value() ? frame->nrOfSamples : 0;
+        if (bufferedSamples >= SamplesPerOutputFrame || (!frame.has_value() && bufferedSamples > 0))
+        {
+            const auto nrOfSamples = std::min(bufferedSamples, SamplesPerOutputFrame);
+            bufferedSamples -= nrOfSamples;
+            return TestAudio{outIndex++, nrOfSamples};
+        }
+        return std::nullopt;
+    };
+}
+
+auto toString(const TestPipeline::OutputFrame &frame) -> std::string
+{
+    switch (frame.index())
+    {
+    case 0:
+        return "s" + std::to_string(std::get<0>(frame).index);
+    case 1:
+        return "v" + std::to_string(std::get<1>(frame).index) + ":" + std::to_string(std::get<1>(frame).framesSinceReset);
+    default:
+        return "a" + std::to_string(std::get<2>(frame).index) + ":" + std::to_string(std::get<2>(frame).nrOfSamples);
+    }
+}
+
+/// @brief Pass all input to the pipeline like vid2h does and wait for all frames to be written
+auto runPipeline(TestPipeline &pipeline) -> void
+{
+    while (auto input = pipeline.pop())
+    {
+        bool pushed = true;
+        switch (input->type)
+        {
+        case 'v':
+            pushed = pipeline.pushVideo({input->index, 0});
+            break;
+        case 'a':
+            pushed = pipeline.pushAudio(TestAudio{input->index, SamplesPerFrame});
+            break;
+        default:
+            pushed = pipeline.pushOther({input->index});
+            break;
+        }
+        if (!pushed)
+        {
+            break;
+        }
+    }
+    pipeline.pushAudio(std::nullopt);
+    pipeline.finish();
+}
+
+/// @brief Run all stages in order in one thread, resetting the video stage every N frames
+auto referenceOutput(uint32_t nrOfFrames, uint32_t keyFrameInterval) -> std::vector<std::string>
+{
+    std::vector<std::string> output;
+    auto reader = createReader(nrOfFrames);
+    auto videoStage = createVideoStage();
+    auto audioStage = createAudioStage();
+    while (auto input = reader())
+    {
+        if (input->type == 'v')
+        {
+            if (keyFrameInterval > 0 && input->index % keyFrameInterval == 0)
+            {
+                videoStage.reset();
+            }
+            output.push_back(toString(TestPipeline::OutputFrame(std::in_place_index<1>, videoStage.process({input->index, 0}))));
+        }
+        else if (input->type == 'a')
+        {
+            if (auto frame = audioStage(TestAudio{input->index, SamplesPerFrame}))
+            {
+                output.push_back(toString(TestPipeline::OutputFrame(std::in_place_index<2>, frame.value())));
+            }
+        }
+        else
+        {
+            output.push_back(toString(TestPipeline::OutputFrame(std::in_place_index<0>, TestSubtitle{input->index})));
+        }
+    }
+    if (auto frame = audioStage(std::nullopt))
+    {
+        output.push_back(toString(TestPipeline::OutputFrame(std::in_place_index<2>, frame.value())));
+    }
+    return output;
+}
+
+TEST_CASE("SequentialOutputOrder")
+{
+    std::vector<std::string> output;
+    std::atomic<uint32_t> nrOfStages = 0;
+    std::atomic<uint32_t> nrOfSegmentStages = 0;
+    {
+        TestPipeline pipeline({4, 0, 0}, createReader(NrOfFrames), [&nrOfStages, &nrOfSegmentStages](bool segmentWorker)
+                              {
+                ++nrOfStages;
+                nrOfSegmentStages += segmentWorker ? 1 : 0;
+                return createVideoStage(); }, createAudioStage(), [&output](const TestPipeline::OutputFrame &frame)
+                              { output.push_back(toString(frame)); });
+        runPipeline(pipeline);
+    }
+    CATCH_REQUIRE(nrOfStages == 1);
+    CATCH_REQUIRE(nrOfSegmentStages == 0);
+    CATCH_REQUIRE(output == referenceOutput(NrOfFrames, 0));
+}
+
+TEST_CASE("SegmentOutputOrder")
+{
+    // segments must be processed in order by one worker each, starting with a reset stage
+    for (uint32_t keyFrameInterval : {1U, 7U, 20U, 100U})
+    {
+        std::vector<std::string> output;
+        std::atomic<uint32_t> nrOfStages = 0;
+        std::atomic<uint32_t> nrOfSegmentStages = 0;
+        {
+            TestPipeline pipeline({4, keyFrameInterval, 3}, createReader(NrOfFrames), [&nrOfStages, &nrOfSegmentStages](bool segmentWorker)
+                                  {
+                    ++nrOfStages;
+                    nrOfSegmentStages += segmentWorker ? 1 : 0;
+                    return createVideoStage(); }, createAudioStage(), [&output](const TestPipeline::OutputFrame &frame)
+                                  { output.push_back(toString(frame)); });
+            runPipeline(pipeline);
+        }
+        CATCH_REQUIRE(nrOfStages <= 3);
+        CATCH_REQUIRE(nrOfSegmentStages == nrOfStages);
+        CATCH_REQUIRE(output == referenceOutput(NrOfFrames, keyFrameInterval));
+    }
+}
+
+TEST_CASE("ProcessingErrorStopsPipeline")
+{
+    for (uint32_t keyFrameInterval : {0U, 7U})
+    {
+        uint32_t nrOfVideoFramesWritten = 0;
+        TestPipeline pipeline({4, keyFrameInterval, 3}, createReader(NrOfFrames), [](bool)
+                              {
+                auto stage = createVideoStage();
+                auto process = stage.process;
+                stage.process = [process](const TestVideo &frame)
+                {
+                    if (frame.index == 20)
+                    {
+                        throw std::runtime_error("Processing failed");
+                    }
+                    return process(frame);
+                };
+                return stage; }, createAudioStage(), [&nrOfVideoFramesWritten](const TestPipeline::OutputFrame &frame)
+                              { nrOfVideoFramesWritten += frame.index() == 1 ? 1 : 0; });
+        CATCH_REQUIRE_THROWS_AS(runPipeline(pipeline), std::runtime_error);
+        CATCH_REQUIRE(nrOfVideoFramesWritten == 20);
+    }
+}
+
+TEST_CASE("ReaderErrorIsRethrown")
+{
+    uint32_t nrOfFramesWritten = 0;
+    TestPipeline pipeline({4, 0, 0}, [reader = createReader(NrOfFrames), nrOfInputs = 0U]() mutable
+                          {
+            if (++nrOfInputs > 10)
+            {
+                throw std::runtime_error("Reading failed");
+            }
+            return reader(); }, [](bool)
+                          { return createVideoStage(); }, createAudioStage(), [&nrOfFramesWritten](const TestPipeline::OutputFrame &)
+                          { ++nrOfFramesWritten; });
+    CATCH_REQUIRE_THROWS_AS(runPipeline(pipeline), std::runtime_error);
+    // frames read before the error are still written
+    CATCH_REQUIRE(nrOfFramesWritten > 0);
+}
+
+TEST_CASE("StopWithoutFinish")
+{
+    // reader never reaches the end of input and the pipeline is destroyed while all stages are busy
+    for (uint32_t keyFrameInterval : {0U, 7U})
+    {
+        TestPipeline pipeline({2, keyFrameInterval, 3}, createReader(UINT32_MAX), [](bool)
+                              { return createVideoStage(); }, createAudioStage(), [](const TestPipeline::OutputFrame &)
+                              { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            auto input = pipeline.pop();
+            CATCH_REQUIRE(input.has_value());
+            if (input->type == 'v')
+            {
+                CATCH_REQUIRE(pipeline.pushVideo({input->index, 0}));
+            }
+        }
+    }
+}
+
+TEST_CASE("SegmentsRunInParallel")
+{
+    // video stage is the bottleneck, so segment workers should divide the wall-clock time
+    auto runTimed = [](uint32_t keyFrameInterval, uint32_t nrOfSegmentWorkers)
+    {
+        uint32_t nrOfVideoFramesWritten = 0;
+        const auto startTime = std::chrono::steady_clock::now();
+        TestPipeline pipeline({4, keyFrameInterval, nrOfSegmentWorkers}, createReader(NrOfSlowFrames), [](bool)
+                              {
+                auto stage = createVideoStage();
+                auto process = stage.process;
+                stage.process = [process](const TestVideo &frame)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+                    return process(frame);
+                };
+                return stage; }, createAudioStage(), [&nrOfVideoFramesWritten](const TestPipeline::OutputFrame &frame)
+                              { nrOfVideoFramesWritten += frame.index() == 1 ? 1 : 0; });
+        runPipeline(pipeline);
+        CATCH_REQUIRE(nrOfVideoFramesWritten == NrOfSlowFrames);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    };
+    const auto sequentialS = runTimed(0, 0);
+    const auto segmentsS = runTimed(8, 4);
+    CATCH_REQUIRE(segmentsS < 0.6 * sequentialS);
+}
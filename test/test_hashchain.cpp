@@ -0,0 +1,89 @@
+#include "testmacros.h"
+
+#include "compression/hashchain.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Compression;
+
+TEST_SUITE("HashChain")
+
+/// @brief Brute-force search for the longest match with the smallest distance
+auto referenceMatch(const std::vector<uint8_t> &data, uint32_t position, uint32_t minLength, uint32_t maxLength, uint32_t maxDistance, uint32_t minDistance) -> HashChain::Match
+{
+    HashChain::Match bestMatch;
+    maxLength = std::min(maxLength, static_cast<uint32_t>(data.size()) - position);
+    for (uint32_t distance = minDistance; distance <= maxDistance && distance <= position; ++distance)
+    {
+        uint32_t length = 0;
+        while (length < maxLength && data[position - distance + length] == data[position + length])
+        {
+            ++length;
+        }
+        if (length >= minLength && length > bestMatch.length)
+        {
+            bestMatch = {distance, length};
+        }
+    }
+    return bestMatch;
+}
+
+/// @brief Random data from a small alphabet, so there are a lot of matches of different lengths
+auto randomData(std::size_t size) -> std::vector<uint8_t>
+{
+    std::mt19937 rng(4321);
+    std::vector<uint8_t> data(size);
+    for (auto &d : data)
+    {
+        d = rng() % 3;
+    }
+    return data;
+}
+
+TEST_CASE("FindsLongestMatch")
+{
+    const auto data = randomData(3000);
+    for (uint32_t minLength : {3U, 4U})
+    {
+        for (uint32_t minDistance : {1U, 2U})
+        {
+            constexpr uint32_t MaxLength = 40;
+            constexpr uint32_t MaxDistance = 500;
+            // unlimited chain depth must find the same matches as a brute-force search
+            HashChain hashChain(data, minLength, MaxLength, MaxDistance, minDistance, 1 << 20);
+            for (uint32_t position = 0; position < data.size(); ++position)
+            {
+                const auto match = hashChain.findMatch(position, MaxLength);
+                const auto reference = referenceMatch(data, position, minLength, MaxLength, MaxDistance, minDistance);
+                CATCH_REQUIRE(match.length == reference.length);
+                CATCH_REQUIRE(match.distance == reference.distance);
+                hashChain.insert(position);
+            }
+        }
+    }
+}
+
+TEST_CASE("LimitedChainDepth")
+{
+    const auto data = randomData(3000);
+    HashChain hashChain(data, 3, 18, 4095, 1, 4);
+    for (uint32_t position = 0; position < data.size(); ++position)
+    {
+        // matches must be valid, but might not be the longest
+        const auto match = hashChain.findMatch(position, 18);
+        if (match.length > 0)
+        {
+            CATCH_REQUIRE(match.length >= 3);
+            CATCH_REQUIRE(match.length <= 18);
+            CATCH_REQUIRE(match.distance >= 1);
+            CATCH_REQUIRE(match.distance <= position);
+            CATCH_REQUIRE(std::equal(data.cbegin() + position - match.distance, data.cbegin() + position - match.distance + match.length, data.cbegin() + position));
+        }
+        hashChain.insert(position);
+    }
+    // no matches past the end of data
+    CATCH_REQUIRE(hashChain.findMatch(data.size() - 2, 18).length == 0);
+    CATCH_REQUIRE_THROWS(HashChain(data, 2, 18, 4095, 1, 4));
+}
@@ -0,0 +1,83 @@
+#include "testmacros.h"
+
+#include "color/rgb565.h"
+#include "color/xrgb1555.h"
+#include "color/xrgb8888.h"
+#include "math/histogram.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+TEST_SUITE("Histogram")
+
+template <typename T>
+static auto referenceHistogram(const std::vector<T> &data) -> std::map<T, uint64_t>
+{
+    std::map<T, uint64_t> histogram;
+    for (const auto &value : data)
+    {
+        histogram[value]++;
+    }
+    return histogram;
+}
+
+template <typename T>
+static auto checkHistogram(const std::vector<T> &data) -> void
+{
+    const auto reference = referenceHistogram(data);
+    const auto flat = Histogram::buildFlatHistogram(data);
+    CATCH_REQUIRE(flat.size() == reference.size());
+    CATCH_REQUIRE(std::equal(flat.cbegin(), flat.cend(), reference.cbegin(), [](const auto &a, const auto &b)
+                             { return a.first == b.first && a.second == b.second; }));
+    CATCH_REQUIRE(Histogram::buildHistogram(data) == reference);
+}
+
+TEST_CASE("FlatHistogram")
+{
+    Histogram::FlatHistogram<Color::XRGB8888> h0;
+    CATCH_REQUIRE(h0.size() == 0);
+    CATCH_REQUIRE(h0.entries().empty());
+    // add enough values to grow the hash table
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        h0.add(Color::XRGB8888(i * 3), i + 1);
+    }
+    h0.add(Color::XRGB8888(0), 10);
+    CATCH_REQUIRE(h0.size() == 5000);
+    Histogram::FlatHistogram<Color::XRGB8888> h1;
+    h1.add(Color::XRGB8888(1));
+    h1.add(Color::XRGB8888(3), 2);
+    h0.merge(h1);
+    const auto entries = h0.entries();
+    CATCH_REQUIRE(entries.size() == 5001);
+    CATCH_REQUIRE(entries[0] == std::make_pair(Color::XRGB8888(0), uint64_t(11)));
+    CATCH_REQUIRE(entries[1] == std::make_pair(Color::XRGB8888(1), uint64_t(1)));
+    CATCH_REQUIRE(entries[2] == std::make_pair(Color::XRGB8888(3), uint64_t(4)));
+    CATCH_REQUIRE(entries.back() == std::make_pair(Color::XRGB8888(4999 * 3), uint64_t(5000)));
+}
+
+TEST_CASE("BuildHistogram")
+{
+    std::mt19937 gen(1234);
+    for (std::size_t size : {0, 1, 1000, 300000})
+    {
+        std::vector<uint8_t> data8(size);
+        std::vector<Color::XRGB1555> data1555(size);
+        std::vector<Color::RGB565> data565(size);
+        std::vector<Color::XRGB8888> data8888(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto value = gen();
+            data8[i] = static_cast<uint8_t>(value);
+            data1555[i] = Color::XRGB1555(static_cast<uint16_t>(value & 0x7FFF));
+            data565[i] = Color::RGB565(static_cast<uint16_t>(value));
+            // limit number of distinct values, so values occur multiple times
+            data8888[i] = Color::XRGB8888(value & 0x0F0F3F);
+        }
+        checkHistogram(data8);
+        checkHistogram(data1555);
+        checkHistogram(data565);
+        checkHistogram(data8888);
+    }
+}
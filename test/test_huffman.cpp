@@ -0,0 +1,109 @@
+#include "testmacros.h"
+
+#include "compression/huffman.h"
+#include "exception.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const std::vector<std::string> HuffmanTestFiles = {
+    "lorem_ipsum_2k.txt",
+    "artificial_240x160.raw",
+    "BigBuckBunny_40_240x160.raw",
+    "black_240x160.raw",
+    "squish_240x160.raw",
+    "bbb_adpcm_22050.wav"};
+
+static const std::string DataPathTest = "../../data/data/";
+
+using namespace Compression;
+
+TEST_SUITE("Huffman")
+
+static const char LoremIpsum[] = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam nonumy eirmod tempor invidunt ut labore et dolore magna aliquyam erat, sed diam voluptua. At vero eos et accusam et justo duo dolores et ea rebum. Stet clita kasd gubergren, no sea takimata sanctus est Lorem ipsum dolor sit amet.";
+
+static auto randomData(std::size_t size, uint32_t nrOfSymbols) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> data(size);
+    uint32_t random = 12345;
+    for (auto &d : data)
+    {
+        random = random * 1664525 + 1013904223;
+        d = static_cast<uint8_t>((random >> 16) % nrOfSymbols);
+    }
+    return data;
+}
+
+TEST_CASE("Huffman roundtrip")
+{
+    const std::vector<uint8_t> text(LoremIpsum, LoremIpsum + sizeof(LoremIpsum));
+    // a full byte range gives a balanced tree, which is the hardest to store
+    std::vector<uint8_t> allBytes(256 * 16);
+    for (std::size_t i = 0; i < allBytes.size(); ++i)
+    {
+        allBytes[i] = static_cast<uint8_t>(i);
+    }
+    // symbol counts following the Fibonacci sequence give the deepest tree
+    std::vector<uint8_t> fibonacci;
+    uint32_t count0 = 1;
+    uint32_t count1 = 1;
+    for (uint8_t symbol = 0; symbol < 20; ++symbol)
+    {
+        fibonacci.insert(fibonacci.end(), count0, symbol);
+        count0 = std::exchange(count1, count0 + count1);
+    }
+    for (const auto &data : {std::vector<uint8_t>(1, 0), std::vector<uint8_t>(3, 7), std::vector<uint8_t>(1000, 0xFF), text, allBytes, fibonacci, randomData(1001, 256), randomData(4096, 5)})
+    {
+        for (uint32_t bitsPerSymbol : {4U, 8U})
+        {
+            const auto compressed = encodeHuffman_20(data, bitsPerSymbol);
+            CATCH_REQUIRE(compressed.size() % 4 == 0);
+            CATCH_REQUIRE(compressed[0] == (HUFFMAN_TYPE_MARKER | bitsPerSymbol));
+            CATCH_REQUIRE(data == decodeHuffman_20(compressed));
+        }
+    }
+    CATCH_REQUIRE(encodeHuffman_20(text, 8).size() < text.size());
+    CATCH_REQUIRE_THROWS(encodeHuffman_20({}, 8));
+    CATCH_REQUIRE_THROWS(encodeHuffman_20(text, 6));
+}
+
+TEST_CASE("Huffman skewed 8-bit tree")
+{
+    // groups of 4 symbols with counts falling from 1024 to 2 and repeating give a wide and deep tree.
+    // Some nodes reach the end of their 6-bit offset range and must be stored before smaller subtrees
+    std::vector<uint8_t> data;
+    for (uint32_t symbol = 0; symbol < 256; ++symbol)
+    {
+        data.insert(data.end(), 1024 >> ((symbol / 4) % 10), static_cast<uint8_t>(symbol));
+    }
+    // interleave symbols, so the data is not just runs
+    std::vector<uint8_t> shuffled(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        shuffled[(i * 7919) % data.size()] = data[i];
+    }
+    const auto compressed = encodeHuffman_20(shuffled, 8);
+    CATCH_REQUIRE(shuffled == decodeHuffman_20(compressed));
+    CATCH_REQUIRE(compressed.size() < shuffled.size());
+}
+
+TEST_CASE("Huffman ratio")
+{
+    for (auto &testFile : HuffmanTestFiles)
+    {
+        // open test file
+        std::ifstream fs(DataPathTest + testFile, std::ios::binary | std::ios::in);
+        REQUIRE(fs.is_open(), std::runtime_error, "Failed to open " << testFile << " for reading");
+        // read all of the file data
+        std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
+        for (uint32_t bitsPerSymbol : {4U, 8U})
+        {
+            auto compressedData = encodeHuffman_20(fileData, bitsPerSymbol);
+            std::cout << testFile << " (" << bitsPerSymbol << "-bit) compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%)" << std::endl;
+            CATCH_REQUIRE(fileData == decodeHuffman_20(compressedData));
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include "testmacros.h"
+
+#include "color/cielabf.h"
+#include "color/colorhelpers.h"
+#include "color/conversions.h"
+#include "color/gamma.h"
+#include "math/kdtree.h"
+
+#include <random>
+#include <vector>
+
+TEST_SUITE("KdTree")
+
+TEST_CASE("Empty")
+{
+    const KdTree<Color::CIELabf> tree;
+    CATCH_REQUIRE(tree.empty());
+    CATCH_REQUIRE_THROWS(tree.closestIndex(Color::CIELabf(50.0F, 0.0F, 0.0F)));
+    const KdTree<Color::CIELabf> single(std::vector<Color::CIELabf>{Color::CIELabf(50.0F, 10.0F, -10.0F)});
+    CATCH_REQUIRE(single.size() == 1);
+    CATCH_REQUIRE(single.closestIndex(Color::CIELabf(0.0F, 0.0F, 0.0F)) == 0);
+}
+
+TEST_CASE("ClosestIndexMatchesLinearSearch")
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> distL(0.0F, 100.0F);
+    std::uniform_real_distribution<float> distAB(-128.0F, 127.0F);
+    for (std::size_t nrOfColors : {2, 16, 256, 4096})
+    {
+        std::vector<Color::CIELabf> colors(nrOfColors);
+        for (auto &c : colors)
+        {
+            c = Color::CIELabf(distL(gen), distAB(gen), distAB(gen));
+        }
+        const KdTree<Color::CIELabf> tree(colors);
+        CATCH_REQUIRE(tree.size() == nrOfColors);
+        for (uint32_t i = 0; i < 10000; ++i)
+        {
+            const Color::CIELabf query(distL(gen), distAB(gen), distAB(gen));
+            CATCH_REQUIRE(tree.closestIndex(query) == ColorHelpers::getClosestColorIndex(query, colors));
+        }
+        // querying the colors themselves must return their index
+        for (std::size_t i = 0; i < colors.size(); ++i)
+        {
+            CATCH_REQUIRE(tree.closestIndex(colors[i]) == i);
+        }
+    }
+}
+
+TEST_CASE("TiesReturnSmallestIndex")
+{
+    // duplicate colors and colors on a coarse grid produce many ties
+    std::vector<Color::CIELabf> colors;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        for (float L : {0.0F, 50.0F, 100.0F})
+        {
+            for (float a : {-100.0F, 0.0F, 100.0F})
+            {
+                for (float b : {-100.0F, 0.0F, 100.0F})
+                {
+                    colors.push_back(Color::CIELabf(L, a, b));
+                }
+            }
+        }
+    }
+    const KdTree<Color::CIELabf> tree(colors);
+    for (float L : {0.0F, 25.0F, 50.0F, 75.0F, 100.0F})
+    {
+        for (float a : {-100.0F, -50.0F, 0.0F, 50.0F, 100.0F})
+        {
+            for (float b : {-100.0F, -50.0F, 0.0F, 50.0F, 100.0F})
+            {
+                const Color::CIELabf query(L, a, b);
+                const auto index = tree.closestIndex(query);
+                CATCH_REQUIRE(index < 27);
+                CATCH_REQUIRE(index == ColorHelpers::getClosestColorIndex(query, colors));
+            }
+        }
+    }
+}
+
+TEST_CASE("ColorSpaceRGB555")
+{
+    const auto colorSpace = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(ColorHelpers::buildColorMapFor(Color::Format::XRGB1555)));
+    const KdTree<Color::CIELabf> tree(colorSpace);
+    std::mt19937 gen(5678);
+    std::uniform_int_distribution<uint32_t> distRGB(0, 0xFFFFFF);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const auto query = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(Color::XRGB8888(distRGB(gen))));
+        CATCH_REQUIRE(tree.closestIndex(query) == ColorHelpers::getClosestColorIndex(query, colorSpace));
+    }
+}
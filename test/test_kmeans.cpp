@@ -0,0 +1,156 @@
+#include "testmacros.h"
+
+#include "color/cielabf.h"
+#include "math/kmeans.h"
+
+#include <omp.h>
+
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST_SUITE("Kmeans")
+
+struct TestCluster
+{
+    Color::CIELabf center;
+    uint32_t weight = 0;
+};
+
+/// @brief Serial maximin initialization to compare against
+static auto referenceMaximin(const std::vector<Color::CIELabf> &positions, std::size_t nrOfClusters) -> std::vector<Color::CIELabf>
+{
+    BoundingBox<Color::CIELabf> bounds(positions.front());
+    for (const auto &p : positions)
+    {
+        bounds |= p;
+    }
+    std::vector<Color::CIELabf> centers = {0.5F * (bounds.min() + bounds.max())};
+    std::vector<float> closestDistance(positions.size(), std::numeric_limits<float>::max());
+    while (centers.size() < nrOfClusters)
+    {
+        const auto prevCenter = centers.back();
+        auto maxDistance = std::numeric_limits<float>::lowest();
+        auto maxPosition = positions.front();
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            closestDistance[i] = std::min(closestDistance[i], Color::CIELabf::mse(positions[i], prevCenter));
+            if (maxDistance < closestDistance[i])
+            {
+                maxDistance = closestDistance[i];
+                maxPosition = positions[i];
+            }
+        }
+        centers.push_back(maxPosition);
+    }
+    return centers;
+}
+
+TEST_CASE("InitMaximin")
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> distL(0.0F, 100.0F);
+    std::uniform_real_distribution<float> distAB(-128.0F, 127.0F);
+    CATCH_REQUIRE_THROWS(Kmeans::initMaximin<TestCluster>(std::vector<Color::CIELabf>(), 16));
+    const auto maxThreads = omp_get_max_threads();
+    for (std::size_t nrOfPositions : {1, 100, 50000})
+    {
+        std::vector<Color::CIELabf> positions(nrOfPositions);
+        for (auto &p : positions)
+        {
+            p = Color::CIELabf(distL(gen), distAB(gen), distAB(gen));
+        }
+        // duplicate positions produce ties in the maximum distance
+        positions.insert(positions.end(), positions.cbegin(), positions.cend());
+        for (std::size_t nrOfClusters : {1, 16, 256})
+        {
+            const auto reference = referenceMaximin(positions, nrOfClusters);
+            // result must not depend on the number of threads
+            for (int nrOfThreads : {1, 3, 8})
+            {
+                omp_set_num_threads(nrOfThreads);
+                const auto clusters = Kmeans::initMaximin<TestCluster>(positions, nrOfClusters);
+                CATCH_REQUIRE(clusters.size() == nrOfClusters);
+                for (std::size_t i = 0; i < nrOfClusters; ++i)
+                {
+                    CATCH_REQUIRE(clusters[i].center == reference[i]);
+                }
+            }
+        }
+    }
+    omp_set_num_threads(maxThreads);
+}
+
+/// @brief Online k-means comparing positions to all cluster centers to compare against
+static auto referenceOnlineKmeans(std::vector<TestCluster> &clusters, const std::vector<Color::CIELabf> &positions, const float learnRateExponent) -> void
+{
+    for (auto &cluster : clusters)
+    {
+        cluster.weight = 0;
+    }
+    std::size_t lcpA = 0;
+    do
+    {
+        lcpA = 1 + std::rand() % (positions.size() - 1);
+    } while (std::gcd(lcpA, positions.size()) != 1);
+    const std::size_t lcpB = std::rand() % positions.size();
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        const auto position = positions[(i * lcpA + lcpB) % positions.size()];
+        std::size_t bestClusterIndex = 0;
+        auto bestClusterDistance = std::numeric_limits<float>::max();
+        for (std::size_t clusterIndex = 0; clusterIndex < clusters.size(); clusterIndex++)
+        {
+            const auto distanceToCluster = Color::CIELabf::mse(position, clusters[clusterIndex].center);
+            if (distanceToCluster < bestClusterDistance)
+            {
+                bestClusterDistance = distanceToCluster;
+                bestClusterIndex = clusterIndex;
+            }
+        }
+        auto &cluster = clusters[bestClusterIndex];
+        cluster.weight++;
+        const float learnRate = std::powf(cluster.weight, -learnRateExponent);
+        cluster.center += learnRate * (position - cluster.center);
+    }
+}
+
+TEST_CASE("OnlineKmeans")
+{
+    std::mt19937 gen(5678);
+    std::uniform_real_distribution<float> distL(0.0F, 100.0F);
+    std::uniform_real_distribution<float> distAB(-128.0F, 127.0F);
+    // few distinct positions produce ties in distances
+    for (std::size_t nrOfDistinctPositions : {8, 1000, 20000})
+    {
+        std::vector<Color::CIELabf> positions(nrOfDistinctPositions);
+        for (auto &p : positions)
+        {
+            p = Color::CIELabf(distL(gen), distAB(gen), distAB(gen));
+        }
+        while (positions.size() < 40000)
+        {
+            positions.push_back(positions[gen() % nrOfDistinctPositions]);
+        }
+        for (std::size_t nrOfClusters : {1, 2, 16, 64, 256})
+        {
+            auto clusters = Kmeans::initMaximin<TestCluster>(positions, nrOfClusters);
+            auto referenceClusters = clusters;
+            // run twice to also test with clusters that have been moved before
+            for (uint32_t run = 0; run < 2; ++run)
+            {
+                std::srand(run);
+                Kmeans::onlineKmeans(clusters, positions, 0.5F);
+                std::srand(run);
+                referenceOnlineKmeans(referenceClusters, positions, 0.5F);
+                for (std::size_t i = 0; i < nrOfClusters; ++i)
+                {
+                    CATCH_REQUIRE(clusters[i].center == referenceClusters[i].center);
+                    CATCH_REQUIRE(clusters[i].weight == referenceClusters[i].weight);
+                }
+            }
+        }
+    }
+}
@@ -2,8 +2,10 @@
 
 #include "compression/lz4.h"
 #include "exception.h"
+#include "image/imageio.h"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -25,7 +27,14 @@ static const std::vector<Lz4TestFile> Lz4TestFiles = {
     {"squish_240x160.raw", 61412},
     {"bbb_adpcm_22050.wav", 285560}};
 
+static const std::vector<std::string> SequenceFiles = {
+    "BigBuckBunny_240x160_15fps-178.png",
+    "BigBuckBunny_240x160_15fps-179.png",
+    "BigBuckBunny_240x160_15fps-180.png",
+    "BigBuckBunny_240x160_15fps-181.png"};
+
 const std::string DataPathTest = "../../data/data/";
+static const std::string DataPathGBAVideos = "../../data/videos/240x160/";
 
 using namespace Compression;
 
@@ -117,6 +126,32 @@ TEST_CASE("LZ4 roundtrip")
     CATCH_REQUIRE(TO_VECTOR8(v8) == decodeLZ4_40(encodeLZ4_40(TO_VECTOR8(v8))));
 }
 
+TEST_CASE("LZ4 roundtrip VRAM and chain depth")
+{
+    for (const auto &data : {TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, true), true));
+        for (uint32_t chainDepth : {1U, 16U, 4096U})
+        {
+            CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, false, false, chainDepth)));
+        }
+    }
+    // deeper chains must not compress worse
+    CATCH_REQUIRE(encodeLZ4_40(TO_VECTOR8(v5), false, false, 4096).size() <= encodeLZ4_40(TO_VECTOR8(v5), false, false, 1).size());
+}
+
+TEST_CASE("LZ4 optimal parse")
+{
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        const auto compressed = encodeLZ4_40(data, false, true);
+        CATCH_REQUIRE(data == decodeLZ4_40(compressed));
+        CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, true, true), true));
+        // optimal parsing must not compress worse than lazy matching
+        CATCH_REQUIRE(compressed.size() <= encodeLZ4_40(data, false, false).size());
+    }
+}
+
 TEST_CASE("LZ4 ratio")
 {
     for (auto &testFile : Lz4TestFiles)
@@ -126,10 +161,113 @@ TEST_CASE("LZ4 ratio")
         REQUIRE(fs.is_open(), std::runtime_error, "Failed to open " << testFile.fileName << " for reading");
         // read all of the file data
         std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
-        // compress and decompress file data
-        auto compressedData = encodeLZ4_40(fileData);
-        std::cout << testFile.fileName << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%)" << std::endl;
-        CATCH_REQUIRE(fileData == decodeLZ4_40(compressedData));
-        CATCH_REQUIRE(compressedData.size() <= testFile.maxSize);
+        // compress and decompress file data using regular and optimal parsing
+        for (bool optimalParse : {false, true})
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            auto compressedData = encodeLZ4_40(fileData, false, optimalParse);
+            const auto durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+            std::cout << testFile.fileName << (optimalParse ? " (optimal)" : "") << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%) in " << durationMs << " ms" << std::endl;
+            CATCH_REQUIRE(fileData == decodeLZ4_40(compressedData));
+            CATCH_REQUIRE(compressedData.size() <= testFile.maxSize);
+        }
+    }
+}
+
+TEST_CASE("LZ4 dictionary")
+{
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        for (const auto &dictionary : {std::vector<uint8_t>(), TO_VECTOR8(v5), TO_VECTOR8(v7), data})
+        {
+            for (bool optimalParse : {false, true})
+            {
+                CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, dictionary, false, optimalParse), dictionary));
+                CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, dictionary, true, optimalParse), dictionary, true));
+            }
+        }
+        // an empty dictionary must give the same result as no dictionary
+        CATCH_REQUIRE(encodeLZ4_40(data, std::vector<uint8_t>()) == encodeLZ4_40(data));
+    }
+    // data that is in the dictionary compresses to a few matches
+    const auto data = TO_VECTOR8(v6);
+    CATCH_REQUIRE(encodeLZ4_40(data, data).size() < 16);
+    // dictionaries bigger than the match distance only use their tail
+    std::vector<uint8_t> bigDictionary(100000, 0);
+    std::copy(data.cbegin(), data.cend(), std::prev(bigDictionary.end(), data.size()));
+    CATCH_REQUIRE(data == decodeLZ4_40(encodeLZ4_40(data, bigDictionary), bigDictionary));
+}
+
+TEST_CASE("LZ4 buffer decoder")
+{
+    const auto dictionary = TO_VECTOR8(v7);
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        for (bool optimalParse : {false, true})
+        {
+            const auto compressed = encodeLZ4_40(data, false, optimalParse);
+            // decode with and without room for wildcopies
+            for (std::size_t padding : {std::size_t(0), LZ4_WILDCOPY_PADDING})
+            {
+                std::vector<uint8_t> decoded(data.size() + padding);
+                CATCH_REQUIRE(decodeLZ4_40(compressed.data(), compressed.size(), decoded.data(), decoded.size()) == data.size());
+                decoded.resize(data.size());
+                CATCH_REQUIRE(decoded == decodeLZ4_40(compressed));
+            }
+        }
+        // the dictionary must directly precede the destination
+        const auto compressed = encodeLZ4_40(data, dictionary);
+        auto buffer = dictionary;
+        buffer.resize(dictionary.size() + data.size() + LZ4_WILDCOPY_PADDING);
+        CATCH_REQUIRE(decodeLZ4_40(compressed.data(), compressed.size(), buffer.data() + dictionary.size(), data.size() + LZ4_WILDCOPY_PADDING, dictionary.size()) == data.size());
+        CATCH_REQUIRE(std::equal(data.cbegin(), data.cend(), std::next(buffer.cbegin(), dictionary.size())));
+    }
+    // destination buffers that are too small and truncated data must throw
+    const auto data = TO_VECTOR8(v5);
+    const auto compressed = encodeLZ4_40(data);
+    std::vector<uint8_t> decoded(data.size() - 1);
+    CATCH_REQUIRE_THROWS(decodeLZ4_40(compressed.data(), compressed.size(), decoded.data(), decoded.size()));
+    decoded.resize(data.size());
+    CATCH_REQUIRE_THROWS(decodeLZ4_40(compressed.data(), compressed.size() / 2, decoded.data(), decoded.size()));
+}
+
+TEST_CASE("LZ4 dictionary ratio")
+{
+    // compress consecutive video frames with and without the previous frame as dictionary
+    std::vector<uint8_t> previousFrame;
+    std::size_t frameSize = 0;
+    std::size_t compressedSize = 0;
+    std::size_t compressedSizeDictionary = 0;
+    for (const auto &file : SequenceFiles)
+    {
+        const auto image = IO::File::readImage(DataPathGBAVideos + file);
+        const auto frame = image.data.pixels().convertDataToRaw();
+        const auto compressedDictionary = encodeLZ4_40(frame, previousFrame);
+        CATCH_REQUIRE(frame == decodeLZ4_40(compressedDictionary, previousFrame));
+        frameSize += frame.size();
+        compressedSize += encodeLZ4_40(frame).size();
+        compressedSizeDictionary += compressedDictionary.size();
+        previousFrame = frame;
+    }
+    std::cout << "Video frames compressed from " << frameSize << " to " << compressedSize << " bytes (" << static_cast<double>(compressedSize) / static_cast<double>(frameSize) * 100.0 << "%), with dictionary to " << compressedSizeDictionary << " bytes (" << static_cast<double>(compressedSizeDictionary) / static_cast<double>(frameSize) * 100.0 << "%)" << std::endl;
+    CATCH_REQUIRE(compressedSizeDictionary <= compressedSize);
+    // compress audio in chunks with and without the previous chunk as dictionary
+    std::ifstream fs(DataPathTest + "bbb_adpcm_22050.wav", std::ios::binary | std::ios::in);
+    REQUIRE(fs.is_open(), std::runtime_error, "Failed to open bbb_adpcm_22050.wav for reading");
+    std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
+    constexpr std::size_t ChunkSize = 4096;
+    std::vector<uint8_t> previousChunk;
+    compressedSize = 0;
+    compressedSizeDictionary = 0;
+    for (std::size_t offset = 0; offset < fileData.size(); offset += ChunkSize)
+    {
+        const std::vector<uint8_t> chunk(std::next(fileData.cbegin(), offset), std::next(fileData.cbegin(), std::min(offset + ChunkSize, fileData.size())));
+        const auto compressedDictionary = encodeLZ4_40(chunk, previousChunk);
+        CATCH_REQUIRE(chunk == decodeLZ4_40(compressedDictionary, previousChunk));
+        compressedSize += encodeLZ4_40(chunk).size();
+        compressedSizeDictionary += compressedDictionary.size();
+        previousChunk = chunk;
     }
+    std::cout << "Audio chunks compressed from " << fileData.size() << " to " << compressedSize << " bytes (" << static_cast<double>(compressedSize) / static_cast<double>(fileData.size()) * 100.0 << "%), with dictionary to " << compressedSizeDictionary << " bytes (" << static_cast<double>(compressedSizeDictionary) / static_cast<double>(fileData.size()) * 100.0 << "%)" << std::endl;
+    CATCH_REQUIRE(compressedSizeDictionary <= compressedSize);
 }
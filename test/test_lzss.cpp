@@ -4,6 +4,7 @@
 #include "exception.h"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -173,6 +174,59 @@ TEST_CASE("LZ10 roundtrip")
     CATCH_REQUIRE(TO_VECTOR8(v8) == decodeLZSS_10(encodeLZSS_10(TO_VECTOR8(v8))));
 }
 
+TEST_CASE("LZ10 roundtrip VRAM and chain depth")
+{
+    // repeat bitmap data so matches span more than the 4 KB window
+    auto tiles = TO_VECTOR8(v8);
+    while (tiles.size() < 3 * 4096)
+    {
+        tiles.insert(tiles.end(), tiles.cbegin(), std::next(tiles.cbegin(), tiles.size() / 3 + 1));
+    }
+    for (const auto &data : {TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v7), TO_VECTOR8(v8), tiles})
+    {
+        CATCH_REQUIRE(data == decodeLZSS_10(encodeLZSS_10(data, true), true));
+        for (uint32_t chainDepth : {1U, 16U, 4096U})
+        {
+            CATCH_REQUIRE(data == decodeLZSS_10(encodeLZSS_10(data, false, false, chainDepth)));
+        }
+    }
+    // deeper chains must not compress worse
+    CATCH_REQUIRE(encodeLZSS_10(tiles, false, false, 4096).size() <= encodeLZSS_10(tiles, false, false, 1).size());
+}
+
+TEST_CASE("LZ10 optimal parse")
+{
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        const auto compressed = encodeLZSS_10(data, false, true);
+        CATCH_REQUIRE(data == decodeLZSS_10(compressed));
+        CATCH_REQUIRE(data == decodeLZSS_10(encodeLZSS_10(data, true, true), true));
+        // optimal parsing must not compress worse
+        CATCH_REQUIRE(compressed.size() <= encodeLZSS_10(data, false, false).size());
+    }
+}
+
+TEST_CASE("LZ10 buffer decoder")
+{
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        for (bool vramCompatible : {false, true})
+        {
+            const auto compressed = encodeLZSS_10(data, vramCompatible);
+            std::vector<uint8_t> decoded(data.size());
+            CATCH_REQUIRE(decodeLZSS_10(compressed.data(), compressed.size(), decoded.data(), decoded.size()) == data.size());
+            CATCH_REQUIRE(decoded == decodeLZSS_10(compressed, vramCompatible));
+        }
+    }
+    // destination buffers that are too small and truncated data must throw
+    const auto data = TO_VECTOR8(v5);
+    const auto compressed = encodeLZSS_10(data);
+    std::vector<uint8_t> decoded(data.size() - 1);
+    CATCH_REQUIRE_THROWS(decodeLZSS_10(compressed.data(), compressed.size(), decoded.data(), decoded.size()));
+    decoded.resize(data.size());
+    CATCH_REQUIRE_THROWS(decodeLZSS_10(compressed.data(), compressed.size() / 2, decoded.data(), decoded.size()));
+}
+
 TEST_CASE("LZ10 ratio")
 {
     for (auto &testFile : LzssTestFiles)
@@ -182,10 +236,15 @@ TEST_CASE("LZ10 ratio")
         REQUIRE(fs.is_open(), std::runtime_error, "Failed to open " << testFile.fileName << " for reading");
         // read all of the file data
         std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
-        // compress and decompress file data
-        auto compressedData = encodeLZSS_10(fileData);
-        std::cout << testFile.fileName << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%)" << std::endl;
-        CATCH_REQUIRE(fileData == decodeLZSS_10(compressedData));
-        CATCH_REQUIRE(compressedData.size() <= testFile.maxSize);
+        // compress and decompress file data using regular and optimal parsing
+        for (bool optimalParse : {false, true})
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            auto compressedData = encodeLZSS_10(fileData, false, optimalParse);
+            const auto durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+            std::cout << testFile.fileName << (optimalParse ? " (optimal)" : "") << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%) in " << durationMs << " ms" << std::endl;
+            CATCH_REQUIRE(fileData == decodeLZSS_10(compressedData));
+            CATCH_REQUIRE(compressedData.size() <= testFile.maxSize);
+        }
     }
 }
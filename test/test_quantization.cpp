@@ -1,8 +1,16 @@
 #include "testmacros.h"
 
+#include "color/cielabf.h"
+#include "color/colorhelpers.h"
+#include "color/conversions.h"
+#include "color/gamma.h"
+#include "color/psnr.h"
 #include "image/imagehelpers.h"
+#include "image/quantization.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <map>
 #include <random>
 #include <vector>
 
@@ -12,3 +20,214 @@ TEST_CASE("quantizeThreshold")
 {
     // CATCH_FAIL();
 }
+
+TEST_CASE("quantizeClosest")
+{
+    // map random colors to a few target colors
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<uint32_t> distRGB(0, 0xFFFFFF);
+    std::uniform_int_distribution<uint32_t> distTarget(0, 15);
+    std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> colorMapping;
+    std::map<Color::XRGB8888, Color::XRGB8888> expectedMapping;
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        const Color::XRGB8888 srcColor(distRGB(gen));
+        const Color::XRGB8888 dstColor(distTarget(gen) * 0x101010);
+        if (expectedMapping.emplace(srcColor, dstColor).second)
+        {
+            colorMapping[dstColor].push_back(srcColor);
+        }
+    }
+    std::vector<Color::XRGB8888> pixels;
+    std::transform(expectedMapping.cbegin(), expectedMapping.cend(), std::back_inserter(pixels), [](const auto &m)
+                   { return m.first; });
+    std::shuffle(pixels.begin(), pixels.end(), gen);
+    const auto result = Image::Quantization::quantizeClosest(Image::ImageData(pixels), colorMapping);
+    CATCH_REQUIRE(result.pixels().format() == Color::Format::Paletted8);
+    const auto &indices = result.pixels().data<uint8_t>();
+    const auto &colorMap = result.colorMap().data<Color::XRGB8888>();
+    CATCH_REQUIRE(indices.size() == pixels.size());
+    CATCH_REQUIRE(colorMap.size() == colorMapping.size());
+    for (std::size_t i = 0; i < pixels.size(); ++i)
+    {
+        CATCH_REQUIRE(colorMap.at(indices[i]) == expectedMapping.at(pixels[i]));
+    }
+    // unmapped colors must throw
+    pixels.push_back(Color::XRGB8888(0x123456));
+    if (expectedMapping.find(pixels.back()) == expectedMapping.end())
+    {
+        CATCH_REQUIRE_THROWS(Image::Quantization::quantizeClosest(Image::ImageData(pixels), colorMapping));
+    }
+}
+
+// Map every color in pixels to the closest color of colorMap in CIELab color space
+static auto buildClosestMapping(const std::vector<Color::XRGB8888> &pixels, const std::vector<Color::XRGB8888> &colorMap) -> std::map<Color::XRGB8888, std::vector<Color::XRGB8888>>
+{
+    const auto colorMapLab = Color::convertTo<Color::CIELabf>(Color::srgbToLinear(colorMap));
+    std::map<Color::XRGB8888, Color::XRGB8888> closestColors;
+    for (const auto &pixel : pixels)
+    {
+        if (closestColors.find(pixel) == closestColors.end())
+        {
+            closestColors[pixel] = colorMap.at(ColorHelpers::getClosestColorIndex(Color::convertTo<Color::CIELabf>(Color::srgbToLinear(pixel)), colorMapLab));
+        }
+    }
+    std::map<Color::XRGB8888, std::vector<Color::XRGB8888>> colorMapping;
+    for (const auto &c : colorMap)
+    {
+        colorMapping[c] = {};
+    }
+    for (const auto &m : closestColors)
+    {
+        colorMapping[m.second].push_back(m.first);
+    }
+    return colorMapping;
+}
+
+// Average colors of blocks of blockSize * blockSize pixels in linear RGB. This is roughly what the eye sees when looking at a dithered image
+static auto blockAverage(const std::vector<Color::XRGB8888> &pixels, uint32_t width, uint32_t height, uint32_t blockSize) -> std::vector<Color::RGBf>
+{
+    const auto linear = Color::srgbToLinear(pixels);
+    std::vector<Color::RGBf> result;
+    for (uint32_t by = 0; by + blockSize <= height; by += blockSize)
+    {
+        for (uint32_t bx = 0; bx + blockSize <= width; bx += blockSize)
+        {
+            Color::RGBf sum;
+            for (uint32_t y = by; y < by + blockSize; ++y)
+            {
+                for (uint32_t x = bx; x < bx + blockSize; ++x)
+                {
+                    sum += linear[y * width + x];
+                }
+            }
+            result.push_back(sum / static_cast<float>(blockSize * blockSize));
+        }
+    }
+    return result;
+}
+
+// Convert paletted image back to true color
+static auto toTruecolor(const Image::ImageData &data) -> std::vector<Color::XRGB8888>
+{
+    const auto &indices = data.pixels().data<uint8_t>();
+    const auto &colorMap = data.colorMap().data<Color::XRGB8888>();
+    std::vector<Color::XRGB8888> result;
+    std::transform(indices.cbegin(), indices.cend(), std::back_inserter(result), [&colorMap](auto index)
+                   { return colorMap.at(index); });
+    return result;
+}
+
+TEST_CASE("atkinsonDither")
+{
+    // color gradient image
+    const uint32_t width = 256;
+    const uint32_t height = 128;
+    std::vector<Color::XRGB8888> pixels;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            pixels.push_back(Color::XRGB8888(static_cast<uint8_t>(x), static_cast<uint8_t>(y * 2), static_cast<uint8_t>(255 - x / 2)));
+        }
+    }
+    // palette with 4 levels per channel
+    std::vector<Color::XRGB8888> colorMap;
+    for (uint8_t r : {0, 85, 170, 255})
+    {
+        for (uint8_t g : {0, 85, 170, 255})
+        {
+            for (uint8_t b : {0, 85, 170, 255})
+            {
+                colorMap.push_back(Color::XRGB8888(r, g, b));
+            }
+        }
+    }
+    const auto colorMapping = buildClosestMapping(pixels, colorMap);
+    const auto result = Image::Quantization::atkinsonDither(Image::ImageData(pixels), width, height, colorMapping);
+    CATCH_REQUIRE(result.pixels().format() == Color::Format::Paletted8);
+    CATCH_REQUIRE(result.pixels().data<uint8_t>().size() == pixels.size());
+    CATCH_REQUIRE(result.colorMap().size() == colorMapping.size());
+    // result must be deterministic
+    const auto result2 = Image::Quantization::atkinsonDither(Image::ImageData(pixels), width, height, colorMapping);
+    CATCH_REQUIRE(result.pixels().data<uint8_t>() == result2.pixels().data<uint8_t>());
+    CATCH_REQUIRE(result.colorMap().data<Color::XRGB8888>() == result2.colorMap().data<Color::XRGB8888>());
+    // dithered image should look closer to the original than the image quantized to the closest colors when viewed from a distance
+    const auto closest = Image::Quantization::quantizeClosest(Image::ImageData(pixels), colorMapping);
+    const auto ditheredPixels = toTruecolor(result);
+    const auto closestPixels = toTruecolor(closest);
+    const auto psnrDithered = Color::psnr(Color::srgbToLinear(pixels), Color::srgbToLinear(ditheredPixels));
+    const auto psnrClosest = Color::psnr(Color::srgbToLinear(pixels), Color::srgbToLinear(closestPixels));
+    const auto psnrDitheredAverage = Color::psnr(blockAverage(pixels, width, height, 4), blockAverage(ditheredPixels, width, height, 4));
+    const auto psnrClosestAverage = Color::psnr(blockAverage(pixels, width, height, 4), blockAverage(closestPixels, width, height, 4));
+    CATCH_REQUIRE(psnrDithered > psnrClosest - 3.0F);
+    CATCH_REQUIRE(psnrDitheredAverage > psnrClosestAverage + 3.0F);
+    // colors in the palette must not be dithered
+    const std::vector<Color::XRGB8888> flatPixels(64 * 64, colorMap[42]);
+    const auto flat = Image::Quantization::atkinsonDither(Image::ImageData(flatPixels), 64, 64, buildClosestMapping(flatPixels, colorMap));
+    CATCH_REQUIRE(toTruecolor(flat) == flatPixels);
+    // bad input
+    CATCH_REQUIRE_THROWS(Image::Quantization::atkinsonDither(Image::ImageData(pixels), width, height + 1, colorMapping));
+    CATCH_REQUIRE_THROWS(Image::Quantization::atkinsonDither(Image::ImageData(pixels), width, height, {}));
+}
+
+TEST_CASE("orderedDither")
+{
+    // color gradient image
+    const uint32_t width = 256;
+    const uint32_t height = 128;
+    std::vector<Color::XRGB8888> pixels;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            pixels.push_back(Color::XRGB8888(static_cast<uint8_t>(x), static_cast<uint8_t>(y * 2), static_cast<uint8_t>(255 - x / 2)));
+        }
+    }
+    // palette with 4 levels per channel
+    std::vector<Color::XRGB8888> colorMap;
+    for (uint8_t r : {0, 85, 170, 255})
+    {
+        for (uint8_t g : {0, 85, 170, 255})
+        {
+            for (uint8_t b : {0, 85, 170, 255})
+            {
+                colorMap.push_back(Color::XRGB8888(r, g, b));
+            }
+        }
+    }
+    const auto colorMapping = buildClosestMapping(pixels, colorMap);
+    const auto result = Image::Quantization::orderedDither(Image::ImageData(pixels), width, height, colorMapping);
+    CATCH_REQUIRE(result.pixels().format() == Color::Format::Paletted8);
+    CATCH_REQUIRE(result.pixels().data<uint8_t>().size() == pixels.size());
+    CATCH_REQUIRE(result.colorMap().size() == colorMapping.size());
+    // result must be deterministic
+    const auto result2 = Image::Quantization::orderedDither(Image::ImageData(pixels), width, height, colorMapping);
+    CATCH_REQUIRE(result.pixels().data<uint8_t>() == result2.pixels().data<uint8_t>());
+    CATCH_REQUIRE(result.colorMap().data<Color::XRGB8888>() == result2.colorMap().data<Color::XRGB8888>());
+    // dithered image should look closer to the original than the image quantized to the closest colors when viewed from a distance
+    const auto closest = Image::Quantization::quantizeClosest(Image::ImageData(pixels), colorMapping);
+    const auto ditheredPixels = toTruecolor(result);
+    const auto closestPixels = toTruecolor(closest);
+    const auto psnrDithered = Color::psnr(Color::srgbToLinear(pixels), Color::srgbToLinear(ditheredPixels));
+    const auto psnrClosest = Color::psnr(Color::srgbToLinear(pixels), Color::srgbToLinear(closestPixels));
+    const auto psnrDitheredAverage = Color::psnr(blockAverage(pixels, width, height, 4), blockAverage(ditheredPixels, width, height, 4));
+    const auto psnrClosestAverage = Color::psnr(blockAverage(pixels, width, height, 4), blockAverage(closestPixels, width, height, 4));
+    CATCH_REQUIRE(psnrDithered > psnrClosest - 3.0F);
+    CATCH_REQUIRE(psnrDitheredAverage > psnrClosestAverage + 3.0F);
+    // flat areas between palette colors must be dithered with a pattern repeating every 4 pixels
+    const std::vector<Color::XRGB8888> flatPixels(64 * 64, Color::XRGB8888(128, 128, 128));
+    const auto flat = Image::Quantization::orderedDither(Image::ImageData(flatPixels), 64, 64, buildClosestMapping(flatPixels, colorMap));
+    const auto &flatIndices = flat.pixels().data<uint8_t>();
+    CATCH_REQUIRE(static_cast<std::size_t>(std::count(flatIndices.cbegin(), flatIndices.cend(), flatIndices.front())) < flatIndices.size());
+    for (uint32_t y = 0; y < 64; ++y)
+    {
+        for (uint32_t x = 0; x < 64; ++x)
+        {
+            CATCH_REQUIRE(flatIndices[y * 64 + x] == flatIndices[(y % 4) * 64 + (x % 4)]);
+        }
+    }
+    // bad input
+    CATCH_REQUIRE_THROWS(Image::Quantization::orderedDither(Image::ImageData(pixels), width, height + 1, colorMapping));
+    CATCH_REQUIRE_THROWS(Image::Quantization::orderedDither(Image::ImageData(pixels), width, height, {}));
+}
@@ -4,6 +4,7 @@
 #include "exception.h"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -117,6 +118,93 @@ TEST_CASE("RANS roundtrip")
     CATCH_REQUIRE(TO_VECTOR8(v8) == decodeRANS_50(encodeRANS_50(TO_VECTOR8(v8))));
 }
 
+TEST_CASE("RANS adaptive model reuse")
+{
+    // split data into small buffers like per-frame video data
+    auto data = TO_VECTOR8(v5);
+    for (auto c : TO_VECTOR8(v8))
+    {
+        data.push_back(c);
+    }
+    constexpr std::size_t BufferSize = 128;
+    RansModel encoderModel;
+    RansModel decoderModel;
+    std::size_t sizeWithModel = 0;
+    std::size_t sizeWithoutModel = 0;
+    for (std::size_t i = 0; i < data.size(); i += BufferSize)
+    {
+        const std::vector<uint8_t> buffer(std::next(data.cbegin(), i), std::next(data.cbegin(), std::min(data.size(), i + BufferSize)));
+        const auto compressed = encodeRANS_50(buffer, encoderModel, false, true);
+        CATCH_REQUIRE(buffer == decodeRANS_50(compressed, decoderModel));
+        CATCH_REQUIRE(encoderModel == decoderModel);
+        sizeWithModel += compressed.size();
+        const auto compressedWithoutModel = encodeRANS_50(buffer);
+        CATCH_REQUIRE(buffer == decodeRANS_50(compressedWithoutModel));
+        sizeWithoutModel += compressedWithoutModel.size();
+        // buffers that use the previous model can not be decoded without it
+        if ((compressed[4] & RANS_HEADER_MODE_MASK) == RANS_HEADER_MODE_ADAPTIVE && (compressed[4] & RANS_HEADER_ADAPTIVE_PREVIOUS) != 0)
+        {
+            CATCH_REQUIRE_THROWS(decodeRANS_50(compressed));
+        }
+    }
+    CATCH_REQUIRE(sizeWithModel < sizeWithoutModel);
+    // small buffers must not need a frequency table anymore
+    RansModel model;
+    CATCH_REQUIRE(encodeRANS_50(TO_VECTOR8(v4), model, false, true).size() < 4 + 1 + 2 * RANS_ALPHABET_SIZE);
+}
+
+TEST_CASE("RANS static model by default")
+{
+    // without adaptive flag the encoder must only use the static table, so streams decode without a previous model
+    RansModel encoderModel;
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v3), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        for (bool interleaved : {false, true})
+        {
+            const auto compressed = encodeRANS_50(data, encoderModel, interleaved);
+            CATCH_REQUIRE((compressed[4] & RANS_HEADER_MODE_MASK) != RANS_HEADER_MODE_ADAPTIVE);
+            CATCH_REQUIRE(compressed == encodeRANS_50(data, interleaved));
+            CATCH_REQUIRE(data == decodeRANS_50(compressed));
+        }
+    }
+}
+
+TEST_CASE("RANS interleaved roundtrip")
+{
+    RansModel encoderModel;
+    RansModel decoderModel;
+    for (const auto &data : {TO_VECTOR8(v1), TO_VECTOR8(v2), TO_VECTOR8(v3), TO_VECTOR8(v4), TO_VECTOR8(v5), TO_VECTOR8(v6), TO_VECTOR8(v7), TO_VECTOR8(v8)})
+    {
+        CATCH_REQUIRE(data == decodeRANS_50(encodeRANS_50(data, true)));
+        CATCH_REQUIRE(data == decodeRANS_50(encodeRANS_50(data, encoderModel, true, true), decoderModel));
+        CATCH_REQUIRE(encoderModel == decoderModel);
+    }
+}
+
+TEST_CASE("RANS interleaved throughput")
+{
+    // build skewed test data with a simple LCG, so results are reproducible
+    std::vector<uint8_t> data(1 << 20);
+    uint32_t random = 12345;
+    for (auto &d : data)
+    {
+        random = random * 1664525 + 1013904223;
+        d = static_cast<uint8_t>(((random >> 24) * (random >> 24)) >> 10);
+    }
+    for (bool interleaved : {false, true})
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const auto compressedData = encodeRANS_50(data, interleaved);
+        const auto encodeTime = std::chrono::steady_clock::now();
+        const auto decompressedData = decodeRANS_50(compressedData);
+        const auto decodeTime = std::chrono::steady_clock::now();
+        const auto encodeMBs = static_cast<double>(data.size()) / std::chrono::duration<double, std::micro>(encodeTime - startTime).count();
+        const auto decodeMBs = static_cast<double>(data.size()) / std::chrono::duration<double, std::micro>(decodeTime - encodeTime).count();
+        std::cout << (interleaved ? "Interleaved" : "Single-state") << " rANS compressed " << data.size() << " to " << compressedData.size() << " bytes, encode " << encodeMBs << " MB/s, decode " << decodeMBs << " MB/s" << std::endl;
+        CATCH_REQUIRE(data == decompressedData);
+    }
+}
+
 TEST_CASE("RANS ratio")
 {
     for (auto &testFile : RansTestFiles)
@@ -126,10 +214,16 @@ TEST_CASE("RANS ratio")
         REQUIRE(fs.is_open(), std::runtime_error, "Failed to open " << testFile.fileName << " for reading");
         // read all of the file data
         std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(fs)), (std::istreambuf_iterator<char>()));
-        // compress and decompress file data
+        // compress and decompress file data and measure throughput
+        const auto startTime = std::chrono::steady_clock::now();
         auto compressedData = encodeRANS_50(fileData);
-        std::cout << testFile.fileName << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%)" << std::endl;
-        CATCH_REQUIRE(fileData == decodeRANS_50(compressedData));
+        const auto encodeTime = std::chrono::steady_clock::now();
+        auto decompressedData = decodeRANS_50(compressedData);
+        const auto decodeTime = std::chrono::steady_clock::now();
+        const auto encodeMBs = static_cast<double>(fileData.size()) / std::chrono::duration<double, std::micro>(encodeTime - startTime).count();
+        const auto decodeMBs = static_cast<double>(fileData.size()) / std::chrono::duration<double, std::micro>(decodeTime - encodeTime).count();
+        std::cout << testFile.fileName << " compressed from " << fileData.size() << " to " << compressedData.size() << " bytes (" << static_cast<double>(compressedData.size()) / static_cast<double>(fileData.size()) * 100.0 << "%), encode " << encodeMBs << " MB/s, decode " << decodeMBs << " MB/s" << std::endl;
+        CATCH_REQUIRE(fileData == decompressedData);
         CATCH_REQUIRE(compressedData.size() <= testFile.maxSize);
     }
 }
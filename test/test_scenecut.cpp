@@ -0,0 +1,72 @@
+#include "testmacros.h"
+
+#include "image/imageio.h"
+#include "video_codec/scenecut.h"
+
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> SequenceFiles = {
+    "BigBuckBunny_240x160_15fps-178.png",
+    "BigBuckBunny_240x160_15fps-179.png",
+    "BigBuckBunny_240x160_15fps-180.png",
+    "BigBuckBunny_240x160_15fps-181.png"};
+
+static const std::vector<std::string> CutFiles = {
+    "TearsOfSteel_676_240x160.png",
+    "flower_foveon_240x160.png",
+    "BigBuckBunny_282_240x160.png"};
+
+static const std::string DataPathGBAImages = "../../data/images/240x160/";
+static const std::string DataPathGBAVideos = "../../data/videos/240x160/";
+
+TEST_SUITE("SceneCut")
+
+TEST_CASE("SyntheticImages")
+{
+    constexpr uint32_t width = 32;
+    constexpr uint32_t height = 16;
+    std::vector<Color::XRGB8888> black(width * height, Color::XRGB8888(0, 0, 0));
+    std::vector<Color::XRGB8888> white(width * height, Color::XRGB8888(255, 255, 255));
+    // half black, half white image and the same image moved to the right
+    std::vector<Color::XRGB8888> half(width * height);
+    std::vector<Color::XRGB8888> halfMoved(width * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            half[y * width + x] = x < width / 2 ? black.front() : white.front();
+            halfMoved[y * width + x] = ((x + 4) % width) < width / 2 ? black.front() : white.front();
+        }
+    }
+    CATCH_REQUIRE(Video::SceneCut::histogramDistance(black, black, width, height) == 0.0F);
+    CATCH_REQUIRE(Video::SceneCut::histogramDistance(black, white, width, height) == 1.0F);
+    CATCH_REQUIRE(Video::SceneCut::histogramDistance(black, half, width, height) == 0.5F);
+    CATCH_REQUIRE(Video::SceneCut::histogramDistance(half, halfMoved, width, height) == 0.0F);
+    CATCH_REQUIRE(Video::SceneCut::isSceneCut(black, {}, width, height));
+    CATCH_REQUIRE(Video::SceneCut::isSceneCut(black, white, width, height));
+    CATCH_REQUIRE_FALSE(Video::SceneCut::isSceneCut(half, halfMoved, width, height));
+    CATCH_REQUIRE_THROWS(Video::SceneCut::histogramDistance(black, std::vector<Color::XRGB8888>(width), width, height));
+}
+
+TEST_CASE("VideoSequence")
+{
+    std::vector<Color::XRGB8888> prevPixels;
+    for (const auto &file : SequenceFiles)
+    {
+        const auto image = IO::File::readImage(DataPathGBAVideos + file);
+        const auto size = image.info.size;
+        const auto pixels = image.data.pixels().convertData<Color::XRGB8888>();
+        // only the first frame starts a scene
+        CATCH_REQUIRE(Video::SceneCut::isSceneCut(pixels, prevPixels, size.width(), size.height()) == prevPixels.empty());
+        prevPixels = pixels;
+    }
+    for (const auto &file : CutFiles)
+    {
+        const auto image = IO::File::readImage(DataPathGBAImages + file);
+        const auto size = image.info.size;
+        const auto pixels = image.data.pixels().convertData<Color::XRGB8888>();
+        CATCH_REQUIRE(Video::SceneCut::isSceneCut(pixels, prevPixels, size.width(), size.height()));
+        prevPixels = pixels;
+    }
+}